@@ -0,0 +1,78 @@
+/*
+ * includes/simple_utcd/admission_control.hpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <atomic>
+#include <chrono>
+
+namespace simple_utcd {
+
+/**
+ * @brief CoDel-style admission control on queueing delay
+ *
+ * Every connection reports how long it waited between accept and service.
+ * The controller tracks the smallest wait seen in each interval: a
+ * standing queue shows up as a minimum that stays above the target. While
+ * that holds the controller is overloaded and rejects connections that
+ * have already waited longer than the target, so a backlog is cut down to
+ * fresh work instead of everyone timing out. Lock-free; any thread may
+ * report samples.
+ */
+class AdmissionController {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    AdmissionController();
+
+    void set_target(std::chrono::microseconds target) { target_us_ = static_cast<uint64_t>(target.count()); }
+    void set_interval(std::chrono::microseconds interval) { interval_us_ = static_cast<uint64_t>(interval.count()); }
+    std::chrono::microseconds get_target() const { return std::chrono::microseconds(target_us_.load()); }
+    std::chrono::microseconds get_interval() const { return std::chrono::microseconds(interval_us_.load()); }
+
+    // Record a connection's queueing delay; returns false if it should be shed
+    bool admit(Clock::time_point accepted_at, Clock::time_point now = Clock::now());
+
+    bool is_overloaded() const { return overloaded_; }
+
+    // Minimum delay over the last completed interval
+    uint64_t get_queue_delay_us() const { return last_min_delay_us_; }
+    uint64_t get_shed_count() const { return shed_count_; }
+    uint64_t get_admitted_count() const { return admitted_count_; }
+
+    // Bumped whenever is_overloaded() flips; lets callers react once per change
+    uint64_t get_state_changes() const { return state_changes_; }
+
+private:
+    std::atomic<uint64_t> target_us_;
+    std::atomic<uint64_t> interval_us_;
+
+    std::atomic<int64_t> interval_end_us_;      // Steady-clock deadline of the current interval
+    std::atomic<uint64_t> interval_min_us_;     // Smallest delay seen so far this interval
+    std::atomic<uint64_t> last_min_delay_us_;
+    std::atomic<bool> overloaded_;
+
+    std::atomic<uint64_t> shed_count_;
+    std::atomic<uint64_t> admitted_count_;
+    std::atomic<uint64_t> state_changes_;
+
+    void roll_interval(int64_t now_us);
+};
+
+} // namespace simple_utcd
@@ -92,6 +92,9 @@ public:
     void start();
     void stop();
     bool is_running() const { return running_; }
+
+    // CPUs the pool threads may run on; applied by threads started afterwards
+    void set_cpu_affinity(const std::vector<int>& cpus) { cpu_affinity_ = cpus; }
     
     // Get statistics
     size_t get_pending_operations() const;
@@ -109,6 +112,7 @@ private:
     std::atomic<size_t> completed_operations_;
     std::atomic<size_t> failed_operations_;
     size_t thread_pool_size_;
+    std::vector<int> cpu_affinity_;
     
     void worker_thread_main();
     void execute_operation(std::unique_ptr<AsyncIOOperation> op);
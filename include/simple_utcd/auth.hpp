@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include "simple_utcd/time_source.hpp"
 #include <string>
 #include <memory>
 #include <vector>
@@ -45,7 +46,7 @@ struct AuthResult {
     std::string session_id;
     std::chrono::system_clock::time_point expires_at;
     
-    AuthResult() : success(false), expires_at(std::chrono::system_clock::now()) {}
+    AuthResult() : success(false), expires_at(TimeSource::current().coarse_now()) {}
 };
 
 /**
@@ -130,7 +131,7 @@ private:
     std::string compute_sha256(const std::string& data) const;
     std::string compute_hash(const std::string& data) const;
     
-    // Session ID generation
+    // Session ID generation; empty if no random bytes are available
     std::string generate_session_id() const;
     
     // Time utilities
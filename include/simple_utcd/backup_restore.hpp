@@ -23,6 +23,7 @@
 #include <map>
 #include <chrono>
 #include <mutex>
+#include <atomic>
 #include <cstdint>
 
 namespace simple_utcd {
@@ -96,12 +97,14 @@ private:
     
     std::map<std::string, BackupEntry> backups_;
     mutable std::mutex backups_mutex_;
+    mutable std::atomic<uint64_t> backup_sequence_;
     
     // Backup operations
     std::string generate_backup_id(const std::string& type) const;
     std::string get_backup_path(const std::string& backup_id, const std::string& type) const;
     bool create_backup_directory() const;
     bool copy_file(const std::string& source, const std::string& destination) const;
+    bool erase_backup(const std::string& backup_id);  // Caller holds backups_mutex_
     
     // Cleanup
     bool is_backup_expired(const BackupEntry& backup) const;
@@ -0,0 +1,109 @@
+/*
+ * includes/simple_utcd/busy_poller.hpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "simple_utcd/server_stats.hpp"
+#include <chrono>
+#include <cstdint>
+
+namespace simple_utcd {
+
+/**
+ * @brief Spin-then-sleep policy for an event loop thread
+ *
+ * While spinning, next_timeout() is 0 so wait() only polls. Once the
+ * loop has gone idle_threshold without an event it returns -1 and the
+ * thread blocks as usual; the next event puts it back to spinning.
+ *
+ * The owner calls woke() with each wait() result and handled() after
+ * processing the events. A loop that reads its socket directly while
+ * spinning calls polled() once per pass instead. Time spent polling is
+ * charged to busy_poll_spin_ns and time spent on events to
+ * busy_poll_work_ns in the thread's StatsBlock; time blocked counts as
+ * neither. A disabled poller always blocks and reads no clocks.
+ */
+class BusyPoller {
+public:
+    BusyPoller(bool enabled, std::chrono::microseconds idle_threshold, StatsBlock& stats)
+        : enabled_(enabled)
+        , spinning_(enabled)
+        , idle_threshold_ns_(static_cast<int64_t>(
+              std::chrono::duration_cast<std::chrono::nanoseconds>(idle_threshold).count()))
+        , stats_(stats)
+        , last_ns_(enabled ? now_ns() : 0)
+        , idle_since_ns_(last_ns_)
+    {
+    }
+
+    bool is_spinning() const { return spinning_; }
+    int next_timeout() const { return spinning_ ? 0 : -1; }
+
+    void woke(int events) {
+        if (enabled_) {
+            advance(events, stats_.busy_poll_spin_ns);
+        }
+    }
+
+    void handled(int events) {
+        if (!enabled_ || events <= 0) {
+            return;
+        }
+        int64_t now = now_ns();
+        StatsBlock::add(stats_.busy_poll_work_ns, static_cast<uint64_t>(now - last_ns_));
+        last_ns_ = now;
+    }
+
+    // A whole pass that both polled and handled: work if it found events
+    void polled(int events) {
+        if (enabled_) {
+            advance(events, events > 0 ? stats_.busy_poll_work_ns : stats_.busy_poll_spin_ns);
+        }
+    }
+
+private:
+    void advance(int events, StatsBlock::Counter& charge) {
+        int64_t now = now_ns();
+        if (spinning_) {
+            StatsBlock::add(charge, static_cast<uint64_t>(now - last_ns_));
+        }
+
+        if (events > 0) {
+            spinning_ = true;
+            idle_since_ns_ = now;
+        } else if (spinning_ && now - idle_since_ns_ >= idle_threshold_ns_) {
+            spinning_ = false;
+            StatsBlock::add(stats_.busy_poll_sleeps);
+        }
+        last_ns_ = now;
+    }
+
+    static int64_t now_ns() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    bool enabled_;
+    bool spinning_;
+    int64_t idle_threshold_ns_;
+    StatsBlock& stats_;
+    int64_t last_ns_;
+    int64_t idle_since_ns_;
+};
+
+} // namespace simple_utcd
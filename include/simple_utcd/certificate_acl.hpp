@@ -24,6 +24,7 @@
 #include <set>
 #include <mutex>
 #include <memory>
+#include <atomic>
 #include "tls_manager.hpp"
 
 namespace simple_utcd {
@@ -0,0 +1,71 @@
+/*
+ * includes/simple_utcd/clock_select.hpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace simple_utcd {
+
+/**
+ * @brief Intersection, clustering and combining of upstream offsets
+ *
+ * Follows RFC 5905 section 11.2. Each candidate's correctness interval is
+ * its offset plus or minus its root distance. select() finds the smallest
+ * interval shared by a majority of them (Marzullo's algorithm as the RFC
+ * adapts it); candidates whose offset lies outside it are falsetickers,
+ * however wide their own interval.
+ *
+ * The truechimers are then clustered: while more than kMinSurvivors
+ * remain, the one furthest from the others (largest selection jitter) is
+ * dropped unless that jitter is already below the quietest candidate's
+ * own jitter. Running sums make each drop O(n), so the whole pass is
+ * O(n^2) rather than O(n^3). The survivors' offsets are averaged with
+ * weights of one over root distance, and the survivor with the smallest
+ * root distance becomes the system peer.
+ */
+class ClockSelect {
+public:
+    static constexpr size_t kMinSurvivors = 3;
+
+    struct Candidate {
+        int64_t offset_ns = 0;
+        int64_t root_distance_ns = 0;   // Half the correctness interval
+        int64_t jitter_ns = 0;          // The candidate's own offset noise
+    };
+
+    struct Result {
+        bool valid = false;             // False when no majority agrees
+        int64_t low_ns = 0;             // Intersection interval
+        int64_t high_ns = 0;
+        std::vector<size_t> truechimers;    // Candidate indexes, ascending
+        std::vector<size_t> survivors;      // After clustering, by root distance
+        size_t system_peer = 0;
+        int64_t offset_ns = 0;          // Combined offset of the survivors
+        int64_t jitter_ns = 0;          // Selection jitter among the survivors
+    };
+
+    static Result select(const std::vector<Candidate>& candidates);
+
+    // The RFC 5905 intersection step alone; false without a majority
+    static bool intersect(const std::vector<Candidate>& candidates, int64_t& low_ns, int64_t& high_ns);
+};
+
+} // namespace simple_utcd
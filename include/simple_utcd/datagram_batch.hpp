@@ -0,0 +1,122 @@
+/*
+ * includes/simple_utcd/datagram_batch.hpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <sys/socket.h>
+
+#ifdef __linux__
+#include <sys/uio.h>
+#endif
+
+namespace simple_utcd {
+
+/**
+ * @brief Batched datagram receive/reply buffers
+ *
+ * Drains up to capacity() datagrams per receive() call and sends every
+ * queued reply with one flush(). On Linux these map to a single
+ * recvmmsg()/sendmmsg() each; elsewhere they fall back to a
+ * recvfrom()/sendto() loop. All buffers are allocated up front, so the
+ * steady state performs no allocations. Expects a non-blocking socket.
+ *
+ * With set_timestamping() each received datagram also carries the
+ * kernel's software receive stamp, and read_transmit_timestamps() picks
+ * up the kernel's send stamps for the last flush() from the error queue.
+ */
+class DatagramBatch {
+public:
+    static constexpr size_t kMaxDatagramSize = 128;
+
+    struct Datagram {
+        struct sockaddr_storage peer;
+        socklen_t peer_len;
+        size_t size;
+        int64_t kernel_time_ns;     // CLOCK_REALTIME arrival; 0 when unstamped
+        uint8_t data[kMaxDatagramSize];
+    };
+
+    explicit DatagramBatch(size_t capacity);
+
+    DatagramBatch(const DatagramBatch&) = delete;
+    DatagramBatch& operator=(const DatagramBatch&) = delete;
+
+    size_t capacity() const { return requests_.size(); }
+
+    // Read pending datagrams; returns the number received, 0 once the
+    // socket is drained, -1 on error
+    int receive(int fd);
+    const Datagram& request(size_t index) const { return requests_[index]; }
+
+    // Queue a reply to a received datagram (payload is copied)
+    bool add_reply(size_t index, const void* data, size_t size);
+    size_t pending_replies() const { return reply_count_; }
+
+    // Queued reply payload, for fields stamped just before flush()
+    uint8_t* reply_data(size_t index) { return replies_[index].data; }
+
+    // Send queued replies; returns how many went out. Replies the socket
+    // cannot take right now are dropped, as UDP would anyway.
+    int flush(int fd);
+
+    // Ask the kernel to stamp datagrams on fd (SO_TIMESTAMPING software
+    // receive and transmit, or SO_TIMESTAMPNS receive only). Best done
+    // before bind() so no datagram arrives unstamped.
+    enum class Timestamping { NONE, RECEIVE, RECEIVE_TRANSMIT };
+    static Timestamping enable_timestamping(int fd);
+
+    // Collect the stamps a socket was set up for; NONE behaves as before
+    void set_timestamping(Timestamping mode);
+    bool has_receive_timestamps() const { return rx_timestamps_; }
+    bool has_transmit_timestamps() const { return tx_timestamps_; }
+
+    // Drain the socket error queue; returns how many kernel send stamps
+    // belong to replies of the last flush(). Stale stamps are discarded.
+    int read_transmit_timestamps(int fd);
+    int64_t transmit_timestamp(size_t index) const { return tx_times_[index]; }
+
+private:
+    std::vector<Datagram> requests_;
+    std::vector<Datagram> replies_;
+    size_t reply_count_;
+    bool rx_timestamps_;
+    bool tx_timestamps_;
+    std::vector<int64_t> tx_times_;
+
+#ifdef __linux__
+    // Room for a timestamping cmsg plus an extended error on the error queue
+    union ControlBuffer {
+        struct cmsghdr align;
+        uint8_t data[256];
+    };
+
+    std::vector<struct mmsghdr> recv_headers_;
+    std::vector<struct iovec> recv_iov_;
+    std::vector<struct mmsghdr> send_headers_;
+    std::vector<struct iovec> send_iov_;
+    std::vector<struct mmsghdr> error_headers_;
+    std::vector<ControlBuffer> control_;
+    uint32_t tx_next_id_;       // Kernel OPT_ID of the next datagram sent
+    uint32_t tx_last_sent_;     // Datagrams in the last flush()
+#endif
+};
+
+} // namespace simple_utcd
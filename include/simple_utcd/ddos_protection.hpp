@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include "simple_utcd/time_source.hpp"
 #include <string>
 #include <map>
 #include <vector>
@@ -114,8 +115,8 @@ private:
         double anomaly_score;
         
         ClientStats() : total_requests(0), total_connections(0),
-                       first_seen(std::chrono::system_clock::now()),
-                       last_seen(std::chrono::system_clock::now()),
+                       first_seen(TimeSource::current().coarse_now()),
+                       last_seen(TimeSource::current().coarse_now()),
                        anomaly_score(0.0) {}
     };
     std::map<std::string, ClientStats> client_stats_;
@@ -127,8 +128,8 @@ private:
         std::chrono::system_clock::time_point expires_at;
         std::string reason;
         
-        BlockEntry() : blocked_at(std::chrono::system_clock::now()),
-                      expires_at(std::chrono::system_clock::now()) {}
+        BlockEntry() : blocked_at(TimeSource::current().coarse_now()),
+                      expires_at(TimeSource::current().coarse_now()) {}
     };
     std::map<std::string, BlockEntry> blocked_clients_;
     mutable std::mutex blocks_mutex_;
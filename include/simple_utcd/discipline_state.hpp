@@ -0,0 +1,143 @@
+/*
+ * includes/simple_utcd/discipline_state.hpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace simple_utcd {
+
+/**
+ * @brief How served time relates to the local clock
+ *
+ * The reference was offset_ns ahead of the local clock at last_update_ns,
+ * and runs frequency_ppm parts per million faster than it since. The local
+ * clock is the wall clock, or CLOCK_MONOTONIC_RAW when raw_clock is set
+ * (the VirtualClock's timescale); readers must read the one it names.
+ * Leap indicator and stratum are what NTP replies advertise. Once an
+ * upstream has set the clock, reference_time_ns is when, and replies also
+ * carry the root delay and dispersion through that upstream and its
+ * address as the reference ID; until then they keep the configured ones.
+ */
+struct DisciplineState {
+    static constexpr uint8_t kLeapNone = 0;
+    static constexpr uint8_t kLeapUnsynchronized = 3;
+    static constexpr uint8_t kUnsynchronizedStratum = 16;
+
+    int64_t offset_ns = 0;
+    double frequency_ppm = 0.0;
+    int64_t last_update_ns = 0;     // Local clock time, nanoseconds
+    uint8_t leap = kLeapUnsynchronized;
+    uint8_t stratum = kUnsynchronizedStratum;
+    bool raw_clock = false;         // Local clock is CLOCK_MONOTONIC_RAW, not the wall clock
+    int64_t reference_time_ns = 0;  // Reference time of the last upstream update; 0 before one
+    int64_t root_delay_ns = 0;      // Round trip to the primary reference, through the upstream
+    int64_t root_dispersion_ns = 0; // The upstream's, as of reference_time_ns
+    uint32_t reference_id = 0;      // The upstream's address, as NTP encodes it
+
+    // Reference time for a local clock reading
+    int64_t corrected_ns(int64_t local_ns) const {
+        double drift = static_cast<double>(local_ns - last_update_ns) * frequency_ppm * 1e-6;
+        return local_ns + offset_ns + static_cast<int64_t>(drift);
+    }
+};
+
+/**
+ * @brief Seqlock around the current DisciplineState
+ *
+ * The sync thread publishes; every response reads. The writer bumps the
+ * sequence to odd, stores the fields and bumps it back to even; a reader
+ * copies the fields between two sequence loads and retries if they differ
+ * or were odd. Readers never write, so the line only moves when the state
+ * changes, and an update in progress costs a reader a retry rather than a
+ * lock. Publishers must be serialized by the caller.
+ */
+class alignas(64) DisciplinePublisher {
+public:
+    DisciplinePublisher() = default;
+    DisciplinePublisher(const DisciplinePublisher&) = delete;
+    DisciplinePublisher& operator=(const DisciplinePublisher&) = delete;
+
+    void publish(const DisciplineState& state) {
+        uint64_t sequence = sequence_.load(std::memory_order_relaxed);
+        sequence_.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        offset_ns_.store(state.offset_ns, std::memory_order_relaxed);
+        frequency_ppm_.store(state.frequency_ppm, std::memory_order_relaxed);
+        last_update_ns_.store(state.last_update_ns, std::memory_order_relaxed);
+        reference_time_ns_.store(state.reference_time_ns, std::memory_order_relaxed);
+        root_delay_ns_.store(state.root_delay_ns, std::memory_order_relaxed);
+        root_dispersion_ns_.store(state.root_dispersion_ns, std::memory_order_relaxed);
+        reference_id_.store(state.reference_id, std::memory_order_relaxed);
+        flags_.store(pack_flags(state.leap, state.stratum, state.raw_clock), std::memory_order_relaxed);
+
+        sequence_.store(sequence + 2, std::memory_order_release);
+    }
+
+    DisciplineState read() const {
+        DisciplineState state;
+        for (;;) {
+            uint64_t before = sequence_.load(std::memory_order_acquire);
+            if (before & 1) {
+                continue;  // Writer mid-update
+            }
+
+            state.offset_ns = offset_ns_.load(std::memory_order_relaxed);
+            state.frequency_ppm = frequency_ppm_.load(std::memory_order_relaxed);
+            state.last_update_ns = last_update_ns_.load(std::memory_order_relaxed);
+            state.reference_time_ns = reference_time_ns_.load(std::memory_order_relaxed);
+            state.root_delay_ns = root_delay_ns_.load(std::memory_order_relaxed);
+            state.root_dispersion_ns = root_dispersion_ns_.load(std::memory_order_relaxed);
+            state.reference_id = reference_id_.load(std::memory_order_relaxed);
+            uint32_t flags = flags_.load(std::memory_order_relaxed);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence_.load(std::memory_order_relaxed) == before) {
+                state.leap = static_cast<uint8_t>(flags >> 8);
+                state.stratum = static_cast<uint8_t>(flags);
+                state.raw_clock = (flags & kRawClockFlag) != 0;
+                return state;
+            }
+        }
+    }
+
+    // Number of states published so far
+    uint64_t get_version() const { return sequence_.load(std::memory_order_acquire) / 2; }
+
+private:
+    static constexpr uint32_t kRawClockFlag = 1u << 16;
+
+    static uint32_t pack_flags(uint8_t leap, uint8_t stratum, bool raw_clock) {
+        return (raw_clock ? kRawClockFlag : 0) | (static_cast<uint32_t>(leap) << 8) | stratum;
+    }
+
+    std::atomic<uint64_t> sequence_{0};
+    std::atomic<int64_t> offset_ns_{0};
+    std::atomic<double> frequency_ppm_{0.0};
+    std::atomic<int64_t> last_update_ns_{0};
+    std::atomic<int64_t> reference_time_ns_{0};
+    std::atomic<int64_t> root_delay_ns_{0};
+    std::atomic<int64_t> root_dispersion_ns_{0};
+    std::atomic<uint32_t> reference_id_{0};
+    std::atomic<uint32_t> flags_{pack_flags(DisciplineState::kLeapUnsynchronized,
+                                            DisciplineState::kUnsynchronizedStratum, false)};
+};
+
+} // namespace simple_utcd
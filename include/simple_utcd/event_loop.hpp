@@ -0,0 +1,92 @@
+/*
+ * includes/simple_utcd/event_loop.hpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace simple_utcd {
+
+/**
+ * @brief Readiness flags reported by the event loop
+ */
+enum EventFlags : uint32_t {
+    EVENT_READ   = 1u << 0,
+    EVENT_WRITE  = 1u << 1,
+    EVENT_HANGUP = 1u << 2,   // Peer closed or socket error
+};
+
+/**
+ * @brief A single readiness notification
+ */
+struct IOEvent {
+    uint32_t events;
+    void* data;     // Pointer supplied at registration
+};
+
+/**
+ * @brief Edge-triggered readiness reactor
+ *
+ * Wraps epoll on Linux (poll() elsewhere) together with a wakeup
+ * descriptor so other threads can interrupt a blocking wait().
+ * Each instance is intended to be driven by a single thread.
+ */
+class EventLoop {
+public:
+    EventLoop();
+    ~EventLoop();
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    bool open();
+    void close();
+    bool is_open() const { return loop_fd_ >= 0; }
+
+    // Descriptor registration (edge-triggered); data must be non-null
+    bool add(int fd, uint32_t events, void* data);
+    bool modify(int fd, uint32_t events, void* data);
+    bool remove(int fd);
+
+    // Wait for readiness; returns the number of events stored in out,
+    // 0 on timeout or wakeup, -1 on error. timeout_ms < 0 blocks.
+    int wait(IOEvent* out, int max_events, int timeout_ms);
+
+    // Interrupt a concurrent wait(); safe to call from any thread
+    void wakeup();
+
+private:
+    int loop_fd_;
+    int wakeup_fd_;
+#ifndef __linux__
+    // poll() fallback: wakeup_fd_ is the read end of a pipe
+    struct Registration {
+        int fd;
+        uint32_t events;
+        void* data;
+    };
+    int wakeup_write_fd_;
+    std::vector<Registration> registrations_;
+#endif
+
+    void drain_wakeup();
+};
+
+} // namespace simple_utcd
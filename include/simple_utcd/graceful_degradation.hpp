@@ -87,6 +87,10 @@ public:
     // Resource monitoring
     void update_resource_usage(uint64_t memory_mb, double cpu_percent, uint64_t connections);
     void update_health_score(double health_score);
+
+    // Admission control: overloaded while queueing delay stays above target
+    void update_queue_delay(uint64_t delay_us, bool overloaded);
+    uint64_t get_queue_delay_us() const { return current_queue_delay_us_; }
     
     // Degradation decisions
     DegradationLevel evaluate_degradation_level();
@@ -113,6 +117,8 @@ private:
     std::atomic<double> current_cpu_percent_;
     std::atomic<uint64_t> current_connections_;
     std::atomic<double> current_health_score_;
+    std::atomic<uint64_t> current_queue_delay_us_;
+    std::atomic<bool> queue_overloaded_;
     
     // Feature registry
     std::map<std::string, ServiceFeature> features_;
@@ -121,6 +127,7 @@ private:
     // Degradation logic
     DegradationLevel calculate_degradation_level() const;
     void apply_degradation_level(DegradationLevel level);
+    bool is_enabled(const ServiceFeature& feature) const;
     bool should_disable_by_priority(ServicePriority priority, DegradationLevel level) const;
 };
 
@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include "simple_utcd/time_source.hpp"
 #include <string>
 #include <map>
 #include <chrono>
@@ -45,7 +46,7 @@ struct HealthCheckResult {
     std::map<std::string, std::string> details;
     std::chrono::system_clock::time_point timestamp;
     
-    HealthCheckResult() : status(HealthStatus::HEALTHY), timestamp(std::chrono::system_clock::now()) {}
+    HealthCheckResult() : status(HealthStatus::HEALTHY), timestamp(TimeSource::current().coarse_now()) {}
 };
 
 /**
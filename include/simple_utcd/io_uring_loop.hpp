@@ -0,0 +1,104 @@
+/*
+ * includes/simple_utcd/io_uring_loop.hpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+
+namespace simple_utcd {
+
+/**
+ * @brief Operation a completion belongs to
+ */
+enum class UringOp : uint8_t {
+    ACCEPT,
+    SEND,
+    CLOSE,
+};
+
+/**
+ * @brief A single io_uring completion
+ */
+struct UringCompletion {
+    UringOp op;
+    uint32_t tag;   // Caller-supplied tag (send/close only)
+    int result;     // Accepted fd, bytes sent, or -errno
+    bool more;      // Accept is still armed; when false the caller re-arms it
+};
+
+/**
+ * @brief Completion-based accept/send/close ring
+ *
+ * Wraps an io_uring instance for the one-shot TIME lifecycle: a multishot
+ * accept delivers new sockets, and each reply is queued as a send
+ * hard-linked to a close, so a connection costs one submission after the
+ * accept. Kernels before 5.19 reject multishot accept; open() probes for it,
+ * and without it accept() arms one single-shot accept at a time. A wakeup eventfd lets other threads interrupt a blocking wait().
+ * Built only when liburing is found at configure time; otherwise
+ * is_available() is false and open() fails.
+ * Each instance is intended to be driven by a single thread.
+ */
+class IoUringLoop {
+public:
+    IoUringLoop();
+    ~IoUringLoop();
+
+    IoUringLoop(const IoUringLoop&) = delete;
+    IoUringLoop& operator=(const IoUringLoop&) = delete;
+
+    // True when built with liburing and the kernel supports the opcodes used
+    static bool is_available();
+
+    // Arms a multishot accept on a throwaway loopback listener; the
+    // opcode probe cannot see the flag. Checked once per process.
+    static bool supports_multishot_accept();
+
+    bool open(unsigned entries);
+    void close();
+    bool is_open() const;
+
+    // Queue operations; they are submitted by the next wait()
+    bool accept(int listen_fd);
+    bool send_and_close(int fd, const void* data, size_t size, uint32_t tag);
+
+    // Whether accept() arms multishot; disable_multishot() is for a kernel
+    // that rejects it despite the probe
+    bool is_multishot() const { return multishot_; }
+    void disable_multishot() { multishot_ = false; }
+
+    // Submit queued work and wait for completions; returns the number
+    // stored in out, 0 on timeout or wakeup, -1 on error.
+    // timeout_ms < 0 blocks.
+    int wait(UringCompletion* out, int max_completions, int timeout_ms);
+
+    // Interrupt a concurrent wait(); safe to call from any thread
+    void wakeup();
+
+private:
+    struct Ring;
+    std::unique_ptr<Ring> ring_;
+    int wakeup_fd_;
+    uint64_t wakeup_value_;
+    bool multishot_;
+
+    bool arm_wakeup();
+};
+
+} // namespace simple_utcd
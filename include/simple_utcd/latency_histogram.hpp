@@ -0,0 +1,106 @@
+/*
+ * includes/simple_utcd/latency_histogram.hpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace simple_utcd {
+
+/**
+ * @brief Fixed log2-bucketed latency histogram in nanoseconds
+ *
+ * Bucket i counts samples below 2^i ns and at or above the previous
+ * bound, so recording is a bit scan and two stores with no allocation.
+ * The last bucket also takes everything past its bound (about a second).
+ * Like StatsBlock, each histogram has a single writer; readers sum
+ * several with absorb().
+ */
+class LatencyHistogram {
+public:
+    static constexpr size_t kBuckets = 32;
+
+    LatencyHistogram() = default;
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    // Owner thread only
+    void record(uint64_t nanoseconds) {
+        add(buckets_[bucket_for(nanoseconds)], 1);
+        add(count_, 1);
+        add(sum_ns_, nanoseconds);
+    }
+
+    uint64_t count() const { return count_.load(std::memory_order_acquire); }
+    uint64_t sum_ns() const { return sum_ns_.load(std::memory_order_acquire); }
+    uint64_t bucket_count(size_t index) const { return buckets_[index].load(std::memory_order_acquire); }
+
+    // Exclusive upper bound of a bucket; the last one is open-ended
+    static uint64_t bucket_bound_ns(size_t index) { return uint64_t(1) << index; }
+
+    static size_t bucket_for(uint64_t nanoseconds) {
+        size_t width = 0;
+#if defined(__GNUC__) || defined(__clang__)
+        width = nanoseconds ? 64 - static_cast<size_t>(__builtin_clzll(nanoseconds)) : 0;
+#else
+        for (uint64_t value = nanoseconds; value; value >>= 1) {
+            ++width;
+        }
+#endif
+        return width < kBuckets ? width : kBuckets - 1;
+    }
+
+    // Bound of the bucket holding the given quantile (0..1); 0 when empty
+    uint64_t quantile_bound_ns(double quantile) const {
+        uint64_t total = count();
+        if (total == 0) {
+            return 0;
+        }
+        uint64_t rank = static_cast<uint64_t>(quantile * static_cast<double>(total));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < kBuckets; ++i) {
+            seen += bucket_count(i);
+            if (seen > rank) {
+                return bucket_bound_ns(i);
+            }
+        }
+        return bucket_bound_ns(kBuckets - 1);
+    }
+
+    // Fold in another histogram whose writer is idle or stopped
+    void absorb(const LatencyHistogram& other) {
+        for (size_t i = 0; i < kBuckets; ++i) {
+            add(buckets_[i], other.bucket_count(i));
+        }
+        add(count_, other.count());
+        add(sum_ns_, other.sum_ns());
+    }
+
+private:
+    static void add(std::atomic<uint64_t>& counter, uint64_t n) {
+        counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_release);
+    }
+
+    std::atomic<uint64_t> buckets_[kBuckets] = {};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_ns_{0};
+};
+
+} // namespace simple_utcd
@@ -0,0 +1,83 @@
+/*
+ * includes/simple_utcd/latency_summary.hpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "simple_utcd/latency_histogram.hpp"
+#include <cstddef>
+#include <cstdint>
+
+namespace simple_utcd {
+
+/**
+ * @brief Streaming round-trip summary of one upstream, in microseconds
+ *
+ * An EWMA (gain 1/8, as for TCP's smoothed RTT) plus a log2-bucketed
+ * histogram laid out like LatencyHistogram's, but in microseconds and
+ * small enough to copy with every table snapshot. Once kWindow samples
+ * have accumulated the buckets are halved, so old samples fade out and
+ * quantiles follow an upstream whose path changes.
+ */
+struct LatencySummary {
+    static constexpr size_t kBuckets = 24;      // Last bound 2^23 us, about 8 s
+    static constexpr uint32_t kWindow = 256;
+
+    double ewma_us = 0.0;
+    uint32_t count = 0;
+    uint32_t buckets[kBuckets] = {};
+
+    bool empty() const { return count == 0; }
+
+    void record(uint64_t microseconds) {
+        double sample = static_cast<double>(microseconds);
+        ewma_us = count == 0 ? sample : ewma_us + (sample - ewma_us) / 8.0;
+
+        if (count >= kWindow) {
+            count = 0;
+            for (size_t i = 0; i < kBuckets; ++i) {
+                buckets[i] /= 2;
+                count += buckets[i];
+            }
+        }
+        size_t bucket = LatencyHistogram::bucket_for(microseconds);
+        ++buckets[bucket < kBuckets ? bucket : kBuckets - 1];
+        ++count;
+    }
+
+    // Quantile (0..1), interpolated inside its bucket; 0 when empty
+    uint64_t quantile_us(double quantile) const {
+        if (count == 0) {
+            return 0;
+        }
+        double rank = quantile * static_cast<double>(count);
+        uint64_t seen = 0;
+        for (size_t i = 0; i < kBuckets; ++i) {
+            if (buckets[i] == 0 || static_cast<double>(seen + buckets[i]) < rank) {
+                seen += buckets[i];
+                continue;
+            }
+            double lower = i == 0 ? 0.0 : static_cast<double>(uint64_t(1) << (i - 1));
+            double upper = static_cast<double>(uint64_t(1) << i);
+            double within = (rank - static_cast<double>(seen)) / static_cast<double>(buckets[i]);
+            return static_cast<uint64_t>(lower + (upper - lower) * within);
+        }
+        return uint64_t(1) << (kBuckets - 1);
+    }
+};
+
+} // namespace simple_utcd
@@ -39,6 +39,7 @@ public:
     ~Logger();
 
     void set_level(LogLevel level);
+    bool is_enabled(LogLevel level) const { return level >= current_level_; }
     void set_log_file(const std::string& filename);
     void enable_console(bool enable);
     void enable_syslog(bool enable);
@@ -18,12 +18,17 @@
 
 #pragma once
 
+#include "simple_utcd/latency_histogram.hpp"
+#include "simple_utcd/latency_summary.hpp"
+#include "simple_utcd/virtual_clock.hpp"
 #include <string>
 #include <map>
 #include <atomic>
 #include <chrono>
 #include <mutex>
 #include <vector>
+#include <memory>
+#include <functional>
 
 namespace simple_utcd {
 
@@ -81,16 +86,53 @@ public:
     void record_error();
 
     // System resource tracking
-    void update_active_connections(int count);
-    void update_total_connections(int count);
+    void update_active_connections(uint64_t count);
+    void update_total_connections(uint64_t count);
+
+    // Read connection counts from their owner when queried instead of
+    // having them pushed on every connection. Set before sharing.
+    using ConnectionSource = std::function<void(uint64_t& active, uint64_t& total)>;
+    void set_connection_source(ConnectionSource source) { connection_source_ = std::move(source); }
+
+    // Admission control
+    void record_shed();
+    void update_queue_delay(uint64_t delay_us);
+    void update_overloaded(bool overloaded);
+    uint64_t get_total_shed() const { return total_shed_; }
+    uint64_t get_queue_delay_us() const { return queue_delay_us_; }
+    bool is_overloaded() const { return overloaded_; }
+
+    // Kernel packet timestamp delays, summed by their owner on export
+    using TimestampDelaySource = std::function<void(LatencyHistogram& rx_delay, LatencyHistogram& tx_delay)>;
+    void set_timestamp_delay_source(TimestampDelaySource source) { timestamp_delay_source_ = std::move(source); }
+
+    // Accepts per worker CPU and those the kernel received on that CPU
+    using CpuAcceptSource = std::function<void(std::map<int, uint64_t>& accepts, std::map<int, uint64_t>& local)>;
+    void set_cpu_accept_source(CpuAcceptSource source) { cpu_accept_source_ = std::move(source); }
+
+    // Busy-poll spin and work time, and fallbacks to blocking
+    using BusyPollSource = std::function<void(uint64_t& spin_ns, uint64_t& work_ns, uint64_t& sleeps)>;
+    void set_busy_poll_source(BusyPollSource source) { busy_poll_source_ = std::move(source); }
+
+    // Round-trip summary per upstream, keyed by host:port
+    using UpstreamLatencySource = std::function<void(std::map<std::string, LatencySummary>& latencies)>;
+    void set_upstream_latency_source(UpstreamLatencySource source) { upstream_latency_source_ = std::move(source); }
+
+    // Virtual clock tracking error; false while the virtual clock is off
+    using VirtualClockSource = std::function<bool(VirtualClock::Stats& stats)>;
+    void set_virtual_clock_source(VirtualClockSource source) { virtual_clock_source_ = std::move(source); }
+
+    // CPU each named server thread last ran on
+    void update_thread_cpu(const std::string& thread, int cpu);
+    std::map<std::string, int> get_thread_cpus() const;
 
     // Get metrics
     uint64_t get_total_requests() const { return total_requests_; }
     uint64_t get_total_responses() const { return total_responses_; }
     uint64_t get_total_errors() const { return total_errors_; }
     double get_average_response_time() const;
-    int get_active_connections() const { return active_connections_; }
-    int get_total_connections() const { return total_connections_; }
+    uint64_t get_active_connections() const;
+    uint64_t get_total_connections() const;
 
     // Export to Prometheus format
     std::string export_prometheus() const;
@@ -100,10 +142,21 @@ private:
     std::atomic<uint64_t> total_responses_;
     std::atomic<uint64_t> total_errors_;
     std::atomic<uint64_t> total_response_time_us_;
-    std::atomic<int> active_connections_;
-    std::atomic<int> total_connections_;
+    std::atomic<uint64_t> active_connections_;
+    std::atomic<uint64_t> total_connections_;
+    ConnectionSource connection_source_;
+    TimestampDelaySource timestamp_delay_source_;
+    CpuAcceptSource cpu_accept_source_;
+    BusyPollSource busy_poll_source_;
+    UpstreamLatencySource upstream_latency_source_;
+    VirtualClockSource virtual_clock_source_;
+    std::atomic<uint64_t> total_shed_;
+    std::atomic<uint64_t> queue_delay_us_;
+    std::atomic<bool> overloaded_;
     mutable std::mutex response_times_mutex_;
     std::vector<uint64_t> recent_response_times_;
+    mutable std::mutex thread_cpus_mutex_;
+    std::map<std::string, int> thread_cpus_;
 };
 
 } // namespace simple_utcd
@@ -0,0 +1,84 @@
+/*
+ * includes/simple_utcd/ntp_responder.hpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "simple_utcd/discipline_state.hpp"
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+namespace simple_utcd {
+
+/**
+ * @brief NTPv4 server-mode responder (RFC 5905)
+ *
+ * configure() builds the fields every reply shares (stratum, precision,
+ * root delay/dispersion, reference ID) into a 48-byte template once.
+ * build_reply() copies the template and fills in only the per-request
+ * fields: version and poll echoed from the client, the origin timestamp,
+ * and the receive/reference timestamps. The transmit timestamp is written
+ * last with set_transmit_time(), as close to the send as the caller can.
+ *
+ * Timestamps are 64-bit NTP values: seconds since 1900 in the high word,
+ * binary fraction in the low word.
+ */
+class NtpResponder {
+public:
+    static constexpr size_t kPacketSize = 48;
+    static constexpr uint32_t kUnixEpochOffset = 2208988800u;  // 1900-01-01 to 1970-01-01
+    static constexpr double kPhiPpm = 15.0;     // RFC 5905 frequency tolerance
+
+    NtpResponder();
+
+    void configure(int stratum, const std::string& reference_id, int precision);
+
+    int get_stratum() const { return template_[1]; }
+    int get_leap_indicator() const { return template_[0] >> 6; }
+    int get_precision() const { return static_cast<int8_t>(template_[3]); }
+    uint32_t get_reference_id() const;
+
+    // Answer a client request; false when it is not an NTP client packet
+    bool build_reply(const uint8_t* request, size_t size, uint64_t receive_time,
+                     uint8_t* reply) const;
+    static void set_transmit_time(uint8_t* reply, uint64_t transmit_time);
+
+    // Override the template's leap indicator and stratum in a built reply.
+    // After an upstream update, also its root delay and dispersion (the
+    // dispersion grown at kPhiPpm since the update), reference ID and
+    // reference timestamp. Call after build_reply(): the receive timestamp
+    // dates the dispersion.
+    static void set_sync_state(uint8_t* reply, const DisciplineState& state);
+
+    // Current wall-clock time as an NTP timestamp
+    static uint64_t now();
+    static uint64_t to_ntp_time(int64_t unix_seconds, uint32_t nanoseconds);
+    static uint64_t from_unix_nanoseconds(int64_t nanoseconds);  // e.g. a kernel packet stamp
+
+    // log2 seconds of the smallest clock step observed between reads
+    static int measure_precision();
+
+    // An IPv4 address (upstream server), the first four octets of the MD5
+    // of an IPv6 address (RFC 5905 section 7.3), or up to four ASCII characters
+    static uint32_t encode_reference_id(const std::string& reference_id);
+
+private:
+    uint8_t template_[kPacketSize];
+};
+
+} // namespace simple_utcd
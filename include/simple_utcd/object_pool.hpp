@@ -0,0 +1,122 @@
+/*
+ * includes/simple_utcd/object_pool.hpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "mpmc_queue.hpp"
+
+namespace simple_utcd {
+
+/**
+ * @brief Fixed slab of objects recycled through a lock-free free list
+ *
+ * Storage for capacity() objects is allocated once. acquire() constructs
+ * an object in a free slot; the returned pointer's deleter destroys it
+ * and returns the slot. Acquire and release may happen on different
+ * threads, e.g. an acceptor filling a worker's pool and the worker
+ * emptying it. Once the slab is exhausted acquire() falls back to the
+ * heap, so the pool never refuses an object on its own account.
+ */
+template<typename T>
+class ObjectPool {
+public:
+    class Deleter {
+    public:
+        Deleter() : pool_(nullptr) {}
+        explicit Deleter(ObjectPool* pool) : pool_(pool) {}
+
+        void operator()(T* object) const {
+            if (pool_) {
+                pool_->release(object);
+            } else {
+                delete object;
+            }
+        }
+
+    private:
+        ObjectPool* pool_;  // nullptr for heap fallbacks
+    };
+
+    using Ptr = std::unique_ptr<T, Deleter>;
+
+    explicit ObjectPool(size_t capacity)
+        : capacity_(capacity < 1 ? 1 : capacity)
+        , slots_(new Slot[capacity_])
+        , free_slots_(capacity_)
+        , heap_fallbacks_(0)
+    {
+        for (size_t i = 0; i < capacity_; ++i) {
+            size_t index = i;
+            free_slots_.try_push(std::move(index));
+        }
+    }
+
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    template<typename... Args>
+    Ptr acquire(Args&&... args) {
+        size_t index;
+        if (!free_slots_.try_pop(index)) {
+            heap_fallbacks_.fetch_add(1, std::memory_order_relaxed);
+            return Ptr(new T(std::forward<Args>(args)...), Deleter());
+        }
+
+        T* object;
+        try {
+            object = new (&slots_[index].storage) T(std::forward<Args>(args)...);
+        } catch (...) {
+            free_slots_.try_push(std::move(index));
+            throw;
+        }
+        return Ptr(object, Deleter(this));
+    }
+
+    size_t capacity() const { return capacity_; }
+
+    // Approximate while other threads acquire or release
+    size_t available() const { return free_slots_.size_approx(); }
+
+    // Objects that did not fit in the slab and came from the heap
+    uint64_t get_heap_fallbacks() const { return heap_fallbacks_.load(std::memory_order_relaxed); }
+
+private:
+    struct Slot {
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+    };
+
+    void release(T* object) {
+        size_t index = static_cast<size_t>(reinterpret_cast<Slot*>(object) - slots_.get());
+        object->~T();
+        free_slots_.try_push(std::move(index));
+    }
+
+    const size_t capacity_;
+    std::unique_ptr<Slot[]> slots_;
+    BoundedMPMCQueue<size_t> free_slots_;
+    std::atomic<uint64_t> heap_fallbacks_;
+};
+
+} // namespace simple_utcd
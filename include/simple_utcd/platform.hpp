@@ -19,6 +19,9 @@
 #pragma once
 
 #include <string>
+#include <vector>
+
+struct sockaddr_storage;
 
 namespace simple_utcd {
 
@@ -37,6 +40,20 @@ public:
     static bool bind_socket(int socket_fd, const std::string& address, int port);
     static bool listen_socket(int socket_fd, int backlog);
     static int accept_connection(int socket_fd, std::string& client_address);
+    // Accepted sockets come back non-blocking and close-on-exec; the peer
+    // address stays binary unless a caller asks for its text form
+    static int accept_socket(int socket_fd, struct sockaddr_storage* peer = nullptr);
+    static bool get_peer_address(int socket_fd, std::string& client_address);
+    static std::string address_to_string(const struct sockaddr_storage& address);
+    static bool set_non_blocking(int socket_fd);
+    static bool would_block();  // Last socket call failed with EAGAIN/EWOULDBLOCK
+
+    // Steer a SO_REUSEPORT group by CPU: traffic the kernel handles on
+    // socket_cpus[i] goes to the group's i-th socket (in bind/listen
+    // order); other CPUs spread by CPU id. Attaching to any member
+    // applies to the whole group. Linux only.
+    static bool attach_reuseport_cpu_steering(int socket_fd, const std::vector<int>& socket_cpus);
+    static int get_incoming_cpu(int socket_fd);     // CPU that last received for the socket; -1 if unknown
 
     // Time utilities
     static uint32_t get_system_time();
@@ -55,12 +72,18 @@ public:
     static std::string get_process_name();
     static bool daemonize();
 
-    // Error handling
+    // Thread placement (Linux only; other platforms report failure / -1)
+    static bool set_thread_affinity(const std::vector<int>& cpus);  // Calling thread
+    static bool get_thread_affinity(std::vector<int>& cpus);
+    static int get_current_cpu();
+
+    // Error handling: per thread, like errno, since accept loops, workers
+    // and the sync thread all fail independently
     static std::string get_last_error();
     static void set_last_error(const std::string& error);
 
 private:
-    static std::string last_error_;
+    static thread_local std::string last_error_;
 };
 
 } // namespace simple_utcd
@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include "simple_utcd/time_source.hpp"
 #include <string>
 #include <map>
 #include <chrono>
@@ -97,7 +98,7 @@ private:
         std::atomic<uint64_t> active_connections;
         
         ClientState() : tokens(0), rate(0), burst(0),
-                       last_refill(std::chrono::system_clock::now()),
+                       last_refill(TimeSource::current().coarse_now()),
                        active_connections(0) {}
     };
     std::map<std::string, ClientState> clients_;
@@ -0,0 +1,79 @@
+/*
+ * includes/simple_utcd/server_stats.hpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "simple_utcd/latency_histogram.hpp"
+#include <atomic>
+#include <cstdint>
+
+namespace simple_utcd {
+
+/**
+ * @brief One server thread's counters, alone on a cache line
+ *
+ * Every worker, UDP shard and the shared acceptor owns a block and is
+ * its only writer, so add() is a plain load and store rather than a
+ * locked read-modify-write, and no two threads' counters share a line.
+ * Readers sum the blocks; totals are exact once the writers are idle.
+ */
+struct alignas(64) StatsBlock {
+    using Counter = std::atomic<uint64_t>;
+
+    Counter connections_opened{0};  // Admitted, including fast-path replies
+    Counter connections_closed{0};
+    Counter packets_sent{0};
+    Counter packets_received{0};
+    Counter handoff_rejections{0};
+    Counter datagrams_rejected{0};
+    Counter busy_poll_spin_ns{0};   // Busy-poll mode: polling with nothing to do
+    Counter busy_poll_work_ns{0};   // Busy-poll mode: handling events
+    Counter busy_poll_sleeps{0};    // Spins that went idle and fell back to blocking
+
+    // Kernel packet timestamps: arrival to userspace, and the reply's
+    // stamped transmit time to the kernel's send
+    LatencyHistogram kernel_rx_delay;
+    LatencyHistogram kernel_tx_delay;
+
+    // Owner thread only. The release store lets a reader that sees a
+    // close also see the open that preceded it on another thread.
+    static void add(Counter& counter, uint64_t n = 1) {
+        counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_release);
+    }
+
+    static uint64_t read(const Counter& counter) {
+        return counter.load(std::memory_order_acquire);
+    }
+
+    // Fold in a block whose owner has stopped (e.g. a retired worker)
+    void absorb(const StatsBlock& other) {
+        add(connections_opened, read(other.connections_opened));
+        add(connections_closed, read(other.connections_closed));
+        add(packets_sent, read(other.packets_sent));
+        add(packets_received, read(other.packets_received));
+        add(handoff_rejections, read(other.handoff_rejections));
+        add(datagrams_rejected, read(other.datagrams_rejected));
+        add(busy_poll_spin_ns, read(other.busy_poll_spin_ns));
+        add(busy_poll_work_ns, read(other.busy_poll_work_ns));
+        add(busy_poll_sleeps, read(other.busy_poll_sleeps));
+        kernel_rx_delay.absorb(other.kernel_rx_delay);
+        kernel_tx_delay.absorb(other.kernel_tx_delay);
+    }
+};
+
+} // namespace simple_utcd
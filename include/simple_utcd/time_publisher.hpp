@@ -0,0 +1,83 @@
+/*
+ * includes/simple_utcd/time_publisher.hpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "simple_utcd/discipline_state.hpp"
+#include <cstdint>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace simple_utcd {
+
+/**
+ * @brief Shared, pre-encoded current time
+ *
+ * A background thread wakes at each second boundary, reads the clock once
+ * and publishes the seconds value together with its RFC 868 wire form in
+ * a single 64-bit word. Readers on any thread get both with one atomic
+ * load instead of a clock read and an encode per response. Published
+ * values may trail a second boundary by the thread's wakeup latency.
+ * With a discipline attached, seconds and boundaries are those of the
+ * corrected clock.
+ */
+class TimePublisher {
+public:
+    TimePublisher();
+    ~TimePublisher();
+
+    TimePublisher(const TimePublisher&) = delete;
+    TimePublisher& operator=(const TimePublisher&) = delete;
+
+    // Correct the local clock with a published discipline; before start()
+    void set_discipline(const DisciplinePublisher* discipline) { discipline_ = discipline; }
+
+    bool start();
+    void stop();
+    bool is_running() const { return running_; }
+
+    // Read the clock and publish now; the tick thread calls this each
+    // second. Calls are serialized, so a slow one never publishes an older
+    // second over a newer one.
+    void refresh();
+
+    // Readers: one atomic load each
+    uint32_t get_seconds() const;
+    void encode_rfc868(uint8_t* out) const;
+
+    uint64_t get_refresh_count() const { return refresh_count_; }
+
+private:
+    // Seconds in the high word, RFC 868 bytes (network order) in the low word
+    std::atomic<uint64_t> published_;
+    std::atomic<uint64_t> refresh_count_;
+    std::atomic<bool> running_;
+    const DisciplinePublisher* discipline_;
+
+    std::thread tick_thread_;
+    std::mutex mutex_;              // Guards running_ changes and every publish
+    std::condition_variable cv_;
+
+    int64_t corrected_now_ns() const;
+    void refresh_locked();
+    void tick_loop();
+};
+
+} // namespace simple_utcd
@@ -0,0 +1,119 @@
+/*
+ * includes/simple_utcd/time_source.hpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace simple_utcd {
+
+/**
+ * @brief Where the daemon reads the time
+ *
+ * Each clock has a precise read and a coarse one. The coarse reads come
+ * from CLOCK_REALTIME_COARSE / CLOCK_MONOTONIC_COARSE: the kernel's last
+ * tick, a few milliseconds stale at worst, and a plain vDSO load with no
+ * clock-source access. Anything that works in seconds or milliseconds
+ * (rate limits, block expiry, sessions, health-check bookkeeping) should
+ * use them; time that is served to clients or measured in microseconds
+ * stays on the precise reads. raw_now_ns() reads CLOCK_MONOTONIC_RAW, the
+ * oscillator with no NTP slewing applied, which the VirtualClock
+ * disciplines; elsewhere it falls back to the steady clock.
+ *
+ * current() is what everything reads. Tests and benchmarks install() a
+ * ManualTimeSource to drive the clocks themselves.
+ */
+class TimeSource {
+public:
+    using WallClock = std::chrono::system_clock;
+    using SteadyClock = std::chrono::steady_clock;
+
+    virtual ~TimeSource() = default;
+
+    virtual WallClock::time_point now() const;
+    virtual WallClock::time_point coarse_now() const;
+    virtual SteadyClock::time_point steady_now() const;
+    virtual SteadyClock::time_point coarse_steady_now() const;
+    virtual int64_t raw_now_ns() const;
+
+    static const TimeSource& current() {
+        const TimeSource* installed = installed_.load(std::memory_order_acquire);
+        return installed ? *installed : system();
+    }
+
+    // The real clocks
+    static const TimeSource& system();
+
+    // Replace the clocks for every reader; nullptr restores the real ones.
+    // The source must outlive its installation.
+    static void install(const TimeSource* source) {
+        installed_.store(source, std::memory_order_release);
+    }
+
+private:
+    static std::atomic<const TimeSource*> installed_;
+};
+
+/**
+ * @brief Clocks that only move when told to
+ *
+ * Precise and coarse reads agree, and the raw clock is the steady one.
+ * Safe to advance from one thread while others read.
+ */
+class ManualTimeSource : public TimeSource {
+public:
+    // Starts at the real wall-clock time so absolute timestamps stay sane
+    ManualTimeSource()
+        : wall_ns_(std::chrono::duration_cast<std::chrono::nanoseconds>(
+              WallClock::now().time_since_epoch()).count())
+        , steady_ns_(std::chrono::duration_cast<std::chrono::nanoseconds>(
+              SteadyClock::now().time_since_epoch()).count()) {}
+
+    WallClock::time_point now() const override {
+        return WallClock::time_point(std::chrono::duration_cast<WallClock::duration>(
+            std::chrono::nanoseconds(wall_ns_.load(std::memory_order_acquire))));
+    }
+    WallClock::time_point coarse_now() const override { return now(); }
+
+    SteadyClock::time_point steady_now() const override {
+        return SteadyClock::time_point(std::chrono::duration_cast<SteadyClock::duration>(
+            std::chrono::nanoseconds(steady_ns_.load(std::memory_order_acquire))));
+    }
+    SteadyClock::time_point coarse_steady_now() const override { return steady_now(); }
+    int64_t raw_now_ns() const override { return steady_ns_.load(std::memory_order_acquire); }
+
+    // Both clocks move forward together
+    void advance(std::chrono::nanoseconds step) {
+        wall_ns_.fetch_add(step.count(), std::memory_order_acq_rel);
+        steady_ns_.fetch_add(step.count(), std::memory_order_acq_rel);
+    }
+
+    // Step the wall clock alone, as settimeofday() would
+    void set_wall_time(WallClock::time_point time) {
+        wall_ns_.store(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            time.time_since_epoch()).count(), std::memory_order_release);
+    }
+
+private:
+    std::atomic<int64_t> wall_ns_;
+    std::atomic<int64_t> steady_ns_;
+};
+
+} // namespace simple_utcd
@@ -18,9 +18,11 @@
 
 #pragma once
 
+#include "simple_utcd/latency_summary.hpp"
 #include <string>
 #include <vector>
 #include <map>
+#include <memory>
 #include <chrono>
 #include <mutex>
 #include <atomic>
@@ -46,7 +48,8 @@ enum class SelectionStrategy {
     ROUND_ROBIN,
     LEAST_LATENCY,
     HEALTH_BASED,
-    PRIORITY
+    PRIORITY,
+    INTERSECTION    // Health-based among the last sync round's truechimers
 };
 
 /**
@@ -57,21 +60,47 @@ struct UpstreamServer {
     int port;
     int priority;
     ServerStatus status;
-    uint64_t response_time_ms;
+    uint64_t response_time_ms;          // Last sample; see latency for the distribution
+    LatencySummary latency;
     uint64_t success_count;
     uint64_t failure_count;
     std::chrono::system_clock::time_point last_check;
     std::chrono::system_clock::time_point last_success;
     std::chrono::system_clock::time_point last_failure;
     bool enabled;
+    bool falseticker;                   // Outside the last intersection
     
     UpstreamServer() : port(37), priority(0), status(ServerStatus::UNKNOWN),
                       response_time_ms(0), success_count(0), failure_count(0),
-                      enabled(true) {}
+                      enabled(true), falseticker(false) {}
 };
 
+/**
+ * @brief One answer or miss from an upstream, for record_results()
+ */
+struct UpstreamResult {
+    std::string address;
+    bool success;
+    std::chrono::microseconds response_time;    // Only set on success
+};
+
+/**
+ * @brief A selected server, valid for as long as the handle is held
+ *
+ * Points into an immutable snapshot of the server table and keeps that
+ * snapshot alive; later updates publish new snapshots instead of
+ * changing this one.
+ */
+using UpstreamHandle = std::shared_ptr<const UpstreamServer>;
+
 /**
  * @brief Upstream server manager with failover support
+ *
+ * The table is kept twice: a map that writers change under
+ * servers_mutex_, and an immutable, reference-counted snapshot of it that
+ * every writer republishes before unlocking. Selection and the status
+ * queries read the current snapshot and never take the lock, so they
+ * scale with readers and never wait behind a writer.
  */
 class UpstreamManager {
 public:
@@ -80,10 +109,21 @@ public:
 
     // Configuration
     void set_selection_strategy(SelectionStrategy strategy);
+    SelectionStrategy get_selection_strategy() const { return strategy_; }
     void set_health_check_interval(uint64_t interval_seconds);
     void set_failover_threshold(uint64_t consecutive_failures);
     void set_recovery_threshold(uint64_t consecutive_successes);
     void set_timeout(uint64_t timeout_ms);
+    void set_probe_concurrency(size_t max_probes);  // Probes in flight per sweep; 0 is unlimited
+    size_t get_probe_concurrency() const { return probe_concurrency_; }
+    
+    // Hedged sync rounds: query the best-ranked server and, each time the
+    // given percentile of recent answer times passes without a reply, the
+    // next one too, up to max_outstanding at once. 0 turns hedging off.
+    void set_hedge_delay_percentile(double percentile);
+    double get_hedge_delay_percentile() const { return hedge_delay_percentile_; }
+    void set_hedge_max_outstanding(size_t max_outstanding);
+    size_t get_hedge_max_outstanding() const { return hedge_max_outstanding_; }
     
     // Server management
     bool add_server(const std::string& address, int port = 37, int priority = 0);
@@ -93,17 +133,28 @@ public:
     void clear_servers();
     std::vector<UpstreamServer> get_servers() const;
     
-    // Server selection
-    UpstreamServer* select_server();
-    UpstreamServer* get_primary_server();
-    UpstreamServer* get_backup_server();
+    // Server selection; null when no server qualifies
+    UpstreamHandle select_server() const;
+    UpstreamHandle get_primary_server() const;
+    UpstreamHandle get_backup_server() const;
+    
+    // Enabled servers in the order the strategy prefers them; servers
+    // marked down follow the available ones. Round robin lists from the
+    // server select_server() returns next, without moving past it.
+    std::vector<UpstreamServer> rank_servers() const;
     
-    // Health monitoring
+    // Health monitoring. Probes run concurrently with the table unlocked;
+    // results are merged back in one short critical section.
     bool check_server_health(const std::string& address);
     void check_all_servers_health();
     void record_success(const std::string& address, uint64_t response_time_ms);
+    void record_success(const std::string& address, std::chrono::microseconds response_time);
     void record_failure(const std::string& address);
     
+    // A whole round's results, applied under one lock and published as one
+    // snapshot rather than a table copy per server
+    void record_results(const std::vector<UpstreamResult>& results);
+    
     // Status
     ServerStatus get_server_status(const std::string& address) const;
     uint64_t get_server_response_time(const std::string& address) const;
@@ -116,31 +167,59 @@ public:
     
     // Automatic recovery
     void update_server_status();
+    
+    // Mark exactly these servers as falsetickers, clearing the rest
+    void set_falsetickers(const std::vector<std::string>& addresses);
+    
+    // "round_robin", "least_latency", "health_based", "priority" or "intersection"
+    static bool parse_selection_strategy(const std::string& name, SelectionStrategy& strategy);
 
 private:
-    SelectionStrategy strategy_;
+    using Snapshot = std::vector<UpstreamServer>;     // In address order
+    using SnapshotPtr = std::shared_ptr<const Snapshot>;
+
+    std::atomic<SelectionStrategy> strategy_;
     uint64_t health_check_interval_seconds_;
     uint64_t failover_threshold_;
     uint64_t recovery_threshold_;
     uint64_t timeout_ms_;
+    std::atomic<size_t> probe_concurrency_;
+    std::atomic<double> hedge_delay_percentile_;
+    std::atomic<size_t> hedge_max_outstanding_;
     
     std::map<std::string, UpstreamServer> servers_;
     mutable std::mutex servers_mutex_;
+    SnapshotPtr snapshot_;          // Only through load/publish_snapshot()
+
+    SnapshotPtr load_snapshot() const;
+    void publish_snapshot();        // With servers_mutex_ held
+    
+    mutable std::atomic<size_t> current_round_robin_index_;
     
-    std::atomic<size_t> current_round_robin_index_;
+    // Health check: probe without the lock (round trips in us, 0 on
+    // failure), apply each result under it
+    std::vector<uint64_t> probe_servers(const std::vector<UpstreamServer>& servers) const;
+    bool apply_probe_result(UpstreamServer& server, uint64_t response_time_us);
+    void apply_success(UpstreamServer& server, uint64_t response_time_us);
+    void apply_failure(UpstreamServer& server);
     
-    // Health check
-    bool perform_health_check(UpstreamServer& server);
-    uint64_t measure_response_time(const std::string& address, int port);
+    // Selection, over one snapshot. Every strategy but round robin is an
+    // order on servers: select_from() takes its first available server and
+    // rank_servers() sorts by it.
+    const UpstreamServer* select_from(const Snapshot& servers) const;
+    const UpstreamServer* select_round_robin(const Snapshot& servers) const;
+    static bool ranks_before(SelectionStrategy strategy, const UpstreamServer& a, const UpstreamServer& b);
+    static bool healthier(const UpstreamServer& a, const UpstreamServer& b);
+    const UpstreamServer* find_primary_server(const Snapshot& servers) const;
+    static const UpstreamServer* find_server(const Snapshot& servers, const std::string& address);
+    static UpstreamHandle make_handle(const SnapshotPtr& snapshot, const UpstreamServer* server);
     
-    // Selection algorithms
-    UpstreamServer* select_round_robin();
-    UpstreamServer* select_least_latency();
-    UpstreamServer* select_health_based();
-    UpstreamServer* select_priority();
+    // Latency ranking: p50 first for LEAST_LATENCY, p95 first for HEALTH_BASED
+    static bool faster(const UpstreamServer& a, const UpstreamServer& b, double first, double second);
     
     // Status management
     void update_server_health(UpstreamServer& server);
+    bool is_available(const UpstreamServer& server) const;
     bool should_failover(const UpstreamServer& server) const;
     bool should_recover(const UpstreamServer& server) const;
     
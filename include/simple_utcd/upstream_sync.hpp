@@ -0,0 +1,148 @@
+/*
+ * includes/simple_utcd/upstream_sync.hpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "simple_utcd/upstream_manager.hpp"
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace simple_utcd {
+
+/**
+ * @brief One NTP exchange with an upstream
+ *
+ * Offset is how far the upstream's clock is ahead of the local wall
+ * clock; delay is the round trip less the upstream's own processing time
+ * (RFC 5905 section 8). local_time_ns is when the reply was read, and
+ * response_ns how long the client waited for it.
+ */
+struct UpstreamSample {
+    std::string address;
+    int port = 0;
+    bool valid = false;
+    int64_t offset_ns = 0;
+    int64_t delay_ns = 0;
+    int64_t local_time_ns = 0;
+    int64_t raw_time_ns = 0;        // CLOCK_MONOTONIC_RAW read with local_time_ns
+    int64_t response_ns = 0;
+    int64_t root_delay_ns = 0;      // The upstream's own distance to its reference
+    int64_t root_dispersion_ns = 0;
+    uint32_t reference_id = 0;      // Its address, as NTP replies name their source
+    uint8_t leap = 0;
+    uint8_t stratum = 0;
+    std::string error;      // Why the sample is not valid
+    bool abandoned = false; // A hedged round finished before this answered
+};
+
+/**
+ * @brief Samples upstream time from every server at once
+ *
+ * A round opens one non-blocking UDP socket per upstream, sends the NTP
+ * client requests up front (up to the manager's probe concurrency) and
+ * polls every socket at once, each against its own deadline, so a round
+ * costs the slowest answer (or the timeout) rather than the sum of them.
+ * Replies are matched on the origin timestamp; kiss-o'-death and
+ * unsynchronized replies count as failures. Every upstream is resolved
+ * with getaddrinfo() before the first request goes out, so a slow lookup
+ * never sits between an answer and its read. Where the kernel stamps
+ * arrivals (SO_TIMESTAMPNS), T4 is that stamp rather than the read time.
+ *
+ * A hedged round instead walks the manager's ranking: it queries the best
+ * server, adds the next one whenever the hedge delay passes without an
+ * answer (or a request fails outright), and keeps the first valid answer.
+ * The hedge delay is a percentile of recent answer times, so a healthy
+ * upstream is rarely hedged and a slow one costs about that percentile.
+ */
+class UpstreamSync {
+public:
+    explicit UpstreamSync(UpstreamManager& upstreams);
+
+    void set_timeout(std::chrono::milliseconds timeout) { timeout_ = timeout; }
+    std::chrono::milliseconds get_timeout() const { return timeout_; }
+
+    // Query every enabled upstream and record each result with the manager
+    std::vector<UpstreamSample> sample_all();
+
+    // Hedged round over the manager's ranking, recorded the same way;
+    // returns the servers it reached, abandoned ones included
+    std::vector<UpstreamSample> sample_hedged();
+
+    // Wait before the next hedge: the manager's percentile of recent
+    // answer times, or a quarter of the timeout until there are enough
+    std::chrono::nanoseconds get_hedge_delay() const;
+
+    // Query the given servers concurrently, at most max_outstanding at a
+    // time (0: all at once); one sample per server, in order
+    static std::vector<UpstreamSample> query(const std::vector<UpstreamServer>& servers,
+                                             std::chrono::milliseconds timeout,
+                                             size_t max_outstanding = 0);
+
+    // Query ranked servers one at a time, adding the next after each
+    // hedge_delay without an answer, at most max_outstanding at once (0: no
+    // limit); stops at the first usable answer. One sample per server reached.
+    static std::vector<UpstreamSample> query_hedged(const std::vector<UpstreamServer>& ranked,
+                                                    std::chrono::milliseconds timeout,
+                                                    std::chrono::nanoseconds hedge_delay,
+                                                    size_t max_outstanding);
+
+    // Deepest stratum worth following: one more hop is unsynchronized
+    static constexpr uint8_t kMaxStratum = 15;
+
+    // Valid and shallow enough to serve from at one more hop
+    static bool is_usable(const UpstreamSample& sample) { return sample.valid && sample.stratum < kMaxStratum; }
+
+    // Lowest-delay usable sample of a round; false when none answered
+    static bool best_sample(const std::vector<UpstreamSample>& samples, UpstreamSample& best);
+
+    // Intersect and cluster a round's usable samples (ClockSelect). On
+    // success combined is the system peer's sample carrying the combined
+    // offset, and the samples outside the intersection are marked as
+    // falsetickers with the manager. False when no majority agrees.
+    bool combine_samples(const std::vector<UpstreamSample>& samples, UpstreamSample& combined);
+
+    // Half the sample's correctness interval: half its own and the
+    // upstream's root delay (at least RFC 5905's MINDISP, 10 ms), plus the
+    // upstream's root dispersion
+    static int64_t root_distance_ns(const UpstreamSample& sample);
+
+    // Split "host", "host:port" or "[v6]:port" into its parts
+    static bool parse_upstream(const std::string& entry, int default_port,
+                               std::string& host, int& port);
+
+    // Signed difference of two NTP timestamps in nanoseconds, era-safe
+    static int64_t ntp_difference_ns(uint64_t later, uint64_t earlier);
+
+private:
+    static constexpr size_t kHedgeHistory = 128;     // Answer times kept for the percentile
+    static constexpr size_t kMinHedgeHistory = 8;
+
+    UpstreamManager& upstreams_;
+    std::chrono::milliseconds timeout_;
+
+    mutable std::mutex history_mutex_;
+    std::vector<int64_t> response_history_;         // Ring of response_ns
+    size_t history_next_;
+
+    void record_round(const std::vector<UpstreamSample>& samples);
+};
+
+} // namespace simple_utcd
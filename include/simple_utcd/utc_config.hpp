@@ -21,6 +21,7 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <chrono>
 
 namespace simple_utcd {
 
@@ -64,11 +65,19 @@ public:
     int get_listen_port() const { return listen_port_; }
     bool is_ipv6_enabled() const { return enable_ipv6_; }
     int get_max_connections() const { return max_connections_; }
+    bool is_udp_enabled() const { return enable_udp_; }
+    bool is_ntp_enabled() const { return enable_ntp_; }
+    int get_ntp_port() const { return ntp_port_; }
+    bool is_kernel_timestamps_enabled() const { return enable_kernel_timestamps_; }
 
     void set_listen_address(const std::string& address) { listen_address_ = address; }
     void set_listen_port(int port) { listen_port_ = port; }
     void set_ipv6_enabled(bool enabled) { enable_ipv6_ = enabled; }
     void set_max_connections(int max) { max_connections_ = max; }
+    void set_udp_enabled(bool enabled) { enable_udp_ = enabled; }
+    void set_ntp_enabled(bool enabled) { enable_ntp_ = enabled; }
+    void set_ntp_port(int port) { ntp_port_ = port; }
+    void set_kernel_timestamps_enabled(bool enabled) { enable_kernel_timestamps_ = enabled; }
 
     // UTC Server Configuration
     int get_stratum() const { return stratum_; }
@@ -77,6 +86,13 @@ public:
     const std::vector<std::string>& get_upstream_servers() const { return upstream_servers_; }
     int get_sync_interval() const { return sync_interval_; }
     int get_timeout() const { return timeout_; }
+    bool is_upstream_sync_enabled() const { return enable_upstream_sync_; }
+    int get_upstream_probe_concurrency() const { return upstream_probe_concurrency_; }
+    double get_upstream_hedge_percentile() const { return upstream_hedge_percentile_; }
+    int get_upstream_hedge_max_outstanding() const { return upstream_hedge_max_outstanding_; }
+    const std::string& get_upstream_selection_strategy() const { return upstream_selection_strategy_; }
+    bool is_virtual_clock_enabled() const { return enable_virtual_clock_; }
+    int get_virtual_clock_time_constant() const { return virtual_clock_time_constant_; }
 
     void set_stratum(int stratum) { stratum_ = stratum; }
     void set_reference_id(const std::string& id) { reference_id_ = id; }
@@ -84,6 +100,13 @@ public:
     void set_upstream_servers(const std::vector<std::string>& servers) { upstream_servers_ = servers; }
     void set_sync_interval(int interval) { sync_interval_ = interval; }
     void set_timeout(int timeout) { timeout_ = timeout; }
+    void set_upstream_sync_enabled(bool enabled) { enable_upstream_sync_ = enabled; }
+    void set_upstream_probe_concurrency(int probes) { upstream_probe_concurrency_ = probes; }
+    void set_upstream_hedge_percentile(double percentile) { upstream_hedge_percentile_ = percentile; }
+    void set_upstream_hedge_max_outstanding(int requests) { upstream_hedge_max_outstanding_ = requests; }
+    void set_upstream_selection_strategy(const std::string& strategy) { upstream_selection_strategy_ = strategy; }
+    void set_virtual_clock_enabled(bool enabled) { enable_virtual_clock_ = enabled; }
+    void set_virtual_clock_time_constant(int seconds) { virtual_clock_time_constant_ = seconds; }
 
     // Logging Configuration
     const std::string& get_log_file() const { return log_file_; }
@@ -102,23 +125,67 @@ public:
     bool is_query_restriction_enabled() const { return restrict_queries_; }
     const std::vector<std::string>& get_allowed_clients() const { return allowed_clients_; }
     const std::vector<std::string>& get_denied_clients() const { return denied_clients_; }
+    bool is_rate_limiting_enabled() const { return enable_rate_limiting_; }
+    int get_rate_limit_requests_per_second() const { return rate_limit_requests_per_second_; }
+    int get_rate_limit_burst_size() const { return rate_limit_burst_size_; }
+    bool is_ddos_protection_enabled() const { return enable_ddos_protection_; }
+    int get_ddos_threshold() const { return ddos_threshold_; }
+    int get_ddos_block_duration() const { return ddos_block_duration_; }
 
     void set_authentication_enabled(bool enabled) { enable_authentication_ = enabled; }
     void set_authentication_key(const std::string& key) { authentication_key_ = key; }
     void set_query_restriction_enabled(bool enabled) { restrict_queries_ = enabled; }
     void set_allowed_clients(const std::vector<std::string>& clients) { allowed_clients_ = clients; }
     void set_denied_clients(const std::vector<std::string>& clients) { denied_clients_ = clients; }
+    void set_rate_limiting_enabled(bool enabled) { enable_rate_limiting_ = enabled; }
+    void set_rate_limit_requests_per_second(int rate) { rate_limit_requests_per_second_ = rate; }
+    void set_rate_limit_burst_size(int burst) { rate_limit_burst_size_ = burst; }
+    void set_ddos_protection_enabled(bool enabled) { enable_ddos_protection_ = enabled; }
+    void set_ddos_threshold(int threshold) { ddos_threshold_ = threshold; }
+    void set_ddos_block_duration(int seconds) { ddos_block_duration_ = seconds; }
 
     // Performance Configuration
     int get_worker_threads() const { return worker_threads_; }
+    bool is_so_reuseport_enabled() const { return enable_so_reuseport_; }
+    bool is_io_uring_enabled() const { return enable_io_uring_; }
+    int get_handoff_queue_depth() const { return handoff_queue_depth_; }
     int get_max_packet_size() const { return max_packet_size_; }
     bool is_statistics_enabled() const { return enable_statistics_; }
     int get_stats_interval() const { return stats_interval_; }
+    int get_udp_batch_size() const { return udp_batch_size_; }
+    bool is_fast_path_enabled() const { return enable_fast_path_; }
+    const std::string& get_cpu_affinity() const { return cpu_affinity_; }
+    bool is_numa_placement_enabled() const { return enable_numa_placement_; }
+
+    // cpu_affinity expanded to CPU ids ("0-3,8" -> 0,1,2,3,8); empty if unset or invalid
+    std::vector<int> get_cpu_affinity_list() const;
+    static bool parse_cpu_list(const std::string& list, std::vector<int>& cpus);
+    bool is_admission_control_enabled() const { return enable_admission_control_; }
+    int get_admission_target_ms() const { return admission_target_ms_; }
+    int get_admission_interval_ms() const { return admission_interval_ms_; }
+    bool is_cpu_steering_enabled() const { return enable_cpu_steering_; }
+    bool is_busy_poll_enabled() const { return enable_busy_poll_; }
+    int get_busy_poll_us() const { return busy_poll_us_; }
+    int get_busy_poll_idle_us() const { return busy_poll_idle_us_; }
 
     void set_worker_threads(int threads) { worker_threads_ = threads; }
+    void set_so_reuseport_enabled(bool enabled) { enable_so_reuseport_ = enabled; }
+    void set_io_uring_enabled(bool enabled) { enable_io_uring_ = enabled; }
+    void set_handoff_queue_depth(int depth) { handoff_queue_depth_ = depth; }
     void set_max_packet_size(int size) { max_packet_size_ = size; }
     void set_statistics_enabled(bool enabled) { enable_statistics_ = enabled; }
     void set_stats_interval(int interval) { stats_interval_ = interval; }
+    void set_udp_batch_size(int size) { udp_batch_size_ = size; }
+    void set_fast_path_enabled(bool enabled) { enable_fast_path_ = enabled; }
+    void set_cpu_affinity(const std::string& cpus) { cpu_affinity_ = cpus; }
+    void set_numa_placement_enabled(bool enabled) { enable_numa_placement_ = enabled; }
+    void set_admission_control_enabled(bool enabled) { enable_admission_control_ = enabled; }
+    void set_admission_target_ms(int ms) { admission_target_ms_ = ms; }
+    void set_admission_interval_ms(int ms) { admission_interval_ms_ = ms; }
+    void set_cpu_steering_enabled(bool enabled) { enable_cpu_steering_ = enabled; }
+    void set_busy_poll_enabled(bool enabled) { enable_busy_poll_ = enabled; }
+    void set_busy_poll_us(int microseconds) { busy_poll_us_ = microseconds; }
+    void set_busy_poll_idle_us(int microseconds) { busy_poll_idle_us_ = microseconds; }
 
 private:
     // Network Configuration
@@ -126,6 +193,10 @@ private:
     int listen_port_;
     bool enable_ipv6_;
     int max_connections_;
+    bool enable_udp_;
+    bool enable_ntp_;               // NTPv4 server mode (RFC 5905)
+    int ntp_port_;
+    bool enable_kernel_timestamps_; // SO_TIMESTAMPING on UDP sockets
 
     // UTC Server Configuration
     int stratum_;
@@ -134,6 +205,13 @@ private:
     std::vector<std::string> upstream_servers_;
     int sync_interval_;
     int timeout_;
+    bool enable_upstream_sync_;     // Discipline served time from upstream_servers
+    int upstream_probe_concurrency_; // Upstream probes in flight at once; 0 is unlimited
+    double upstream_hedge_percentile_; // Hedge after this percentile of answer times
+    int upstream_hedge_max_outstanding_; // Hedged sync requests in flight; 0 queries all
+    std::string upstream_selection_strategy_; // How a sync round picks its upstream
+    bool enable_virtual_clock_;     // Serve a PLL/FLL clock on CLOCK_MONOTONIC_RAW
+    int virtual_clock_time_constant_; // Discipline loop time constant, seconds
 
     // Logging Configuration
     std::string log_file_;
@@ -147,12 +225,32 @@ private:
     bool restrict_queries_;
     std::vector<std::string> allowed_clients_;
     std::vector<std::string> denied_clients_;
+    bool enable_rate_limiting_;
+    int rate_limit_requests_per_second_;
+    int rate_limit_burst_size_;
+    bool enable_ddos_protection_;
+    int ddos_threshold_;
+    int ddos_block_duration_;
 
     // Performance Configuration
     int worker_threads_;
+    bool enable_so_reuseport_;      // One SO_REUSEPORT listener per worker
+    bool enable_io_uring_;          // io_uring accept/send/close when built in
+    int handoff_queue_depth_;       // Pending connections per worker before rejecting
     int max_packet_size_;
     bool enable_statistics_;
     int stats_interval_;
+    int udp_batch_size_;            // Datagrams per recvmmsg/sendmmsg
+    bool enable_fast_path_;         // Reply from the accepting thread
+    std::string cpu_affinity_;      // CPU list for worker pinning
+    bool enable_numa_placement_;    // Build worker state on its CPU
+    bool enable_admission_control_; // Shed on standing queue delay
+    int admission_target_ms_;       // Acceptable accept-to-service delay
+    int admission_interval_ms_;     // Window the delay must persist
+    bool enable_cpu_steering_;      // Reuseport CBPF steering by CPU
+    bool enable_busy_poll_;         // Spin on the event loop instead of sleeping
+    int busy_poll_us_;              // SO_BUSY_POLL budget per socket read
+    int busy_poll_idle_us_;         // Idle spin before falling back to sleep
 
     void set_defaults();
     bool parse_config_line(const std::string& line);
@@ -18,52 +18,88 @@
 
 #pragma once
 
-#include <memory>
+#include <cstdint>
 #include <string>
-#include <atomic>
+#include <chrono>
 #include "utc_packet.hpp"
 
+struct sockaddr_storage;
+
 namespace simple_utcd {
 
 class UTCConfig;
 class Logger;
 
+/**
+ * @brief Peer IPv4/IPv6 address in fixed-size binary form
+ *
+ * Copying one out of a sockaddr_storage is a few stores; the text form is
+ * only produced by to_string() when access control or logging needs it.
+ */
+struct PeerAddress {
+    uint16_t family = 0;    // AF_INET, AF_INET6, or 0 when unknown
+    uint16_t port = 0;      // Network byte order
+    uint8_t bytes[16] = {}; // IPv4 uses the first four
+
+    static PeerAddress from_sockaddr(const struct sockaddr_storage& address);
+    std::string to_string() const;
+};
+
+// Connections are owned by a single worker at a time (hand-off goes
+// through a queue), so per-connection state needs no atomics
 class UTCConnection {
 public:
-    UTCConnection(int socket_fd, const std::string& client_address,
+    UTCConnection(int socket_fd, const struct sockaddr_storage& peer,
                   UTCConfig* config, Logger* logger);
     ~UTCConnection();
 
+    UTCConnection(const UTCConnection&) = delete;
+    UTCConnection& operator=(const UTCConnection&) = delete;
+
     bool is_connected() const { return connected_; }
-    const std::string& get_client_address() const { return client_address_; }
+    const PeerAddress& get_peer() const { return peer_; }
+    std::string get_client_address() const { return peer_.to_string(); }
     int get_socket_fd() const { return socket_fd_; }
+    std::chrono::steady_clock::time_point get_accepted_at() const { return accepted_at_; }
 
     bool send_packet(const UTCPacket& packet);
     bool receive_packet(UTCPacket& packet);
     void close_connection();
 
+    // Non-blocking sockets: bytes that could not be written yet are kept
+    // and written by flush() on the next writable notification
+    bool has_pending_data() const { return send_offset_ < send_size_; }
+    bool flush();
+
     // Connection statistics
-    int get_packets_sent() const { return packets_sent_; }
-    int get_packets_received() const { return packets_received_; }
-    int get_bytes_sent() const { return bytes_sent_; }
-    int get_bytes_received() const { return bytes_received_; }
+    uint64_t get_packets_sent() const { return packets_sent_; }
+    uint64_t get_packets_received() const { return packets_received_; }
+    uint64_t get_bytes_sent() const { return bytes_sent_; }
+    uint64_t get_bytes_received() const { return bytes_received_; }
+
+    // Access control shared with paths that never build a connection object
+    static bool is_address_allowed(const UTCConfig* config, const std::string& address);
+    static bool has_address_restrictions(const UTCConfig* config);
 
 private:
     int socket_fd_;
-    std::string client_address_;
+    PeerAddress peer_;
     UTCConfig* config_;
     Logger* logger_;
 
-    std::atomic<bool> connected_;
-    std::atomic<int> packets_sent_;
-    std::atomic<int> packets_received_;
-    std::atomic<int> bytes_sent_;
-    std::atomic<int> bytes_received_;
+    bool connected_;
+    uint64_t packets_sent_;
+    uint64_t packets_received_;
+    uint64_t bytes_sent_;
+    uint64_t bytes_received_;
+
+    uint8_t send_buffer_[4];    // RFC 868 replies are one 32-bit value
+    size_t send_size_;
+    size_t send_offset_;
+    std::chrono::steady_clock::time_point accepted_at_;  // Start of the queueing delay
 
-    bool send_data(const void* data, size_t size);
     bool receive_data(void* data, size_t size);
     bool is_client_allowed() const;
-    bool is_client_denied() const;
 };
 
 } // namespace simple_utcd
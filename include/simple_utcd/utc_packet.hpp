@@ -34,6 +34,9 @@ public:
     bool from_bytes(const std::vector<uint8_t>& data);
     std::vector<uint8_t> to_bytes() const;
 
+    // Write the 4-byte RFC 868 wire form into out; no allocation
+    static void encode_timestamp(uint32_t timestamp, uint8_t* out);
+
     // UTC time handling
     uint32_t get_timestamp() const { return timestamp_; }
     void set_timestamp(uint32_t timestamp) { timestamp_ = timestamp; }
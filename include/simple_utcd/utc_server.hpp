@@ -23,11 +23,35 @@
 #include <atomic>
 #include <vector>
 #include <mutex>
+#include <condition_variable>
+#include <unordered_map>
+#include <chrono>
+#include <map>
 #include "utc_config.hpp"
 #include "logger.hpp"
 #include "metrics.hpp"
 #include "health_check.hpp"
 #include "async_io.hpp"
+#include "event_loop.hpp"
+#include "io_uring_loop.hpp"
+#include "mpmc_queue.hpp"
+#include "object_pool.hpp"
+#include "server_stats.hpp"
+#include "busy_poller.hpp"
+#include "ntp_responder.hpp"
+#include "discipline_state.hpp"
+#include "upstream_manager.hpp"
+#include "upstream_sync.hpp"
+#include "virtual_clock.hpp"
+#include "datagram_batch.hpp"
+#include "rate_limiter.hpp"
+#include "ddos_protection.hpp"
+#include "time_publisher.hpp"
+#include "admission_control.hpp"
+#include "graceful_degradation.hpp"
+#include "utc_connection.hpp"
+
+struct sockaddr_storage;
 
 namespace simple_utcd {
 
@@ -43,15 +67,64 @@ public:
     void stop();
     bool is_running() const { return running_; }
 
-    // Server statistics
-    int get_active_connections() const { return active_connections_; }
-    int get_total_connections() const { return total_connections_; }
-    int get_packets_sent() const { return packets_sent_; }
-    int get_packets_received() const { return packets_received_; }
+    // Server statistics, summed over the per-thread counter blocks
+    uint64_t get_active_connections() const;
+    uint64_t get_total_connections() const { return sum_stats(&StatsBlock::connections_opened); }
+    uint64_t get_packets_sent() const { return sum_stats(&StatsBlock::packets_sent); }
+    uint64_t get_packets_received() const { return sum_stats(&StatsBlock::packets_received); }
+    int get_bound_port() const { return bound_port_; }
+    int get_udp_bound_port() const { return udp_bound_port_; }
+    int get_ntp_bound_port() const { return ntp_bound_port_; }
+    bool is_reuseport_active() const { return reuseport_active_; }
+    bool is_io_uring_active() const { return io_uring_active_; }
+    bool is_fast_path_active() const { return fast_path_active_; }
+    bool is_cpu_steering_active() const { return cpu_steering_active_; }
+
+    // Connections accepted per worker shard, in worker order
+    std::vector<uint64_t> get_shard_accept_counts() const;
+
+    // Accepts per worker CPU, and how many of them the kernel had handled
+    // on that same CPU (enable_cpu_steering; needs SO_INCOMING_CPU)
+    void get_cpu_accept_counts(std::map<int, uint64_t>& accepts, std::map<int, uint64_t>& local) const;
+
+    // CPU each server thread last ran on, keyed by thread name
+    std::map<std::string, int> get_thread_cpus() const;
+
+    // Connections that found their worker's pool exhausted and used the heap
+    uint64_t get_connection_pool_fallbacks() const;
+
+    // Connections rejected because a worker's hand-off queue was full
+    uint64_t get_handoff_rejections() const { return sum_stats(&StatsBlock::handoff_rejections); }
+
+    // UDP requests dropped as malformed (NTP) or by access control, DDoS
+    // protection or rate limiting
+    uint64_t get_datagrams_rejected() const { return sum_stats(&StatsBlock::datagrams_rejected); }
+
+    // Busy-poll mode: time worker and UDP threads spent polling with
+    // nothing to do versus handling events, and how often they went idle
+    uint64_t get_busy_poll_spin_ns() const { return sum_stats(&StatsBlock::busy_poll_spin_ns); }
+    uint64_t get_busy_poll_work_ns() const { return sum_stats(&StatsBlock::busy_poll_work_ns); }
+    uint64_t get_busy_poll_sleeps() const { return sum_stats(&StatsBlock::busy_poll_sleeps); }
+
+    // Kernel packet timestamp delays (enable_kernel_timestamps), added into
+    // the given histogram
+    void get_kernel_rx_delay(LatencyHistogram& into) const { sum_histogram(&StatsBlock::kernel_rx_delay, into); }
+    void get_kernel_tx_delay(LatencyHistogram& into) const { sum_histogram(&StatsBlock::kernel_tx_delay, into); }
     
+    // Clock discipline: the sync engine publishes how the local clock is
+    // corrected, and every reply path applies the latest state lock-free
+    void publish_discipline(const DisciplineState& state);
+    DisciplineState get_discipline() const { return discipline_.read(); }
+    uint64_t get_discipline_version() const { return discipline_.get_version(); }
+
+    // Upstream servers queried each sync round (enable_upstream_sync)
+    UpstreamManager* get_upstream_manager() const { return upstream_manager_.get(); }
+
     // Metrics and health
     class PerformanceMetrics* get_performance_metrics() const { return performance_metrics_.get(); }
     class HealthChecker* get_health_checker() const { return health_checker_.get(); }
+    AdmissionController* get_admission_controller() const { return admission_controller_.get(); }
+    GracefulDegradation* get_graceful_degradation() const { return graceful_degradation_.get(); }
 
     // Configuration access
     UTCConfig* get_config() const { return config_; }
@@ -65,18 +138,89 @@ private:
     Logger* logger_;
 
     std::atomic<bool> running_;
-    std::vector<std::unique_ptr<UTCConnection>> connections_;
-    std::vector<std::thread> worker_threads_;
-    std::mutex connections_mutex_;
 
-    // Statistics
-    std::atomic<int> active_connections_;
-    std::atomic<int> total_connections_;
-    std::atomic<int> packets_sent_;
-    std::atomic<int> packets_received_;
+    // Each worker runs its own reactor and owns the sockets handed to it.
+    // With SO_REUSEPORT each worker also owns a listener and accepts itself.
+    using ConnectionPtr = ObjectPool<UTCConnection>::Ptr;
+
+    struct Worker {
+        Worker(size_t queue_depth, size_t pool_capacity);
+
+        EventLoop loop;
+        std::thread thread;
+        size_t index = 0;
+        int cpu = -1;       // Pinned CPU, -1 when unpinned
+        int listen_fd = -1;
+        std::atomic<uint64_t> accepted{0};
+        std::atomic<uint64_t> local_accepts{0};  // Received by the kernel on this worker's CPU
+        std::atomic<uint64_t> open_connections{0};  // Admitted, not yet closed
+        size_t connection_budget = 0;   // This worker's share of max_connections
+        size_t pending_wakeups = 0;     // Hand-offs not yet signalled; acceptor only
+        StatsBlock stats;               // Written by this worker's thread only
+        ObjectPool<UTCConnection> connection_pool;  // Declared first: outlives inbox and table
+        BoundedMPMCQueue<ConnectionPtr> inbox;
+        const size_t inbox_depth;       // handoff_queue_depth; the ring may be larger
+        std::unordered_map<UTCConnection*, ConnectionPtr> connections;
+
+        // io_uring backend: replies stay in their slot until the linked
+        // send and close complete
+        struct ReplySlot {
+            uint8_t data[4];
+            std::chrono::steady_clock::time_point queued_at;
+        };
+        IoUringLoop ring;
+        std::vector<ReplySlot> reply_slots;
+        std::vector<uint32_t> free_slots;
+    };
+    std::vector<std::unique_ptr<Worker>> workers_;
+    size_t next_worker_;
+    static constexpr size_t kWakeupBatch = 16;  // Hand-offs per worker wakeup during a burst
+
+    std::thread accept_thread_;
+    EventLoop accept_loop_;
+
+    // RFC 868 and NTP over UDP: one socket and thread per shard and
+    // protocol (one shard per worker with SO_REUSEPORT, otherwise one)
+    enum class DatagramProtocol { TIME, NTP };
+    struct UdpShard {
+        DatagramProtocol protocol = DatagramProtocol::TIME;
+        EventLoop loop;
+        std::thread thread;
+        size_t index = 0;
+        int cpu = -1;
+        int fd = -1;
+        DatagramBatch::Timestamping timestamping = DatagramBatch::Timestamping::NONE;
+        StatsBlock stats;
+    };
+    std::vector<std::unique_ptr<UdpShard>> udp_shards_;
+
+    // Statistics: workers and UDP shards carry their own blocks; these
+    // cover the shared acceptor and threads that have been stopped
+    StatsBlock acceptor_stats_;
+    StatsBlock retired_stats_;
+
+    // Readers on other threads walk workers_ and udp_shards_ under this;
+    // the control thread takes it to add or retire them. Threads updating
+    // their own blocks never do.
+    mutable std::mutex threads_mutex_;
+    void retire_workers();
+    uint64_t sum_stats(StatsBlock::Counter StatsBlock::*counter) const;
+    void sum_histogram(LatencyHistogram StatsBlock::*histogram, LatencyHistogram& into) const;
+    StatsBlock& thread_stats(Worker* shard) { return shard ? shard->stats : acceptor_stats_; }
 
     // Server socket
     int server_socket_;
+    int bound_port_;
+    int udp_bound_port_;
+    int ntp_bound_port_;
+    bool reuseport_active_;
+    bool io_uring_active_;
+    bool fast_path_active_;
+    bool cpu_steering_active_;
+    bool busy_poll_warned_;     // SO_BUSY_POLL failure logged once per start
+
+    // CPUs from cpu_affinity; threads are placed round-robin over them
+    std::vector<int> cpu_affinity_;
     
     // Metrics and health checking
     std::unique_ptr<PerformanceMetrics> performance_metrics_;
@@ -85,15 +229,80 @@ private:
     // Async I/O support
     std::unique_ptr<AsyncIOManager> async_io_manager_;
 
+    // Current time, read and encoded once per second for every reply path
+    std::unique_ptr<TimePublisher> time_publisher_;
+    NtpResponder ntp_responder_;    // Reply template, fixed while running
+    DisciplinePublisher discipline_;
+    std::mutex discipline_mutex_;   // Serializes publishers only
+
+    // Queue-delay admission control, reported into graceful degradation
+    std::unique_ptr<AdmissionController> admission_controller_;
+    std::unique_ptr<GracefulDegradation> graceful_degradation_;
+    bool admission_control_active_;
+    std::atomic<uint64_t> admission_state_seen_;
+
+    // Per-client admission checks shared by the TCP and UDP paths
+    std::unique_ptr<RateLimiter> rate_limiter_;
+    std::unique_ptr<DDoSProtection> ddos_protection_;
+
+    // Upstream synchronization: one thread samples every upstream per
+    // sync_interval and publishes the discipline, through the virtual
+    // clock's loop when it is enabled
+    std::unique_ptr<UpstreamManager> upstream_manager_;
+    std::unique_ptr<UpstreamSync> upstream_sync_;
+    std::unique_ptr<VirtualClock> virtual_clock_;
+    std::thread sync_thread_;
+    std::mutex sync_mutex_;
+    std::condition_variable sync_cv_;
+
     void accept_connections();
-    void handle_connection(std::unique_ptr<UTCConnection> connection);
-    void worker_thread_main();
+    // Drain a listener's backlog. starved is set while accept() is out of
+    // descriptors, so the caller retries after a backoff
+    void accept_pending(int listen_fd, Worker* shard, bool& starved);
+    bool accept_backlog(int listen_fd, Worker* shard);
+    bool serve_fast_path(int listen_fd, Worker* shard);
+    ConnectionPtr admit_connection(int client_fd, const struct sockaddr_storage& peer,
+                                   Worker& owner, StatsBlock& stats);
+    void dispatch_connection(Worker& worker, ConnectionPtr connection);
+    void flush_wakeups();
+    void register_connection(Worker& worker, ConnectionPtr connection);
+    bool handle_connection(Worker& worker, UTCConnection* connection, uint32_t events);
+    void worker_thread_main(Worker* worker);
+    void adopt_connections(Worker& worker);
+    void release_connection(Worker& worker, UTCConnection* connection);
+    bool open_rings();
+    bool arm_ring_accepts();
+    void ring_worker_main(Worker* worker);
+    void handle_ring_completion(Worker& worker, const UringCompletion& completion, int listen_fd);
+    void serve_ring_connection(Worker& worker, int client_fd);
+    int open_listener(int port, bool reuse_port);
+    bool steer_reuseport_group(int fd, size_t sockets);
+    void set_socket_busy_poll(int fd);
+    void count_shard_accept(Worker& shard, int client_fd);
     bool create_server_socket();
+    bool create_shard_listeners();
     void close_server_socket();
+    int open_datagram_socket(int port, bool reuse_port, int& bound_port,
+                             DatagramBatch::Timestamping& timestamping);
+    bool create_datagram_shards(DatagramProtocol protocol, int port, int& bound_port);
+    void close_udp_sockets();
+    void udp_thread_main(UdpShard* shard);
+    int serve_datagrams(int fd, DatagramBatch& batch, StatsBlock& stats);   // Datagrams received
+    int serve_ntp(int fd, DatagramBatch& batch, StatsBlock& stats);
+    void record_transmit_delays(int fd, DatagramBatch& batch, int64_t transmit_ns, StatsBlock& stats);
+    void configure_admission();
+    bool needs_client_address() const;
+    bool admit_client(const std::string& client_address);
+    bool admit_queued(std::chrono::steady_clock::time_point accepted_at);
+    void pin_thread(int cpu);
+    void report_thread_cpu(const std::string& name, int& last_cpu);
 
     // UTC time handling
     uint32_t get_utc_timestamp();
     void update_reference_time();
+    bool configure_upstreams();
+    void sync_thread_main();
+    void apply_sync_round(const std::vector<UpstreamSample>& samples);
 };
 
 } // namespace simple_utcd
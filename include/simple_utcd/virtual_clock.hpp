@@ -0,0 +1,116 @@
+/*
+ * includes/simple_utcd/virtual_clock.hpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "simple_utcd/discipline_state.hpp"
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+namespace simple_utcd {
+
+/**
+ * @brief Software clock disciplined by upstream samples
+ *
+ * The daemon may not adjust the host clock, so it keeps its own: a line
+ * through CLOCK_MONOTONIC_RAW, which nothing slews or steps, with a phase
+ * and a frequency correction. get_state() hands it to readers as a
+ * DisciplineState on the raw timescale, so serving it costs the same one
+ * clock read as serving the wall clock.
+ *
+ * update() takes one measurement: the reference time seen at a raw clock
+ * reading. The first sets the clock, and any offset beyond
+ * kStepThresholdNs steps it. For the first time constant the loop only
+ * corrects phase while it measures the frequency error directly; after
+ * that it is RFC 5905's hybrid loop, simplified. A type-II PLL corrects
+ * min(1, mu / tau) of each phase error and integrates theta * mu / (4 tau^2)
+ * into the frequency, which is critically damped for a continuous loop.
+ * Once the poll interval reaches kAllanInterceptS, where oscillator wander
+ * outweighs measurement noise, an FLL takes a quarter of theta / mu
+ * instead. The time constant is never taken below the poll interval, which
+ * keeps the discrete loop stable whatever the two are set to.
+ *
+ * Phase corrections are applied at each update, so served time can move
+ * back by a fraction of the measured offset: microseconds once the loop
+ * has converged. Calls are serialized by an internal lock; update() runs
+ * once per sync round, never per request.
+ */
+class VirtualClock {
+public:
+    static constexpr int64_t kStepThresholdNs = 128000000;
+    static constexpr double kMaxFrequencyPpm = 500.0;
+    static constexpr double kAllanInterceptS = 1500.0;
+    static constexpr std::chrono::seconds kDefaultTimeConstant{256};
+
+    // Tracking error, for metrics
+    struct Stats {
+        bool synchronized = false;      // Set by at least one update
+        int64_t offset_ns = 0;          // Last measured phase error
+        double rms_offset_ns = 0.0;     // Phase error, RMS over about 8 updates
+        double frequency_ppm = 0.0;     // Correction applied to the raw clock
+        double wander_ppm = 0.0;        // Frequency change per update, RMS
+        uint64_t updates = 0;
+        uint64_t steps = 0;             // Not counting the first setting
+    };
+
+    explicit VirtualClock(std::chrono::seconds time_constant = kDefaultTimeConstant);
+
+    void set_time_constant(std::chrono::seconds time_constant);
+    std::chrono::seconds get_time_constant() const;
+
+    // One measurement: the reference read reference_ns at raw clock raw_ns
+    void update(int64_t raw_ns, int64_t reference_ns);
+
+    // Forget everything; the next update sets the clock again
+    void reset();
+
+    // Virtual time, Unix nanoseconds, at a raw clock reading
+    int64_t now_ns(int64_t raw_ns) const;
+
+    // The clock as readers apply it; leap and stratum are left unsynchronized
+    DisciplineState get_state() const;
+
+    Stats get_stats() const;
+    bool is_synchronized() const;
+
+private:
+    enum class Phase {
+        UNSET,
+        FREQUENCY,      // Measuring the frequency error
+        LOCKED
+    };
+
+    int64_t now_locked(int64_t raw_ns) const;
+    void set_locked(int64_t raw_ns, int64_t reference_ns);
+
+    mutable std::mutex mutex_;
+    double time_constant_s_;
+    Phase phase_ = Phase::UNSET;
+    int64_t raw_base_ns_ = 0;       // The line passes through (raw_base, time_base)
+    int64_t time_base_ns_ = 0;
+    double frequency_ppm_ = 0.0;
+    int64_t last_update_raw_ns_ = 0;
+    int64_t frequency_start_raw_ns_ = 0;
+    int64_t frequency_phase_ns_ = 0;    // Phase corrected since the measurement began
+    Stats stats_;
+    double offset_square_ns2_ = 0.0;
+    double wander_square_ppm2_ = 0.0;
+};
+
+} // namespace simple_utcd
@@ -0,0 +1,93 @@
+/*
+ * src/core/admission_control.cpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "simple_utcd/admission_control.hpp"
+#include <limits>
+
+namespace simple_utcd {
+
+namespace {
+
+constexpr uint64_t kNoSample = std::numeric_limits<uint64_t>::max();
+
+int64_t to_us(AdmissionController::Clock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(time.time_since_epoch()).count();
+}
+
+} // namespace
+
+AdmissionController::AdmissionController()
+    : target_us_(5000)          // CoDel defaults: 5 ms target, 100 ms interval
+    , interval_us_(100000)
+    , interval_end_us_(0)
+    , interval_min_us_(kNoSample)
+    , last_min_delay_us_(0)
+    , overloaded_(false)
+    , shed_count_(0)
+    , admitted_count_(0)
+    , state_changes_(0)
+{
+}
+
+bool AdmissionController::admit(Clock::time_point accepted_at, Clock::time_point now) {
+    int64_t now_us = to_us(now);
+    int64_t waited = now_us - to_us(accepted_at);
+    uint64_t delay_us = waited > 0 ? static_cast<uint64_t>(waited) : 0;
+
+    if (now_us >= interval_end_us_.load(std::memory_order_relaxed)) {
+        roll_interval(now_us);
+    }
+
+    // Fold this sample into the interval minimum
+    uint64_t current = interval_min_us_.load(std::memory_order_relaxed);
+    while (delay_us < current &&
+           !interval_min_us_.compare_exchange_weak(current, delay_us, std::memory_order_relaxed)) {
+    }
+
+    // Only work that has already waited past the target is shed, and only
+    // while the queue is standing; anything fresher is still worth serving
+    if (overloaded_.load(std::memory_order_relaxed) && delay_us > target_us_.load(std::memory_order_relaxed)) {
+        shed_count_++;
+        return false;
+    }
+    admitted_count_++;
+    return true;
+}
+
+void AdmissionController::roll_interval(int64_t now_us) {
+    // One caller per interval boundary wins; the rest keep going
+    int64_t end = interval_end_us_.load(std::memory_order_relaxed);
+    int64_t next_end = now_us + static_cast<int64_t>(interval_us_.load(std::memory_order_relaxed));
+    if (now_us < end || !interval_end_us_.compare_exchange_strong(end, next_end)) {
+        return;
+    }
+
+    uint64_t min_delay = interval_min_us_.exchange(kNoSample);
+    if (end == 0) {
+        return;  // First sample ever opens the first interval
+    }
+
+    // An interval with no samples had no queue
+    bool overloaded = min_delay != kNoSample && min_delay > target_us_.load(std::memory_order_relaxed);
+    last_min_delay_us_ = min_delay == kNoSample ? 0 : min_delay;
+    if (overloaded_.exchange(overloaded) != overloaded) {
+        state_changes_++;
+    }
+}
+
+} // namespace simple_utcd
@@ -17,6 +17,7 @@
  */
 
 #include "simple_utcd/async_io.hpp"
+#include "simple_utcd/platform.hpp"
 #include <unistd.h>
 #include <sys/socket.h>
 #include <errno.h>
@@ -120,6 +121,10 @@ void AsyncIOManager::async_write(int fd, const void* buffer, size_t size, AsyncI
 }
 
 void AsyncIOManager::worker_thread_main() {
+    if (!cpu_affinity_.empty()) {
+        Platform::set_thread_affinity(cpu_affinity_);
+    }
+
     while (running_) {
         std::unique_ptr<AsyncIOOperation> op;
         
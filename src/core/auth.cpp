@@ -170,18 +170,23 @@ AuthResult Authenticator::authenticate(const std::string& key_id, const std::str
         return result;
     }
     
-    // Create session
+    // Create session; without a random ID there is no session to give
+    result.session_id = generate_session_id();
+    if (result.session_id.empty()) {
+        result.success = false;
+        result.message = "Failed to create session";
+        return result;
+    }
     result.success = true;
     result.message = "Authentication successful";
-    result.session_id = generate_session_id();
-    result.expires_at = std::chrono::system_clock::now() + 
+    result.expires_at = TimeSource::current().coarse_now() + 
                        std::chrono::seconds(session_timeout_seconds_);
     
     {
         std::lock_guard<std::mutex> lock(sessions_mutex_);
         Session session;
         session.key_id = key_id;
-        session.created_at = std::chrono::system_clock::now();
+        session.created_at = TimeSource::current().coarse_now();
         session.expires_at = result.expires_at;
         sessions_[result.session_id] = session;
     }
@@ -250,7 +255,7 @@ bool Authenticator::is_locked_out(const std::string& key_id) const {
     }
     
     if (it->second.count >= max_failed_attempts_) {
-        if (it->second.locked_until > std::chrono::system_clock::now()) {
+        if (it->second.locked_until > TimeSource::current().coarse_now()) {
             return true;
         }
     }
@@ -262,7 +267,7 @@ void Authenticator::record_failed_attempt(const std::string& key_id) {
     std::lock_guard<std::mutex> lock(failed_attempts_mutex_);
     auto& attempt = failed_attempts_[key_id];
     
-    auto now = std::chrono::system_clock::now();
+    auto now = TimeSource::current().coarse_now();
     if (attempt.count == 0 || 
         (now - attempt.first_attempt) > std::chrono::seconds(lockout_duration_seconds_)) {
         attempt.count = 1;
@@ -284,11 +289,8 @@ void Authenticator::record_successful_attempt(const std::string& key_id) {
 std::string Authenticator::generate_session_id() const {
     unsigned char buffer[16];
     if (RAND_bytes(buffer, sizeof(buffer)) != 1) {
-        // Fallback to time-based ID if RAND_bytes fails
-        auto now = std::chrono::system_clock::now();
-        auto time = std::chrono::duration_cast<std::chrono::milliseconds>(
-            now.time_since_epoch()).count();
-        return std::to_string(time);
+        // A time-based fallback would be guessable and could repeat
+        return std::string();
     }
     
     std::ostringstream ss;
@@ -299,7 +301,7 @@ std::string Authenticator::generate_session_id() const {
 }
 
 bool Authenticator::is_expired(const std::chrono::system_clock::time_point& time) const {
-    return time < std::chrono::system_clock::now();
+    return time < TimeSource::current().coarse_now();
 }
 
 } // namespace simple_utcd
@@ -21,6 +21,7 @@
 #include <sstream>
 #include <iomanip>
 #include <ctime>
+#include <algorithm>
 #include <sys/stat.h>
 #if __has_include(<filesystem>)
 #include <filesystem>
@@ -37,6 +38,7 @@ BackupRestoreManager::BackupRestoreManager()
     , max_backups_(10)
     , retention_days_(30)
     , auto_backup_enabled_(false)
+    , backup_sequence_(0)
 {
 }
 
@@ -90,8 +92,10 @@ bool BackupRestoreManager::backup_config(const std::string& config_path, const s
     }
 #endif
     
-    std::lock_guard<std::mutex> lock(backups_mutex_);
-    backups_[backup_id] = entry;
+    {
+        std::lock_guard<std::mutex> lock(backups_mutex_);
+        backups_[backup_id] = entry;
+    }
     
     // Cleanup old backups
     cleanup_old_backups();
@@ -164,8 +168,12 @@ bool BackupRestoreManager::save_state(const std::map<std::string, std::string>&
     }
 #endif
     
-    std::lock_guard<std::mutex> lock(backups_mutex_);
-    backups_[backup_id] = entry;
+    {
+        std::lock_guard<std::mutex> lock(backups_mutex_);
+        backups_[backup_id] = entry;
+    }
+    
+    cleanup_old_backups();
     
     return true;
 }
@@ -243,15 +251,17 @@ bool BackupRestoreManager::save_metrics(const std::string& metrics_data, const s
     entry.description = description;
     entry.size = metrics_data.length();
     
-    std::lock_guard<std::mutex> lock(backups_mutex_);
-    backups_[backup_id] = entry;
+    {
+        std::lock_guard<std::mutex> lock(backups_mutex_);
+        backups_[backup_id] = entry;
+    }
+    
+    cleanup_old_backups();
     
     return true;
 }
 
 bool BackupRestoreManager::load_metrics(std::string& metrics_data, const std::string& backup_id) {
-    std::lock_guard<std::mutex> lock(backups_mutex_);
-    
     std::string backup_path;
     if (backup_id.empty()) {
         // Load most recent
@@ -265,6 +275,7 @@ bool BackupRestoreManager::load_metrics(std::string& metrics_data, const std::st
             });
         backup_path = metrics_backups[0].path;
     } else {
+        std::lock_guard<std::mutex> lock(backups_mutex_);
         auto it = backups_.find(backup_id);
         if (it == backups_.end() || it->second.type != "metrics") {
             return false;
@@ -332,7 +343,7 @@ void BackupRestoreManager::cleanup_old_backups() {
         
         // Remove oldest until under limit
         while (backups_.size() > max_backups_ && !sorted.empty()) {
-            delete_backup(sorted[0].first);
+            erase_backup(sorted[0].first);
             sorted.erase(sorted.begin());
         }
     }
@@ -360,6 +371,10 @@ BackupEntry BackupRestoreManager::get_backup_info(const std::string& backup_id)
 
 bool BackupRestoreManager::delete_backup(const std::string& backup_id) {
     std::lock_guard<std::mutex> lock(backups_mutex_);
+    return erase_backup(backup_id);
+}
+
+bool BackupRestoreManager::erase_backup(const std::string& backup_id) {
     auto it = backups_.find(backup_id);
     if (it == backups_.end()) {
         return false;
@@ -423,6 +438,8 @@ std::string BackupRestoreManager::generate_backup_id(const std::string& type) co
     ss << std::put_time(tm, "%Y%m%d_%H%M%S");
     ss << "_" << std::chrono::duration_cast<std::chrono::milliseconds>(
         now_time.time_since_epoch()).count() % 1000;
+    // Sequence suffix keeps IDs unique for backups taken within the same millisecond
+    ss << "_" << backup_sequence_.fetch_add(1);
     
     return ss.str();
 }
@@ -0,0 +1,182 @@
+/*
+ * src/core/clock_select.cpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "simple_utcd/clock_select.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace simple_utcd {
+
+namespace {
+
+struct Endpoint {
+    int64_t value;
+    int type;   // -1 lower edge, 0 midpoint, +1 upper edge
+};
+
+// Keeps the weights finite for candidates that report no distance at all
+constexpr int64_t kMinRootDistanceNs = 1000;
+
+} // namespace
+
+bool ClockSelect::intersect(const std::vector<Candidate>& candidates, int64_t& low_ns, int64_t& high_ns) {
+    size_t n = candidates.size();
+    if (n == 0) {
+        return false;
+    }
+
+    std::vector<Endpoint> endpoints;
+    endpoints.reserve(3 * n);
+    for (const auto& candidate : candidates) {
+        int64_t distance = std::max<int64_t>(0, candidate.root_distance_ns);
+        endpoints.push_back({candidate.offset_ns - distance, -1});
+        endpoints.push_back({candidate.offset_ns, 0});
+        endpoints.push_back({candidate.offset_ns + distance, 1});
+    }
+    // Lower edges before upper ones at equal values, so touching intervals meet
+    std::sort(endpoints.begin(), endpoints.end(), [](const Endpoint& a, const Endpoint& b) {
+        return a.value < b.value || (a.value == b.value && a.type < b.type);
+    });
+
+    // Allow ever more falsetickers until the rest agree; a majority must remain
+    for (size_t allow = 0; 2 * allow < n; ++allow) {
+        size_t found = 0;   // Midpoints outside the interval
+        int chime = 0;
+        bool have_low = false;
+        int64_t low = 0;
+        for (const auto& endpoint : endpoints) {
+            chime -= endpoint.type;
+            if (chime >= static_cast<int>(n - allow)) {
+                low = endpoint.value;
+                have_low = true;
+                break;
+            }
+            if (endpoint.type == 0) {
+                found++;
+            }
+        }
+
+        chime = 0;
+        bool have_high = false;
+        int64_t high = 0;
+        for (auto it = endpoints.rbegin(); it != endpoints.rend(); ++it) {
+            chime += it->type;
+            if (chime >= static_cast<int>(n - allow)) {
+                high = it->value;
+                have_high = true;
+                break;
+            }
+            if (it->type == 0) {
+                found++;
+            }
+        }
+
+        if (found > allow || !have_low || !have_high) {
+            continue;
+        }
+        if (low <= high) {
+            low_ns = low;
+            high_ns = high;
+            return true;
+        }
+    }
+    return false;
+}
+
+ClockSelect::Result ClockSelect::select(const std::vector<Candidate>& candidates) {
+    Result result;
+    if (!intersect(candidates, result.low_ns, result.high_ns)) {
+        return result;
+    }
+
+    // As in RFC 5905 11.2.1, only offsets inside the intersection count: a
+    // wide interval merely overlapping it does not make a truechimer
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        if (candidates[i].offset_ns >= result.low_ns && candidates[i].offset_ns <= result.high_ns) {
+            result.truechimers.push_back(i);
+        }
+    }
+
+    // Cluster, best (smallest root distance) first
+    std::vector<size_t> cluster = result.truechimers;
+    std::stable_sort(cluster.begin(), cluster.end(), [&](size_t a, size_t b) {
+        return candidates[a].root_distance_ns < candidates[b].root_distance_ns;
+    });
+
+    // squares[k]: sum over the others of (offset_j - offset_k)^2
+    std::vector<double> squares(cluster.size(), 0.0);
+    for (size_t a = 0; a < cluster.size(); ++a) {
+        for (size_t b = a + 1; b < cluster.size(); ++b) {
+            double difference = static_cast<double>(candidates[cluster[a]].offset_ns - candidates[cluster[b]].offset_ns);
+            squares[a] += difference * difference;
+            squares[b] += difference * difference;
+        }
+    }
+
+    while (cluster.size() > kMinSurvivors) {
+        size_t worst = 0;
+        for (size_t k = 1; k < cluster.size(); ++k) {
+            if (squares[k] > squares[worst]) {
+                worst = k;
+            }
+        }
+        double selection_jitter = std::sqrt(squares[worst] / static_cast<double>(cluster.size() - 1));
+
+        int64_t quietest = candidates[cluster[0]].jitter_ns;
+        for (size_t index : cluster) {
+            quietest = std::min(quietest, candidates[index].jitter_ns);
+        }
+        if (selection_jitter <= static_cast<double>(quietest)) {
+            break;
+        }
+
+        for (size_t k = 0; k < cluster.size(); ++k) {
+            double difference = static_cast<double>(candidates[cluster[k]].offset_ns -
+                                                    candidates[cluster[worst]].offset_ns);
+            squares[k] -= difference * difference;
+        }
+        cluster.erase(cluster.begin() + worst);
+        squares.erase(squares.begin() + worst);
+    }
+
+    // Combine, weighting each survivor by how tightly it bounds the time
+    double weights = 0.0;
+    double weighted = 0.0;
+    for (size_t index : cluster) {
+        double weight = 1.0 / static_cast<double>(std::max(kMinRootDistanceNs, candidates[index].root_distance_ns));
+        weights += weight;
+        weighted += weight * static_cast<double>(candidates[index].offset_ns - candidates[cluster[0]].offset_ns);
+    }
+    result.offset_ns = candidates[cluster[0]].offset_ns + static_cast<int64_t>(std::llround(weighted / weights));
+
+    double spread = 0.0;
+    for (size_t index : cluster) {
+        double difference = static_cast<double>(candidates[index].offset_ns - result.offset_ns);
+        spread += difference * difference;
+    }
+    result.jitter_ns = cluster.size() > 1
+        ? static_cast<int64_t>(std::sqrt(spread / static_cast<double>(cluster.size() - 1)))
+        : 0;
+
+    result.survivors = std::move(cluster);
+    result.system_peer = result.survivors[0];
+    result.valid = true;
+    return result;
+}
+
+} // namespace simple_utcd
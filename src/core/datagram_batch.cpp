@@ -0,0 +1,333 @@
+/*
+ * src/core/datagram_batch.cpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "simple_utcd/datagram_batch.hpp"
+#include <cstring>
+#include <errno.h>
+#include <sys/types.h>
+
+#ifdef __linux__
+#include <netinet/in.h>
+#include <linux/errqueue.h>
+#include <linux/net_tstamp.h>
+#endif
+
+namespace simple_utcd {
+
+DatagramBatch::DatagramBatch(size_t capacity)
+    : requests_(capacity < 1 ? 1 : capacity)
+    , replies_(requests_.size())
+    , reply_count_(0)
+    , rx_timestamps_(false)
+    , tx_timestamps_(false)
+    , tx_times_(requests_.size(), 0)
+#ifdef __linux__
+    , tx_next_id_(0)
+    , tx_last_sent_(0)
+#endif
+{
+#ifdef __linux__
+    // Headers point into the fixed buffers once; receive() only resets lengths
+    size_t count = requests_.size();
+    recv_headers_.resize(count);
+    recv_iov_.resize(count);
+    send_headers_.resize(count);
+    send_iov_.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        recv_iov_[i].iov_base = requests_[i].data;
+        recv_iov_[i].iov_len = kMaxDatagramSize;
+        std::memset(&recv_headers_[i], 0, sizeof(recv_headers_[i]));
+        recv_headers_[i].msg_hdr.msg_name = &requests_[i].peer;
+        recv_headers_[i].msg_hdr.msg_iov = &recv_iov_[i];
+        recv_headers_[i].msg_hdr.msg_iovlen = 1;
+
+        send_iov_[i].iov_base = replies_[i].data;
+        std::memset(&send_headers_[i], 0, sizeof(send_headers_[i]));
+        send_headers_[i].msg_hdr.msg_name = &replies_[i].peer;
+        send_headers_[i].msg_hdr.msg_iov = &send_iov_[i];
+        send_headers_[i].msg_hdr.msg_iovlen = 1;
+    }
+#endif
+}
+
+#ifdef __linux__
+
+namespace {
+
+int64_t to_nanoseconds(const struct timespec& ts) {
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+// Software stamp from SCM_TIMESTAMPING or SCM_TIMESTAMPNS; 0 when absent.
+// For error queue messages, also the OPT_ID counter of the sent datagram.
+int64_t parse_timestamp(struct msghdr& message, uint32_t* id, bool* has_id) {
+    int64_t stamp = 0;
+    for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&message); cmsg; cmsg = CMSG_NXTHDR(&message, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPING) {
+            struct scm_timestamping stamps;
+            std::memcpy(&stamps, CMSG_DATA(cmsg), sizeof(stamps));
+            stamp = to_nanoseconds(stamps.ts[0]);
+        } else if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+            struct timespec ts;
+            std::memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+            stamp = to_nanoseconds(ts);
+        } else if (id && ((cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR) ||
+                          (cmsg->cmsg_level == SOL_IPV6 && cmsg->cmsg_type == IPV6_RECVERR))) {
+            struct sock_extended_err error;
+            std::memcpy(&error, CMSG_DATA(cmsg), sizeof(error));
+            if (error.ee_errno == ENOMSG && error.ee_origin == SO_EE_ORIGIN_TIMESTAMPING) {
+                *id = error.ee_data;
+                *has_id = true;
+            }
+        }
+    }
+    return stamp;
+}
+
+} // namespace
+
+int DatagramBatch::receive(int fd) {
+    reply_count_ = 0;
+    for (size_t i = 0; i < recv_headers_.size(); ++i) {
+        auto& header = recv_headers_[i];
+        header.msg_hdr.msg_namelen = sizeof(struct sockaddr_storage);
+        header.msg_hdr.msg_flags = 0;
+        if (rx_timestamps_) {
+            header.msg_hdr.msg_control = control_[i].data;
+            header.msg_hdr.msg_controllen = sizeof(ControlBuffer);
+        }
+    }
+
+    int n;
+    do {
+        n = recvmmsg(fd, recv_headers_.data(), static_cast<unsigned>(recv_headers_.size()),
+                     MSG_DONTWAIT, nullptr);
+    } while (n < 0 && errno == EINTR);
+
+    if (n < 0) {
+        return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+    }
+
+    for (int i = 0; i < n; ++i) {
+        requests_[i].peer_len = recv_headers_[i].msg_hdr.msg_namelen;
+        requests_[i].size = recv_headers_[i].msg_len;
+        requests_[i].kernel_time_ns =
+            rx_timestamps_ ? parse_timestamp(recv_headers_[i].msg_hdr, nullptr, nullptr) : 0;
+    }
+    return n;
+}
+
+bool DatagramBatch::add_reply(size_t index, const void* data, size_t size) {
+    if (reply_count_ >= replies_.size() || size > kMaxDatagramSize) {
+        return false;
+    }
+
+    Datagram& reply = replies_[reply_count_];
+    const Datagram& request = requests_[index];
+    std::memcpy(&reply.peer, &request.peer, request.peer_len);
+    reply.peer_len = request.peer_len;
+    std::memcpy(reply.data, data, size);
+    reply.size = size;
+
+    send_headers_[reply_count_].msg_hdr.msg_namelen = reply.peer_len;
+    send_iov_[reply_count_].iov_len = size;
+    ++reply_count_;
+    return true;
+}
+
+int DatagramBatch::flush(int fd) {
+    size_t sent = 0;
+    size_t attempted = 0;
+    while (attempted < reply_count_) {
+        int n = sendmmsg(fd, &send_headers_[attempted],
+                         static_cast<unsigned>(reply_count_ - attempted), MSG_DONTWAIT);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            ++attempted;    // Skip the reply the kernel refused
+            continue;
+        }
+        attempted += static_cast<size_t>(n);
+        sent += static_cast<size_t>(n);
+    }
+
+    // The kernel numbers every datagram it sends on a stamped socket
+    if (tx_timestamps_) {
+        tx_next_id_ += static_cast<uint32_t>(sent);
+        tx_last_sent_ = static_cast<uint32_t>(sent);
+    }
+
+    reply_count_ = 0;
+    return static_cast<int>(sent);
+}
+
+DatagramBatch::Timestamping DatagramBatch::enable_timestamping(int fd) {
+    // Send stamps come back on the error queue numbered, without payload
+    int flags = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+    int tx_flags = flags | SOF_TIMESTAMPING_TX_SOFTWARE |
+                   SOF_TIMESTAMPING_OPT_ID | SOF_TIMESTAMPING_OPT_TSONLY;
+    if (setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPING, &tx_flags, sizeof(tx_flags)) == 0) {
+        return Timestamping::RECEIVE_TRANSMIT;
+    }
+    if (setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags)) == 0) {
+        return Timestamping::RECEIVE;
+    }
+    int enable = 1;
+    if (setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPNS, &enable, sizeof(enable)) == 0) {
+        return Timestamping::RECEIVE;
+    }
+    return Timestamping::NONE;
+}
+
+void DatagramBatch::set_timestamping(Timestamping mode) {
+    rx_timestamps_ = mode != Timestamping::NONE;
+    tx_timestamps_ = mode == Timestamping::RECEIVE_TRANSMIT;
+    if (rx_timestamps_ && control_.empty()) {
+        size_t count = requests_.size();
+        control_.resize(count);
+        error_headers_.resize(count);
+        for (auto& header : error_headers_) {
+            std::memset(&header, 0, sizeof(header));
+        }
+    }
+    if (!rx_timestamps_) {
+        for (auto& header : recv_headers_) {
+            header.msg_hdr.msg_control = nullptr;
+            header.msg_hdr.msg_controllen = 0;
+        }
+    }
+    tx_next_id_ = 0;
+    tx_last_sent_ = 0;
+}
+
+int DatagramBatch::read_transmit_timestamps(int fd) {
+    if (!tx_timestamps_) {
+        return 0;
+    }
+
+    uint32_t first_id = tx_next_id_ - tx_last_sent_;
+    size_t matched = 0;
+    for (;;) {
+        for (size_t i = 0; i < error_headers_.size(); ++i) {
+            auto& header = error_headers_[i];
+            header.msg_hdr.msg_control = control_[i].data;
+            header.msg_hdr.msg_controllen = sizeof(ControlBuffer);
+            header.msg_hdr.msg_flags = 0;
+        }
+
+        int n;
+        do {
+            n = recvmmsg(fd, error_headers_.data(), static_cast<unsigned>(error_headers_.size()),
+                         MSG_ERRQUEUE | MSG_DONTWAIT, nullptr);
+        } while (n < 0 && errno == EINTR);
+        if (n <= 0) {
+            break;
+        }
+
+        for (int i = 0; i < n; ++i) {
+            uint32_t id = 0;
+            bool has_id = false;
+            int64_t stamp = parse_timestamp(error_headers_[i].msg_hdr, &id, &has_id);
+            // Unsigned distance handles the counter wrapping
+            if (stamp != 0 && has_id && id - first_id < tx_last_sent_ && matched < tx_times_.size()) {
+                tx_times_[matched++] = stamp;
+            }
+        }
+        if (static_cast<size_t>(n) < error_headers_.size()) {
+            break;
+        }
+    }
+
+    tx_last_sent_ = 0;
+    return static_cast<int>(matched);
+}
+
+#else  // recvfrom()/sendto() fallback for platforms without mmsg calls
+
+int DatagramBatch::receive(int fd) {
+    reply_count_ = 0;
+    int count = 0;
+    for (auto& request : requests_) {
+        request.peer_len = sizeof(struct sockaddr_storage);
+        ssize_t n = recvfrom(fd, reinterpret_cast<char*>(request.data), kMaxDatagramSize, 0,
+                             reinterpret_cast<struct sockaddr*>(&request.peer), &request.peer_len);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (count == 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+                return -1;
+            }
+            break;
+        }
+        request.size = static_cast<size_t>(n);
+        request.kernel_time_ns = 0;
+        ++count;
+    }
+    return count;
+}
+
+bool DatagramBatch::add_reply(size_t index, const void* data, size_t size) {
+    if (reply_count_ >= replies_.size() || size > kMaxDatagramSize) {
+        return false;
+    }
+
+    Datagram& reply = replies_[reply_count_++];
+    const Datagram& request = requests_[index];
+    std::memcpy(&reply.peer, &request.peer, request.peer_len);
+    reply.peer_len = request.peer_len;
+    std::memcpy(reply.data, data, size);
+    reply.size = size;
+    return true;
+}
+
+int DatagramBatch::flush(int fd) {
+    int sent = 0;
+    for (size_t i = 0; i < reply_count_; ++i) {
+        const Datagram& reply = replies_[i];
+        ssize_t n = sendto(fd, reinterpret_cast<const char*>(reply.data), reply.size, 0,
+                           reinterpret_cast<const struct sockaddr*>(&reply.peer), reply.peer_len);
+        if (n >= 0) {
+            ++sent;
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            break;
+        }
+    }
+
+    reply_count_ = 0;
+    return sent;
+}
+
+DatagramBatch::Timestamping DatagramBatch::enable_timestamping(int) {
+    return Timestamping::NONE;  // Stamps arrive as control messages, which recvfrom() cannot read
+}
+
+void DatagramBatch::set_timestamping(Timestamping) {
+}
+
+int DatagramBatch::read_transmit_timestamps(int) {
+    return 0;
+}
+
+#endif
+
+} // namespace simple_utcd
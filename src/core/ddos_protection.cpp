@@ -417,7 +417,7 @@ uint64_t DDoSProtection::calculate_connection_rate(const ClientStats& stats) con
 }
 
 std::chrono::system_clock::time_point DDoSProtection::now() const {
-    return std::chrono::system_clock::now();
+    return TimeSource::current().coarse_now();
 }
 
 bool DDoSProtection::is_expired(const std::chrono::system_clock::time_point& time) const {
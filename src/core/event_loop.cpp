@@ -0,0 +1,273 @@
+/*
+ * src/core/event_loop.cpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "simple_utcd/event_loop.hpp"
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <algorithm>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#else
+#include <poll.h>
+#endif
+
+namespace simple_utcd {
+
+EventLoop::EventLoop()
+    : loop_fd_(-1)
+    , wakeup_fd_(-1)
+#ifndef __linux__
+    , wakeup_write_fd_(-1)
+#endif
+{
+}
+
+EventLoop::~EventLoop() {
+    close();
+}
+
+#ifdef __linux__
+
+static uint32_t to_epoll_events(uint32_t events) {
+    uint32_t result = EPOLLET | EPOLLRDHUP;
+    if (events & EVENT_READ) {
+        result |= EPOLLIN;
+    }
+    if (events & EVENT_WRITE) {
+        result |= EPOLLOUT;
+    }
+    return result;
+}
+
+bool EventLoop::open() {
+    if (is_open()) {
+        return true;
+    }
+
+    loop_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (loop_fd_ < 0) {
+        return false;
+    }
+
+    wakeup_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeup_fd_ < 0) {
+        close();
+        return false;
+    }
+
+    // The wakeup descriptor is identified by a null data pointer
+    struct epoll_event ev = {};
+    ev.events = EPOLLIN | EPOLLET;
+    ev.data.ptr = nullptr;
+    if (epoll_ctl(loop_fd_, EPOLL_CTL_ADD, wakeup_fd_, &ev) != 0) {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void EventLoop::close() {
+    if (wakeup_fd_ >= 0) {
+        ::close(wakeup_fd_);
+        wakeup_fd_ = -1;
+    }
+    if (loop_fd_ >= 0) {
+        ::close(loop_fd_);
+        loop_fd_ = -1;
+    }
+}
+
+bool EventLoop::add(int fd, uint32_t events, void* data) {
+    struct epoll_event ev = {};
+    ev.events = to_epoll_events(events);
+    ev.data.ptr = data;
+    return epoll_ctl(loop_fd_, EPOLL_CTL_ADD, fd, &ev) == 0;
+}
+
+bool EventLoop::modify(int fd, uint32_t events, void* data) {
+    struct epoll_event ev = {};
+    ev.events = to_epoll_events(events);
+    ev.data.ptr = data;
+    return epoll_ctl(loop_fd_, EPOLL_CTL_MOD, fd, &ev) == 0;
+}
+
+bool EventLoop::remove(int fd) {
+    return epoll_ctl(loop_fd_, EPOLL_CTL_DEL, fd, nullptr) == 0;
+}
+
+int EventLoop::wait(IOEvent* out, int max_events, int timeout_ms) {
+    constexpr int kMaxBatch = 256;
+    struct epoll_event events[kMaxBatch];
+    int n = epoll_wait(loop_fd_, events, std::min(max_events, kMaxBatch), timeout_ms);
+    if (n < 0) {
+        return errno == EINTR ? 0 : -1;
+    }
+
+    int count = 0;
+    for (int i = 0; i < n; ++i) {
+        if (events[i].data.ptr == nullptr) {
+            drain_wakeup();
+            continue;
+        }
+
+        uint32_t flags = 0;
+        if (events[i].events & EPOLLIN) {
+            flags |= EVENT_READ;
+        }
+        if (events[i].events & EPOLLOUT) {
+            flags |= EVENT_WRITE;
+        }
+        if (events[i].events & (EPOLLERR | EPOLLHUP | EPOLLRDHUP)) {
+            flags |= EVENT_HANGUP;
+        }
+
+        out[count].events = flags;
+        out[count].data = events[i].data.ptr;
+        ++count;
+    }
+    return count;
+}
+
+void EventLoop::wakeup() {
+    uint64_t one = 1;
+    ssize_t written = ::write(wakeup_fd_, &one, sizeof(one));
+    (void)written;  // EAGAIN means a wakeup is already pending
+}
+
+void EventLoop::drain_wakeup() {
+    uint64_t value;
+    while (::read(wakeup_fd_, &value, sizeof(value)) > 0) {
+    }
+}
+
+#else  // poll() fallback for platforms without epoll
+
+bool EventLoop::open() {
+    if (is_open()) {
+        return true;
+    }
+
+    int fds[2];
+    if (pipe(fds) != 0) {
+        return false;
+    }
+    for (int fd : fds) {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+
+    wakeup_fd_ = fds[0];
+    wakeup_write_fd_ = fds[1];
+    loop_fd_ = wakeup_fd_;  // No kernel object; the pipe marks the loop open
+    return true;
+}
+
+void EventLoop::close() {
+    if (wakeup_write_fd_ >= 0) {
+        ::close(wakeup_write_fd_);
+        wakeup_write_fd_ = -1;
+    }
+    if (wakeup_fd_ >= 0) {
+        ::close(wakeup_fd_);
+        wakeup_fd_ = -1;
+    }
+    loop_fd_ = -1;
+    registrations_.clear();
+}
+
+bool EventLoop::add(int fd, uint32_t events, void* data) {
+    registrations_.push_back(Registration{fd, events, data});
+    return true;
+}
+
+bool EventLoop::modify(int fd, uint32_t events, void* data) {
+    for (auto& reg : registrations_) {
+        if (reg.fd == fd) {
+            reg.events = events;
+            reg.data = data;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool EventLoop::remove(int fd) {
+    auto it = std::find_if(registrations_.begin(), registrations_.end(),
+                           [fd](const Registration& reg) { return reg.fd == fd; });
+    if (it == registrations_.end()) {
+        return false;
+    }
+    registrations_.erase(it);
+    return true;
+}
+
+int EventLoop::wait(IOEvent* out, int max_events, int timeout_ms) {
+    std::vector<struct pollfd> pfds;
+    pfds.reserve(registrations_.size() + 1);
+    pfds.push_back({wakeup_fd_, POLLIN, 0});
+    for (const auto& reg : registrations_) {
+        short mask = 0;
+        if (reg.events & EVENT_READ) mask |= POLLIN;
+        if (reg.events & EVENT_WRITE) mask |= POLLOUT;
+        pfds.push_back({reg.fd, mask, 0});
+    }
+
+    int n = ::poll(pfds.data(), pfds.size(), timeout_ms);
+    if (n <= 0) {
+        return (n < 0 && errno != EINTR) ? -1 : 0;
+    }
+
+    if (pfds[0].revents & POLLIN) {
+        drain_wakeup();
+    }
+
+    int count = 0;
+    for (size_t i = 1; i < pfds.size() && count < max_events; ++i) {
+        if (pfds[i].revents == 0) {
+            continue;
+        }
+        uint32_t flags = 0;
+        if (pfds[i].revents & POLLIN) flags |= EVENT_READ;
+        if (pfds[i].revents & POLLOUT) flags |= EVENT_WRITE;
+        if (pfds[i].revents & (POLLERR | POLLHUP | POLLNVAL)) flags |= EVENT_HANGUP;
+        out[count].events = flags;
+        out[count].data = registrations_[i - 1].data;
+        ++count;
+    }
+    return count;
+}
+
+void EventLoop::wakeup() {
+    char byte = 1;
+    ssize_t written = ::write(wakeup_write_fd_, &byte, 1);
+    (void)written;
+}
+
+void EventLoop::drain_wakeup() {
+    char buffer[64];
+    while (::read(wakeup_fd_, buffer, sizeof(buffer)) > 0) {
+    }
+}
+
+#endif
+
+} // namespace simple_utcd
@@ -31,6 +31,8 @@ GracefulDegradation::GracefulDegradation()
     , current_cpu_percent_(0.0)
     , current_connections_(0)
     , current_health_score_(1.0)
+    , current_queue_delay_us_(0)
+    , queue_overloaded_(false)
 {
 }
 
@@ -73,7 +75,7 @@ bool GracefulDegradation::is_feature_enabled(const std::string& name) const {
     std::lock_guard<std::mutex> lock(features_mutex_);
     auto it = features_.find(name);
     if (it != features_.end()) {
-        return it->second.enabled && !should_disable_by_priority(it->second.priority, current_level_);
+        return is_enabled(it->second);
     }
     return false;
 }
@@ -118,11 +120,26 @@ void GracefulDegradation::update_health_score(double health_score) {
     }
 }
 
+void GracefulDegradation::update_queue_delay(uint64_t delay_us, bool overloaded) {
+    current_queue_delay_us_ = delay_us;
+    queue_overloaded_ = overloaded;
+    
+    // Re-evaluate degradation level
+    DegradationLevel new_level = evaluate_degradation_level();
+    if (new_level != current_level_) {
+        set_degradation_level(new_level);
+    }
+}
+
 DegradationLevel GracefulDegradation::evaluate_degradation_level() {
     DegradationLevel calculated = calculate_degradation_level();
     
     if (calculated != current_level_) {
-        degradation_reason_ = "Resource constraints or health degradation detected";
+        if (queue_overloaded_) {
+            degradation_reason_ = "Queueing delay above admission target";
+        } else {
+            degradation_reason_ = "Resource constraints or health degradation detected";
+        }
     }
     
     return calculated;
@@ -145,7 +162,7 @@ std::set<std::string> GracefulDegradation::get_enabled_features() const {
     std::set<std::string> enabled;
     
     for (const auto& pair : features_) {
-        if (is_feature_enabled(pair.first)) {
+        if (is_enabled(pair.second)) {
             enabled.insert(pair.first);
         }
     }
@@ -158,7 +175,7 @@ std::set<std::string> GracefulDegradation::get_disabled_features() const {
     std::set<std::string> disabled;
     
     for (const auto& pair : features_) {
-        if (!is_feature_enabled(pair.first)) {
+        if (!is_enabled(pair.second)) {
             disabled.insert(pair.first);
         }
     }
@@ -172,6 +189,7 @@ DegradationLevel GracefulDegradation::calculate_degradation_level() const {
     bool cpu_high = current_cpu_percent_ > max_cpu_percent_ * 0.9;
     bool connections_high = current_connections_ > max_connections_ * 0.9;
     bool health_low = current_health_score_ < min_health_score_;
+    bool queue_high = queue_overloaded_;
     
     // Emergency: Critical resource exhaustion
     if (memory_high && cpu_high && connections_high) {
@@ -179,12 +197,12 @@ DegradationLevel GracefulDegradation::calculate_degradation_level() const {
     }
     
     // Limited: Multiple constraints
-    if ((memory_high || cpu_high || connections_high) && health_low) {
+    if ((memory_high || cpu_high || connections_high || queue_high) && health_low) {
         return DegradationLevel::LIMITED;
     }
     
     // Degraded: Single constraint or health issue
-    if (memory_high || cpu_high || connections_high || health_low) {
+    if (memory_high || cpu_high || connections_high || queue_high || health_low) {
         return DegradationLevel::DEGRADED;
     }
     
@@ -203,6 +221,13 @@ void GracefulDegradation::apply_degradation_level(DegradationLevel level) {
     }
 }
 
+bool GracefulDegradation::is_enabled(const ServiceFeature& feature) const {
+    if (feature.required) {
+        return true;  // Required features are never degraded away
+    }
+    return feature.enabled && !should_disable_by_priority(feature.priority, current_level_);
+}
+
 bool GracefulDegradation::should_disable_by_priority(ServicePriority priority, 
                                                      DegradationLevel level) const {
     switch (level) {
@@ -26,7 +26,7 @@ namespace simple_utcd {
 
 HealthChecker::HealthChecker()
     : current_status_(HealthStatus::HEALTHY)
-    , last_check_(std::chrono::system_clock::now())
+    , last_check_(TimeSource::current().coarse_now())
 {
 }
 
@@ -40,7 +40,7 @@ HealthCheckResult HealthChecker::check_health() const {
         result.status = current_status_.load();
         result.message = status_message_;
     }
-    result.timestamp = std::chrono::system_clock::now();
+    result.timestamp = TimeSource::current().coarse_now();
     
     // Add UTC-specific health check
     auto utc_result = check_utc_health();
@@ -66,7 +66,7 @@ HealthCheckResult HealthChecker::check_utc_health() const {
     HealthCheckResult result;
     
     // Check if system time is available
-    auto now = std::chrono::system_clock::now();
+    auto now = TimeSource::current().coarse_now();
     auto time_t = std::chrono::system_clock::to_time_t(now);
     
     if (time_t == -1) {
@@ -85,7 +85,7 @@ HealthCheckResult HealthChecker::check_utc_health() const {
     }
     }
     
-    result.timestamp = std::chrono::system_clock::now();
+    result.timestamp = TimeSource::current().coarse_now();
     return result;
 }
 
@@ -97,7 +97,7 @@ HealthCheckResult HealthChecker::check_dependencies() const {
     if (dependencies_.empty()) {
         result.status = HealthStatus::HEALTHY;
         result.message = "No dependencies registered";
-        result.timestamp = std::chrono::system_clock::now();
+        result.timestamp = TimeSource::current().coarse_now();
         return result;
     }
     
@@ -127,7 +127,7 @@ HealthCheckResult HealthChecker::check_dependencies() const {
         result.message = "All dependencies operational";
     }
     
-    result.timestamp = std::chrono::system_clock::now();
+    result.timestamp = TimeSource::current().coarse_now();
     return result;
 }
 
@@ -147,7 +147,7 @@ void HealthChecker::update_dependency_status(const std::string& name, HealthStat
     if (it != dependencies_.end()) {
         it->second.status = status;
         it->second.message = message;
-        it->second.last_update = std::chrono::system_clock::now();
+        it->second.last_update = TimeSource::current().coarse_now();
     }
 }
 
@@ -164,7 +164,7 @@ HealthCheckResult HealthChecker::check_dependency(const std::string& name) const
         result.message = "Dependency not found";
     }
     
-    result.timestamp = std::chrono::system_clock::now();
+    result.timestamp = TimeSource::current().coarse_now();
     return result;
 }
 
@@ -199,7 +199,7 @@ void HealthChecker::set_status(HealthStatus status, const std::string& message)
     std::lock_guard<std::mutex> lock(status_mutex_);
     current_status_ = status;
     status_message_ = message;
-    last_check_ = std::chrono::system_clock::now();
+    last_check_ = TimeSource::current().coarse_now();
 }
 
 std::string HealthChecker::export_json() const {
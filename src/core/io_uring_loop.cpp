@@ -0,0 +1,341 @@
+/*
+ * src/core/io_uring_loop.cpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "simple_utcd/io_uring_loop.hpp"
+#include <unistd.h>
+#include <errno.h>
+
+#ifdef SIMPLE_UTCD_HAVE_LIBURING
+#include <liburing.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#endif
+
+namespace simple_utcd {
+
+#ifdef SIMPLE_UTCD_HAVE_LIBURING
+
+namespace {
+
+// user_data layout: operation in the high word, caller tag in the low word
+enum : uint64_t {
+    OP_ACCEPT = 0,
+    OP_SEND   = 1,
+    OP_CLOSE  = 2,
+    OP_WAKEUP = 3,
+};
+
+uint64_t make_user_data(uint64_t op, uint32_t tag) {
+    return (op << 32) | tag;
+}
+
+} // namespace
+
+struct IoUringLoop::Ring {
+    struct io_uring ring;
+};
+
+IoUringLoop::IoUringLoop()
+    : wakeup_fd_(-1)
+    , wakeup_value_(0)
+    , multishot_(false)
+{
+}
+
+IoUringLoop::~IoUringLoop() {
+    close();
+}
+
+bool IoUringLoop::is_available() {
+    static const bool available = [] {
+        struct io_uring_probe* probe = io_uring_get_probe();
+        if (!probe) {
+            return false;
+        }
+        bool supported = io_uring_opcode_supported(probe, IORING_OP_ACCEPT) &&
+                         io_uring_opcode_supported(probe, IORING_OP_SEND) &&
+                         io_uring_opcode_supported(probe, IORING_OP_CLOSE) &&
+                         io_uring_opcode_supported(probe, IORING_OP_READ);
+        io_uring_free_probe(probe);
+        return supported;
+    }();
+    return available;
+}
+
+bool IoUringLoop::supports_multishot_accept() {
+    static const bool supported = [] {
+        struct io_uring ring;
+        if (io_uring_queue_init(4, &ring, 0) != 0) {
+            return false;
+        }
+
+        bool multishot = false;
+        int listener = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        int client = -1;
+        struct sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t addr_len = sizeof(addr);
+        if (listener >= 0 &&
+            bind(listener, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == 0 &&
+            listen(listener, 1) == 0 &&
+            getsockname(listener, reinterpret_cast<struct sockaddr*>(&addr), &addr_len) == 0) {
+            struct io_uring_sqe* sqe = io_uring_get_sqe(&ring);
+            io_uring_prep_multishot_accept(sqe, listener, nullptr, nullptr, SOCK_CLOEXEC);
+            io_uring_submit(&ring);
+
+            // An old kernel answers -EINVAL at once; a new one accepts the
+            // connection and stays armed
+            client = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            struct io_uring_cqe* cqe = nullptr;
+            struct __kernel_timespec timeout = {1, 0};
+            if (client >= 0 &&
+                connect(client, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == 0 &&
+                io_uring_wait_cqe_timeout(&ring, &cqe, &timeout) == 0) {
+                multishot = cqe->res >= 0 && (cqe->flags & IORING_CQE_F_MORE) != 0;
+                if (cqe->res >= 0) {
+                    ::close(cqe->res);
+                }
+                io_uring_cqe_seen(&ring, cqe);
+            }
+        }
+
+        if (client >= 0) {
+            ::close(client);
+        }
+        if (listener >= 0) {
+            ::close(listener);
+        }
+        io_uring_queue_exit(&ring);     // Cancels the armed accept
+        return multishot;
+    }();
+    return supported;
+}
+
+bool IoUringLoop::open(unsigned entries) {
+    if (is_open()) {
+        return true;
+    }
+    multishot_ = supports_multishot_accept();
+
+    auto ring = std::make_unique<Ring>();
+    if (io_uring_queue_init(entries, &ring->ring, 0) != 0) {
+        return false;
+    }
+    ring_ = std::move(ring);
+
+    wakeup_fd_ = eventfd(0, EFD_CLOEXEC);
+    if (wakeup_fd_ < 0 || !arm_wakeup()) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void IoUringLoop::close() {
+    // Tearing down the ring cancels anything still queued, including
+    // the multishot accept
+    if (ring_) {
+        io_uring_queue_exit(&ring_->ring);
+        ring_.reset();
+    }
+    if (wakeup_fd_ >= 0) {
+        ::close(wakeup_fd_);
+        wakeup_fd_ = -1;
+    }
+}
+
+bool IoUringLoop::is_open() const {
+    return ring_ != nullptr;
+}
+
+static struct io_uring_sqe* next_sqe(struct io_uring* ring) {
+    struct io_uring_sqe* sqe = io_uring_get_sqe(ring);
+    if (!sqe) {
+        // Submission queue full: hand what we have to the kernel and retry
+        io_uring_submit(ring);
+        sqe = io_uring_get_sqe(ring);
+    }
+    return sqe;
+}
+
+bool IoUringLoop::accept(int listen_fd) {
+    struct io_uring_sqe* sqe = next_sqe(&ring_->ring);
+    if (!sqe) {
+        return false;
+    }
+    if (multishot_) {
+        io_uring_prep_multishot_accept(sqe, listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+    } else {
+        io_uring_prep_accept(sqe, listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+    }
+    io_uring_sqe_set_data64(sqe, make_user_data(OP_ACCEPT, 0));
+    return true;
+}
+
+bool IoUringLoop::send_and_close(int fd, const void* data, size_t size, uint32_t tag) {
+    // Both entries must land in the same submission for the link to hold
+    if (io_uring_sq_space_left(&ring_->ring) < 2) {
+        io_uring_submit(&ring_->ring);
+        if (io_uring_sq_space_left(&ring_->ring) < 2) {
+            return false;
+        }
+    }
+
+    // A hard link runs the close even when the send fails
+    struct io_uring_sqe* send_sqe = io_uring_get_sqe(&ring_->ring);
+    io_uring_prep_send(send_sqe, fd, data, size, MSG_NOSIGNAL);
+    io_uring_sqe_set_flags(send_sqe, IOSQE_IO_HARDLINK);
+    io_uring_sqe_set_data64(send_sqe, make_user_data(OP_SEND, tag));
+
+    struct io_uring_sqe* close_sqe = io_uring_get_sqe(&ring_->ring);
+    io_uring_prep_close(close_sqe, fd);
+    io_uring_sqe_set_data64(close_sqe, make_user_data(OP_CLOSE, tag));
+    return true;
+}
+
+bool IoUringLoop::arm_wakeup() {
+    struct io_uring_sqe* sqe = next_sqe(&ring_->ring);
+    if (!sqe) {
+        return false;
+    }
+    io_uring_prep_read(sqe, wakeup_fd_, &wakeup_value_, sizeof(wakeup_value_), 0);
+    io_uring_sqe_set_data64(sqe, make_user_data(OP_WAKEUP, 0));
+    return true;
+}
+
+int IoUringLoop::wait(UringCompletion* out, int max_completions, int timeout_ms) {
+    struct io_uring_cqe* cqe = nullptr;
+    struct __kernel_timespec ts;
+    struct __kernel_timespec* timeout = nullptr;
+    if (timeout_ms >= 0) {
+        ts.tv_sec = timeout_ms / 1000;
+        ts.tv_nsec = static_cast<long long>(timeout_ms % 1000) * 1000000;
+        timeout = &ts;
+    }
+
+    int ret = io_uring_submit_and_wait_timeout(&ring_->ring, &cqe, 1, timeout, nullptr);
+    if (ret < 0) {
+        return (ret == -ETIME || ret == -EINTR) ? 0 : -1;
+    }
+
+    constexpr unsigned kMaxBatch = 256;
+    struct io_uring_cqe* cqes[kMaxBatch];
+    unsigned limit = static_cast<unsigned>(max_completions) < kMaxBatch
+                     ? static_cast<unsigned>(max_completions) : kMaxBatch;
+    unsigned n = io_uring_peek_batch_cqe(&ring_->ring, cqes, limit);
+
+    int count = 0;
+    bool rearm_wakeup = false;
+    for (unsigned i = 0; i < n; ++i) {
+        uint64_t data = io_uring_cqe_get_data64(cqes[i]);
+        uint64_t op = data >> 32;
+        if (op == OP_WAKEUP) {
+            rearm_wakeup = true;
+            continue;
+        }
+
+        UringCompletion& completion = out[count++];
+        completion.op = op == OP_ACCEPT ? UringOp::ACCEPT
+                      : op == OP_SEND ? UringOp::SEND : UringOp::CLOSE;
+        completion.tag = static_cast<uint32_t>(data & 0xFFFFFFFFu);
+        completion.result = cqes[i]->res;
+        completion.more = (cqes[i]->flags & IORING_CQE_F_MORE) != 0;
+    }
+    io_uring_cq_advance(&ring_->ring, n);
+
+    if (rearm_wakeup) {
+        arm_wakeup();
+    }
+    return count;
+}
+
+void IoUringLoop::wakeup() {
+    uint64_t one = 1;
+    ssize_t written = ::write(wakeup_fd_, &one, sizeof(one));
+    (void)written;
+}
+
+#else  // Built without liburing: the server keeps its epoll path
+
+struct IoUringLoop::Ring {
+};
+
+IoUringLoop::IoUringLoop()
+    : wakeup_fd_(-1)
+    , wakeup_value_(0)
+    , multishot_(false)
+{
+}
+
+IoUringLoop::~IoUringLoop() {
+}
+
+bool IoUringLoop::is_available() {
+    return false;
+}
+
+bool IoUringLoop::supports_multishot_accept() {
+    return false;
+}
+
+bool IoUringLoop::open(unsigned entries) {
+    (void)entries;
+    return false;
+}
+
+void IoUringLoop::close() {
+}
+
+bool IoUringLoop::is_open() const {
+    return false;
+}
+
+bool IoUringLoop::accept(int listen_fd) {
+    (void)listen_fd;
+    return false;
+}
+
+bool IoUringLoop::send_and_close(int fd, const void* data, size_t size, uint32_t tag) {
+    (void)fd;
+    (void)data;
+    (void)size;
+    (void)tag;
+    return false;
+}
+
+bool IoUringLoop::arm_wakeup() {
+    return false;
+}
+
+int IoUringLoop::wait(UringCompletion* out, int max_completions, int timeout_ms) {
+    (void)out;
+    (void)max_completions;
+    (void)timeout_ms;
+    errno = ENOSYS;
+    return -1;
+}
+
+void IoUringLoop::wakeup() {
+}
+
+#endif
+
+} // namespace simple_utcd
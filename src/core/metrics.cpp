@@ -180,6 +180,9 @@ PerformanceMetrics::PerformanceMetrics()
     , total_response_time_us_(0)
     , active_connections_(0)
     , total_connections_(0)
+    , total_shed_(0)
+    , queue_delay_us_(0)
+    , overloaded_(false)
 {
 }
 
@@ -206,14 +209,56 @@ void PerformanceMetrics::record_error() {
     total_errors_++;
 }
 
-void PerformanceMetrics::update_active_connections(int count) {
+void PerformanceMetrics::update_active_connections(uint64_t count) {
     active_connections_ = count;
 }
 
-void PerformanceMetrics::update_total_connections(int count) {
+void PerformanceMetrics::update_total_connections(uint64_t count) {
     total_connections_ = count;
 }
 
+uint64_t PerformanceMetrics::get_active_connections() const {
+    if (connection_source_) {
+        uint64_t active = 0;
+        uint64_t total = 0;
+        connection_source_(active, total);
+        return active;
+    }
+    return active_connections_;
+}
+
+uint64_t PerformanceMetrics::get_total_connections() const {
+    if (connection_source_) {
+        uint64_t active = 0;
+        uint64_t total = 0;
+        connection_source_(active, total);
+        return total;
+    }
+    return total_connections_;
+}
+
+void PerformanceMetrics::record_shed() {
+    total_shed_++;
+}
+
+void PerformanceMetrics::update_queue_delay(uint64_t delay_us) {
+    queue_delay_us_ = delay_us;
+}
+
+void PerformanceMetrics::update_overloaded(bool overloaded) {
+    overloaded_ = overloaded;
+}
+
+void PerformanceMetrics::update_thread_cpu(const std::string& thread, int cpu) {
+    std::lock_guard<std::mutex> lock(thread_cpus_mutex_);
+    thread_cpus_[thread] = cpu;
+}
+
+std::map<std::string, int> PerformanceMetrics::get_thread_cpus() const {
+    std::lock_guard<std::mutex> lock(thread_cpus_mutex_);
+    return thread_cpus_;
+}
+
 double PerformanceMetrics::get_average_response_time() const {
     uint64_t responses = total_responses_.load();
     if (responses == 0) {
@@ -222,6 +267,29 @@ double PerformanceMetrics::get_average_response_time() const {
     return static_cast<double>(total_response_time_us_.load()) / responses / 1000.0; // Convert to milliseconds
 }
 
+namespace {
+
+// Cumulative buckets in seconds, from 1 us; finer buckets fold into the first
+void write_histogram(std::ostringstream& ss, const std::string& name, const LatencyHistogram& histogram) {
+    const size_t first_bucket = 10;
+    ss << "# TYPE " << name << " histogram\n";
+    ss << std::defaultfloat << std::setprecision(9);
+
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i + 1 < LatencyHistogram::kBuckets; ++i) {
+        cumulative += histogram.bucket_count(i);
+        if (i >= first_bucket) {
+            ss << name << "_bucket{le=\"" << LatencyHistogram::bucket_bound_ns(i) / 1e9 << "\"} "
+               << cumulative << "\n";
+        }
+    }
+    ss << name << "_bucket{le=\"+Inf\"} " << histogram.count() << "\n";
+    ss << name << "_sum " << histogram.sum_ns() / 1e9 << "\n";
+    ss << name << "_count " << histogram.count() << "\n";
+}
+
+} // namespace
+
 std::string PerformanceMetrics::export_prometheus() const {
     std::ostringstream ss;
     
@@ -238,10 +306,108 @@ std::string PerformanceMetrics::export_prometheus() const {
     ss << "simple_utcd_response_time_ms " << std::fixed << std::setprecision(2) << get_average_response_time() << "\n";
     
     ss << "# TYPE simple_utcd_active_connections gauge\n";
-    ss << "simple_utcd_active_connections " << active_connections_.load() << "\n";
+    ss << "simple_utcd_active_connections " << get_active_connections() << "\n";
     
     ss << "# TYPE simple_utcd_total_connections counter\n";
-    ss << "simple_utcd_total_connections " << total_connections_.load() << "\n";
+    ss << "simple_utcd_total_connections " << get_total_connections() << "\n";
+    
+    ss << "# TYPE simple_utcd_admission_shed_total counter\n";
+    ss << "simple_utcd_admission_shed_total " << total_shed_.load() << "\n";
+    
+    ss << "# TYPE simple_utcd_queue_delay_us gauge\n";
+    ss << "simple_utcd_queue_delay_us " << queue_delay_us_.load() << "\n";
+    
+    ss << "# TYPE simple_utcd_overloaded gauge\n";
+    ss << "simple_utcd_overloaded " << (overloaded_.load() ? 1 : 0) << "\n";
+    
+    if (timestamp_delay_source_) {
+        LatencyHistogram rx_delay;
+        LatencyHistogram tx_delay;
+        timestamp_delay_source_(rx_delay, tx_delay);
+        write_histogram(ss, "simple_utcd_kernel_rx_delay_seconds", rx_delay);
+        write_histogram(ss, "simple_utcd_kernel_tx_delay_seconds", tx_delay);
+    }
+    
+    if (busy_poll_source_) {
+        uint64_t spin_ns = 0;
+        uint64_t work_ns = 0;
+        uint64_t sleeps = 0;
+        busy_poll_source_(spin_ns, work_ns, sleeps);
+        ss << std::defaultfloat << std::setprecision(9);
+        ss << "# TYPE simple_utcd_busy_poll_spin_seconds_total counter\n";
+        ss << "simple_utcd_busy_poll_spin_seconds_total " << spin_ns / 1e9 << "\n";
+        ss << "# TYPE simple_utcd_busy_poll_work_seconds_total counter\n";
+        ss << "simple_utcd_busy_poll_work_seconds_total " << work_ns / 1e9 << "\n";
+        ss << "# TYPE simple_utcd_busy_poll_sleeps_total counter\n";
+        ss << "simple_utcd_busy_poll_sleeps_total " << sleeps << "\n";
+    }
+    
+    if (upstream_latency_source_) {
+        std::map<std::string, LatencySummary> latencies;
+        upstream_latency_source_(latencies);
+        if (!latencies.empty()) {
+            ss << std::defaultfloat << std::setprecision(9);
+            ss << "# TYPE simple_utcd_upstream_latency_seconds gauge\n";
+            for (const auto& entry : latencies) {
+                const LatencySummary& latency = entry.second;
+                std::string labels = "upstream=\"" + entry.first + "\",stat=";
+                ss << "simple_utcd_upstream_latency_seconds{" << labels << "\"ewma\"} "
+                   << latency.ewma_us / 1e6 << "\n";
+                ss << "simple_utcd_upstream_latency_seconds{" << labels << "\"p50\"} "
+                   << latency.quantile_us(0.5) / 1e6 << "\n";
+                ss << "simple_utcd_upstream_latency_seconds{" << labels << "\"p95\"} "
+                   << latency.quantile_us(0.95) / 1e6 << "\n";
+            }
+            ss << "# TYPE simple_utcd_upstream_latency_samples gauge\n";
+            for (const auto& entry : latencies) {
+                ss << "simple_utcd_upstream_latency_samples{upstream=\"" << entry.first << "\"} "
+                   << entry.second.count << "\n";
+            }
+        }
+    }
+    
+    if (virtual_clock_source_) {
+        VirtualClock::Stats clock;
+        if (virtual_clock_source_(clock)) {
+            ss << std::defaultfloat << std::setprecision(9);
+            ss << "# TYPE simple_utcd_virtual_clock_offset_seconds gauge\n";
+            ss << "simple_utcd_virtual_clock_offset_seconds " << clock.offset_ns / 1e9 << "\n";
+            ss << "# TYPE simple_utcd_virtual_clock_rms_offset_seconds gauge\n";
+            ss << "simple_utcd_virtual_clock_rms_offset_seconds " << clock.rms_offset_ns / 1e9 << "\n";
+            ss << "# TYPE simple_utcd_virtual_clock_frequency_ppm gauge\n";
+            ss << "simple_utcd_virtual_clock_frequency_ppm " << clock.frequency_ppm << "\n";
+            ss << "# TYPE simple_utcd_virtual_clock_wander_ppm gauge\n";
+            ss << "simple_utcd_virtual_clock_wander_ppm " << clock.wander_ppm << "\n";
+            ss << "# TYPE simple_utcd_virtual_clock_updates_total counter\n";
+            ss << "simple_utcd_virtual_clock_updates_total " << clock.updates << "\n";
+            ss << "# TYPE simple_utcd_virtual_clock_steps_total counter\n";
+            ss << "simple_utcd_virtual_clock_steps_total " << clock.steps << "\n";
+        }
+    }
+    
+    if (cpu_accept_source_) {
+        std::map<int, uint64_t> accepts;
+        std::map<int, uint64_t> local;
+        cpu_accept_source_(accepts, local);
+        if (!accepts.empty()) {
+            ss << "# TYPE simple_utcd_cpu_accepts_total counter\n";
+            for (const auto& entry : accepts) {
+                ss << "simple_utcd_cpu_accepts_total{cpu=\"" << entry.first << "\"} " << entry.second << "\n";
+            }
+            ss << "# TYPE simple_utcd_cpu_local_accepts_total counter\n";
+            for (const auto& entry : local) {
+                ss << "simple_utcd_cpu_local_accepts_total{cpu=\"" << entry.first << "\"} " << entry.second << "\n";
+            }
+        }
+    }
+    
+    std::lock_guard<std::mutex> lock(thread_cpus_mutex_);
+    if (!thread_cpus_.empty()) {
+        ss << "# TYPE simple_utcd_thread_cpu gauge\n";
+        for (const auto& entry : thread_cpus_) {
+            ss << "simple_utcd_thread_cpu{thread=\"" << entry.first << "\"} " << entry.second << "\n";
+        }
+    }
     
     return ss.str();
 }
@@ -0,0 +1,219 @@
+/*
+ * src/core/ntp_responder.cpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "simple_utcd/ntp_responder.hpp"
+#include "simple_utcd/time_source.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <openssl/evp.h>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#endif
+
+namespace simple_utcd {
+
+namespace {
+
+// Header byte 0: leap indicator (2 bits), version (3 bits), mode (3 bits)
+constexpr uint8_t kModeClient = 3;
+constexpr uint8_t kModeServer = 4;
+constexpr uint8_t kVersion = 4;
+constexpr uint8_t kLeapUnsynchronized = 3;
+constexpr int kUnsynchronizedStratum = 16;
+
+// Field offsets in the 48-byte packet
+constexpr size_t kRootDelayOffset = 4;
+constexpr size_t kRootDispersionOffset = 8;
+constexpr size_t kReferenceIdOffset = 12;
+constexpr size_t kReferenceTimeOffset = 16;
+constexpr size_t kOriginTimeOffset = 24;
+constexpr size_t kReceiveTimeOffset = 32;
+constexpr size_t kTransmitTimeOffset = 40;
+
+void write_u32(uint8_t* out, uint32_t value) {
+    out[0] = static_cast<uint8_t>(value >> 24);
+    out[1] = static_cast<uint8_t>(value >> 16);
+    out[2] = static_cast<uint8_t>(value >> 8);
+    out[3] = static_cast<uint8_t>(value);
+}
+
+void write_u64(uint8_t* out, uint64_t value) {
+    write_u32(out, static_cast<uint32_t>(value >> 32));
+    write_u32(out + 4, static_cast<uint32_t>(value));
+}
+
+uint64_t read_u64(const uint8_t* in) {
+    uint64_t value = 0;
+    for (int i = 0; i < 8; ++i) {
+        value = (value << 8) | in[i];
+    }
+    return value;
+}
+
+// NTP short format: 16.16 fixed-point seconds, saturating
+uint32_t to_short(int64_t nanoseconds) {
+    if (nanoseconds <= 0) {
+        return 0;
+    }
+    uint64_t value = (static_cast<uint64_t>(nanoseconds) << 16) / 1000000000u;
+    return value > 0xFFFFFFFFu ? 0xFFFFFFFFu : static_cast<uint32_t>(value);
+}
+
+} // namespace
+
+NtpResponder::NtpResponder() {
+    configure(kUnsynchronizedStratum, std::string(), -20);
+}
+
+void NtpResponder::configure(int stratum, const std::string& reference_id, int precision) {
+    std::memset(template_, 0, sizeof(template_));
+
+    // Out-of-range strata advertise an unsynchronized server
+    uint8_t leap = 0;
+    if (stratum < 1 || stratum > 15) {
+        stratum = kUnsynchronizedStratum;
+        leap = kLeapUnsynchronized;
+    }
+
+    template_[0] = static_cast<uint8_t>((leap << 6) | (kVersion << 3) | kModeServer);
+    template_[1] = static_cast<uint8_t>(stratum);
+    template_[3] = static_cast<uint8_t>(static_cast<int8_t>(precision));
+
+    // Root delay and dispersion stay zero: the local clock is the reference
+    write_u32(template_ + kReferenceIdOffset, encode_reference_id(reference_id));
+}
+
+uint32_t NtpResponder::get_reference_id() const {
+    const uint8_t* id = template_ + kReferenceIdOffset;
+    return (uint32_t(id[0]) << 24) | (uint32_t(id[1]) << 16) | (uint32_t(id[2]) << 8) | uint32_t(id[3]);
+}
+
+bool NtpResponder::build_reply(const uint8_t* request, size_t size, uint64_t receive_time,
+                               uint8_t* reply) const {
+    if (size < kPacketSize) {
+        return false;
+    }
+
+    uint8_t mode = request[0] & 0x07;
+    uint8_t version = (request[0] >> 3) & 0x07;
+    if (mode != kModeClient || version < 1 || version > 4) {
+        return false;
+    }
+
+    std::memcpy(reply, template_, kPacketSize);
+    reply[0] = static_cast<uint8_t>((template_[0] & 0xC0) | (version << 3) | kModeServer);
+    reply[2] = request[2];  // Poll interval is the client's
+
+    // The clock is read continuously, so the reference is the current second
+    write_u64(reply + kReferenceTimeOffset, receive_time & 0xFFFFFFFF00000000ull);
+    std::memcpy(reply + kOriginTimeOffset, request + kTransmitTimeOffset, 8);
+    write_u64(reply + kReceiveTimeOffset, receive_time);
+    return true;
+}
+
+void NtpResponder::set_transmit_time(uint8_t* reply, uint64_t transmit_time) {
+    write_u64(reply + kTransmitTimeOffset, transmit_time);
+}
+
+void NtpResponder::set_sync_state(uint8_t* reply, const DisciplineState& state) {
+    reply[0] = static_cast<uint8_t>(((state.leap & 0x03) << 6) | (reply[0] & 0x3F));
+    reply[1] = state.stratum;
+    if (state.reference_time_ns == 0) {
+        return;  // The local clock is the reference: the template's fields stand
+    }
+
+    uint64_t reference_time = from_unix_nanoseconds(state.reference_time_ns);
+    uint64_t receive_time = read_u64(reply + kReceiveTimeOffset);
+    double age_ns = receive_time > reference_time
+        ? static_cast<double>(receive_time - reference_time) * 1e9 / 4294967296.0
+        : 0.0;
+    write_u32(reply + kRootDelayOffset, to_short(state.root_delay_ns));
+    write_u32(reply + kRootDispersionOffset,
+              to_short(state.root_dispersion_ns + static_cast<int64_t>(age_ns * kPhiPpm * 1e-6)));
+    write_u32(reply + kReferenceIdOffset, state.reference_id);
+    write_u64(reply + kReferenceTimeOffset, reference_time);
+}
+
+uint64_t NtpResponder::now() {
+    auto since_epoch = TimeSource::current().now().time_since_epoch();
+    return from_unix_nanoseconds(std::chrono::duration_cast<std::chrono::nanoseconds>(since_epoch).count());
+}
+
+uint64_t NtpResponder::from_unix_nanoseconds(int64_t nanoseconds) {
+    int64_t seconds = nanoseconds / 1000000000;
+    int64_t remainder = nanoseconds % 1000000000;
+    if (remainder < 0) {
+        seconds -= 1;
+        remainder += 1000000000;
+    }
+    return to_ntp_time(seconds, static_cast<uint32_t>(remainder));
+}
+
+uint64_t NtpResponder::to_ntp_time(int64_t unix_seconds, uint32_t nanoseconds) {
+    // Era wrap (2036) falls out of the 32-bit truncation, as RFC 5905 intends
+    uint32_t seconds = static_cast<uint32_t>(unix_seconds + kUnixEpochOffset);
+    uint32_t fraction = static_cast<uint32_t>((static_cast<uint64_t>(nanoseconds) << 32) / 1000000000u);
+    return (static_cast<uint64_t>(seconds) << 32) | fraction;
+}
+
+int NtpResponder::measure_precision() {
+    int64_t smallest = std::numeric_limits<int64_t>::max();
+    auto last = std::chrono::system_clock::now();
+    for (int i = 0; i < 128; ++i) {
+        auto current = std::chrono::system_clock::now();
+        int64_t step = std::chrono::duration_cast<std::chrono::nanoseconds>(current - last).count();
+        if (step > 0 && step < smallest) {
+            smallest = step;
+        }
+        last = current;
+    }
+
+    if (smallest == std::numeric_limits<int64_t>::max()) {
+        return -20;  // Clock never moved between reads; assume microseconds
+    }
+    int precision = static_cast<int>(std::ceil(std::log2(static_cast<double>(smallest) / 1e9)));
+    return precision < -32 ? -32 : (precision > 0 ? 0 : precision);
+}
+
+uint32_t NtpResponder::encode_reference_id(const std::string& reference_id) {
+    struct in_addr address;
+    if (inet_pton(AF_INET, reference_id.c_str(), &address) == 1) {
+        return ntohl(address.s_addr);
+    }
+    struct in6_addr address6;
+    if (inet_pton(AF_INET6, reference_id.c_str(), &address6) == 1) {
+        unsigned char digest[EVP_MAX_MD_SIZE];
+        unsigned int length = 0;
+        if (EVP_Digest(&address6, sizeof(address6), digest, &length, EVP_md5(), nullptr) == 1 && length >= 4) {
+            return (uint32_t(digest[0]) << 24) | (uint32_t(digest[1]) << 16) |
+                   (uint32_t(digest[2]) << 8) | uint32_t(digest[3]);
+        }
+    }
+
+    uint8_t code[4] = {0, 0, 0, 0};
+    std::memcpy(code, reference_id.data(), reference_id.size() < 4 ? reference_id.size() : 4);
+    return (uint32_t(code[0]) << 24) | (uint32_t(code[1]) << 16) | (uint32_t(code[2]) << 8) | uint32_t(code[3]);
+}
+
+} // namespace simple_utcd
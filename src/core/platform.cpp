@@ -44,11 +44,16 @@
 #elif __linux__
 #include <sys/time.h>
 #include <time.h>
+#include <sched.h>
+#endif
+
+#ifdef __linux__
+#include <linux/filter.h>
 #endif
 
 namespace simple_utcd {
 
-std::string Platform::last_error_;
+thread_local std::string Platform::last_error_;
 
 bool Platform::is_windows() {
 #ifdef _WIN32
@@ -181,24 +186,99 @@ bool Platform::listen_socket(int socket_fd, int backlog) {
 }
 
 int Platform::accept_connection(int socket_fd, std::string& client_address) {
-    struct sockaddr_in client_addr;
-    socklen_t client_len = sizeof(client_addr);
+    struct sockaddr_storage peer;
+    int client_fd = accept_socket(socket_fd, &peer);
+    if (client_fd >= 0) {
+        client_address = address_to_string(peer);
+    }
+    return client_fd;
+}
 
-    int client_fd = accept(socket_fd, reinterpret_cast<struct sockaddr*>(&client_addr), &client_len);
+int Platform::accept_socket(int socket_fd, struct sockaddr_storage* peer) {
+    socklen_t peer_len = sizeof(struct sockaddr_storage);
+    struct sockaddr* peer_addr = reinterpret_cast<struct sockaddr*>(peer);
+
+#ifdef __linux__
+    // One syscall instead of accept() plus two fcntl() round trips
+    int client_fd = accept4(socket_fd, peer_addr, peer ? &peer_len : nullptr,
+                            SOCK_NONBLOCK | SOCK_CLOEXEC);
+#else
+    int client_fd = accept(socket_fd, peer_addr, peer ? &peer_len : nullptr);
+#endif
     if (client_fd < 0) {
+        if (!would_block()) {
 #ifdef _WIN32
-        last_error_ = "accept() failed: " + std::to_string(WSAGetLastError());
+            last_error_ = "accept() failed: " + std::to_string(WSAGetLastError());
 #else
-        last_error_ = "accept() failed: " + std::string(strerror(errno));
+            last_error_ = "accept() failed: " + std::string(strerror(errno));
 #endif
+        }
         return -1;
     }
 
+#ifndef __linux__
+    if (!set_non_blocking(client_fd)) {
+        close_socket(client_fd);
+        return -1;
+    }
+#ifndef _WIN32
+    fcntl(client_fd, F_SETFD, FD_CLOEXEC);
+#endif
+#endif
+    return client_fd;
+}
+
+bool Platform::get_peer_address(int socket_fd, std::string& client_address) {
+    struct sockaddr_in peer_addr;
+    socklen_t peer_len = sizeof(peer_addr);
+
+    if (getpeername(socket_fd, reinterpret_cast<struct sockaddr*>(&peer_addr), &peer_len) != 0) {
+        last_error_ = "getpeername() failed: " + std::string(strerror(errno));
+        return false;
+    }
+
     char client_ip[INET_ADDRSTRLEN];
-    inet_ntop(AF_INET, &client_addr.sin_addr, client_ip, INET_ADDRSTRLEN);
+    inet_ntop(AF_INET, &peer_addr.sin_addr, client_ip, INET_ADDRSTRLEN);
     client_address = std::string(client_ip);
+    return true;
+}
 
-    return client_fd;
+std::string Platform::address_to_string(const struct sockaddr_storage& address) {
+    char text[INET6_ADDRSTRLEN] = {0};
+    if (address.ss_family == AF_INET) {
+        const auto* v4 = reinterpret_cast<const struct sockaddr_in*>(&address);
+        inet_ntop(AF_INET, &v4->sin_addr, text, sizeof(text));
+    } else if (address.ss_family == AF_INET6) {
+        const auto* v6 = reinterpret_cast<const struct sockaddr_in6*>(&address);
+        inet_ntop(AF_INET6, &v6->sin6_addr, text, sizeof(text));
+    }
+    return std::string(text);
+}
+
+bool Platform::set_non_blocking(int socket_fd) {
+#ifdef _WIN32
+    u_long mode = 1;
+    if (ioctlsocket(socket_fd, FIONBIO, &mode) != 0) {
+        last_error_ = "ioctlsocket() failed: " + std::to_string(WSAGetLastError());
+        return false;
+    }
+    return true;
+#else
+    int flags = fcntl(socket_fd, F_GETFL, 0);
+    if (flags < 0 || fcntl(socket_fd, F_SETFL, flags | O_NONBLOCK) != 0) {
+        last_error_ = "fcntl() failed: " + std::string(strerror(errno));
+        return false;
+    }
+    return true;
+#endif
+}
+
+bool Platform::would_block() {
+#ifdef _WIN32
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+    return errno == EAGAIN || errno == EWOULDBLOCK;
+#endif
 }
 
 uint32_t Platform::get_system_time() {
@@ -355,6 +435,112 @@ bool Platform::daemonize() {
 #endif
 }
 
+bool Platform::attach_reuseport_cpu_steering(int socket_fd, const std::vector<int>& socket_cpus) {
+#if defined(__linux__) && defined(SO_ATTACH_REUSEPORT_CBPF)
+    if (socket_cpus.empty()) {
+        last_error_ = "No sockets to steer to";
+        return false;
+    }
+
+    // A = current CPU; a jeq/ret pair per socket with a known CPU, then
+    // A % sockets for the rest. Out-of-range returns make the kernel
+    // fall back to its hash, but the modulo never produces one.
+    const size_t max_pairs = (BPF_MAXINSNS - 3) / 2;
+    std::vector<struct sock_filter> program;
+    program.push_back(BPF_STMT(BPF_LD | BPF_W | BPF_ABS, static_cast<uint32_t>(SKF_AD_OFF + SKF_AD_CPU)));
+    for (size_t i = 0; i < socket_cpus.size() && i < max_pairs; ++i) {
+        if (socket_cpus[i] < 0) {
+            continue;
+        }
+        program.push_back(BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, static_cast<uint32_t>(socket_cpus[i]), 0, 1));
+        program.push_back(BPF_STMT(BPF_RET | BPF_K, static_cast<uint32_t>(i)));
+    }
+    program.push_back(BPF_STMT(BPF_ALU | BPF_MOD | BPF_K, static_cast<uint32_t>(socket_cpus.size())));
+    program.push_back(BPF_STMT(BPF_RET | BPF_A, 0));
+
+    struct sock_fprog fprog;
+    fprog.len = static_cast<unsigned short>(program.size());
+    fprog.filter = program.data();
+    if (setsockopt(socket_fd, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &fprog, sizeof(fprog)) != 0) {
+        last_error_ = "SO_ATTACH_REUSEPORT_CBPF failed: " + std::string(strerror(errno));
+        return false;
+    }
+    return true;
+#else
+    (void)socket_fd;
+    (void)socket_cpus;
+    last_error_ = "Reuseport CPU steering is not supported on this platform";
+    return false;
+#endif
+}
+
+int Platform::get_incoming_cpu(int socket_fd) {
+#if defined(__linux__) && defined(SO_INCOMING_CPU)
+    int cpu = -1;
+    socklen_t len = sizeof(cpu);
+    if (getsockopt(socket_fd, SOL_SOCKET, SO_INCOMING_CPU, &cpu, &len) != 0) {
+        return -1;
+    }
+    return cpu;
+#else
+    (void)socket_fd;
+    return -1;
+#endif
+}
+
+bool Platform::set_thread_affinity(const std::vector<int>& cpus) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+        if (cpu < 0 || cpu >= CPU_SETSIZE) {
+            last_error_ = "CPU id out of range: " + std::to_string(cpu);
+            return false;
+        }
+        CPU_SET(cpu, &set);
+    }
+    if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+        last_error_ = "sched_setaffinity() failed: " + std::string(strerror(errno));
+        return false;
+    }
+    return true;
+#else
+    (void)cpus;
+    last_error_ = "Thread affinity is not supported on this platform";
+    return false;
+#endif
+}
+
+bool Platform::get_thread_affinity(std::vector<int>& cpus) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) != 0) {
+        last_error_ = "sched_getaffinity() failed: " + std::string(strerror(errno));
+        return false;
+    }
+    cpus.clear();
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (CPU_ISSET(cpu, &set)) {
+            cpus.push_back(cpu);
+        }
+    }
+    return true;
+#else
+    (void)cpus;
+    last_error_ = "Thread affinity is not supported on this platform";
+    return false;
+#endif
+}
+
+int Platform::get_current_cpu() {
+#ifdef __linux__
+    return sched_getcpu();
+#else
+    return -1;
+#endif
+}
+
 std::string Platform::get_last_error() {
     return last_error_;
 }
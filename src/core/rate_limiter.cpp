@@ -224,7 +224,7 @@ uint64_t RateLimiter::calculate_tokens(ClientState& state, uint64_t rate, uint64
 }
 
 std::chrono::system_clock::time_point RateLimiter::now() const {
-    return std::chrono::system_clock::now();
+    return TimeSource::current().coarse_now();
 }
 
 uint64_t RateLimiter::seconds_since(const std::chrono::system_clock::time_point& time) const {
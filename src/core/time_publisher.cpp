@@ -0,0 +1,123 @@
+/*
+ * src/core/time_publisher.cpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "simple_utcd/time_publisher.hpp"
+#include "simple_utcd/utc_packet.hpp"
+#include "simple_utcd/time_source.hpp"
+#include <chrono>
+#include <cstring>
+
+namespace simple_utcd {
+
+TimePublisher::TimePublisher()
+    : published_(0)
+    , refresh_count_(0)
+    , running_(false)
+    , discipline_(nullptr)
+{
+    // Readers see a valid time even before start()
+    refresh();
+}
+
+TimePublisher::~TimePublisher() {
+    stop();
+}
+
+bool TimePublisher::start() {
+    if (running_) {
+        return false;
+    }
+
+    refresh();
+    running_ = true;
+    tick_thread_ = std::thread(&TimePublisher::tick_loop, this);
+    return true;
+}
+
+void TimePublisher::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+    }
+    cv_.notify_all();
+
+    if (tick_thread_.joinable()) {
+        tick_thread_.join();
+    }
+}
+
+void TimePublisher::refresh() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    refresh_locked();
+}
+
+void TimePublisher::refresh_locked() {
+    // Clock read and store happen under mutex_, so publications land in
+    // the order the clock was read: a refresh preempted after its read
+    // cannot overwrite a later second. Served time then only goes back
+    // when the clock or its discipline does.
+    uint32_t seconds = static_cast<uint32_t>(corrected_now_ns() / 1000000000);
+
+    uint8_t wire[4];
+    UTCPacket::encode_timestamp(seconds, wire);
+    uint32_t encoded;
+    std::memcpy(&encoded, wire, sizeof(encoded));
+
+    published_.store((static_cast<uint64_t>(seconds) << 32) | encoded, std::memory_order_release);
+    refresh_count_++;
+}
+
+uint32_t TimePublisher::get_seconds() const {
+    return static_cast<uint32_t>(published_.load(std::memory_order_acquire) >> 32);
+}
+
+void TimePublisher::encode_rfc868(uint8_t* out) const {
+    uint32_t encoded = static_cast<uint32_t>(published_.load(std::memory_order_acquire));
+    std::memcpy(out, &encoded, sizeof(encoded));
+}
+
+int64_t TimePublisher::corrected_now_ns() const {
+    const TimeSource& source = TimeSource::current();
+    if (!discipline_) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(source.now().time_since_epoch()).count();
+    }
+    DisciplineState state = discipline_->read();
+    int64_t local_ns = state.raw_clock
+        ? source.raw_now_ns()
+        : std::chrono::duration_cast<std::chrono::nanoseconds>(source.now().time_since_epoch()).count();
+    return state.corrected_ns(local_ns);
+}
+
+void TimePublisher::tick_loop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (running_) {
+        // Sleep to the next corrected second; the wait itself runs on the
+        // steady clock, so a stepped system clock costs at most one tick
+        auto until_next = std::chrono::nanoseconds(1000000000 - corrected_now_ns() % 1000000000);
+        if (cv_.wait_for(lock, until_next, [this] { return !running_; })) {
+            break;
+        }
+
+        refresh_locked();
+    }
+}
+
+} // namespace simple_utcd
@@ -0,0 +1,86 @@
+/*
+ * src/core/time_source.cpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "simple_utcd/time_source.hpp"
+
+#ifdef __linux__
+#include <time.h>
+#endif
+
+namespace simple_utcd {
+
+namespace {
+
+#ifdef __linux__
+// The standard clocks are CLOCK_REALTIME and CLOCK_MONOTONIC on Linux,
+// so the coarse variants share their epochs
+template <typename Clock>
+typename Clock::time_point read_clock(clockid_t clock) {
+    struct timespec ts;
+    if (clock_gettime(clock, &ts) != 0) {
+        return Clock::now();
+    }
+    auto since_epoch = std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+    return typename Clock::time_point(std::chrono::duration_cast<typename Clock::duration>(since_epoch));
+}
+#endif
+
+} // namespace
+
+std::atomic<const TimeSource*> TimeSource::installed_{nullptr};
+
+const TimeSource& TimeSource::system() {
+    static const TimeSource source;
+    return source;
+}
+
+TimeSource::WallClock::time_point TimeSource::now() const {
+    return WallClock::now();
+}
+
+TimeSource::WallClock::time_point TimeSource::coarse_now() const {
+#ifdef __linux__
+    return read_clock<WallClock>(CLOCK_REALTIME_COARSE);
+#else
+    return WallClock::now();
+#endif
+}
+
+TimeSource::SteadyClock::time_point TimeSource::steady_now() const {
+    return SteadyClock::now();
+}
+
+TimeSource::SteadyClock::time_point TimeSource::coarse_steady_now() const {
+#ifdef __linux__
+    return read_clock<SteadyClock>(CLOCK_MONOTONIC_COARSE);
+#else
+    return SteadyClock::now();
+#endif
+}
+
+int64_t TimeSource::raw_now_ns() const {
+#ifdef __linux__
+    struct timespec ts;
+    if (clock_gettime(CLOCK_MONOTONIC_RAW, &ts) == 0) {
+        return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+    }
+#endif
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(SteadyClock::now().time_since_epoch()).count();
+}
+
+} // namespace simple_utcd
@@ -17,15 +17,11 @@
  */
 
 #include "simple_utcd/upstream_manager.hpp"
+#include "simple_utcd/upstream_sync.hpp"
+#include "simple_utcd/time_source.hpp"
 #include <algorithm>
+#include <cmath>
 #include <random>
-#include <sys/socket.h>
-#include <netinet/in.h>
-#include <arpa/inet.h>
-#include <unistd.h>
-#include <fcntl.h>
-#include <errno.h>
-#include <cstring>
 
 namespace simple_utcd {
 
@@ -35,6 +31,10 @@ UpstreamManager::UpstreamManager()
     , failover_threshold_(3)
     , recovery_threshold_(2)
     , timeout_ms_(1000)
+    , probe_concurrency_(64)
+    , hedge_delay_percentile_(95.0)
+    , hedge_max_outstanding_(0)
+    , snapshot_(std::make_shared<const Snapshot>())
     , current_round_robin_index_(0)
 {
 }
@@ -62,6 +62,18 @@ void UpstreamManager::set_timeout(uint64_t timeout_ms) {
     timeout_ms_ = timeout_ms;
 }
 
+void UpstreamManager::set_probe_concurrency(size_t max_probes) {
+    probe_concurrency_ = max_probes;
+}
+
+void UpstreamManager::set_hedge_delay_percentile(double percentile) {
+    hedge_delay_percentile_ = std::min(100.0, std::max(0.0, percentile));
+}
+
+void UpstreamManager::set_hedge_max_outstanding(size_t max_outstanding) {
+    hedge_max_outstanding_ = max_outstanding;
+}
+
 bool UpstreamManager::add_server(const std::string& address, int port, int priority) {
     std::lock_guard<std::mutex> lock(servers_mutex_);
     
@@ -74,12 +86,17 @@ bool UpstreamManager::add_server(const std::string& address, int port, int prior
     server.last_check = now();
     
     servers_[address] = server;
+    publish_snapshot();
     return true;
 }
 
 bool UpstreamManager::remove_server(const std::string& address) {
     std::lock_guard<std::mutex> lock(servers_mutex_);
-    return servers_.erase(address) > 0;
+    if (servers_.erase(address) == 0) {
+        return false;
+    }
+    publish_snapshot();
+    return true;
 }
 
 bool UpstreamManager::enable_server(const std::string& address) {
@@ -87,6 +104,7 @@ bool UpstreamManager::enable_server(const std::string& address) {
     auto it = servers_.find(address);
     if (it != servers_.end()) {
         it->second.enabled = true;
+        publish_snapshot();
         return true;
     }
     return false;
@@ -97,6 +115,7 @@ bool UpstreamManager::disable_server(const std::string& address) {
     auto it = servers_.find(address);
     if (it != servers_.end()) {
         it->second.enabled = false;
+        publish_snapshot();
         return true;
     }
     return false;
@@ -105,158 +124,203 @@ bool UpstreamManager::disable_server(const std::string& address) {
 void UpstreamManager::clear_servers() {
     std::lock_guard<std::mutex> lock(servers_mutex_);
     servers_.clear();
+    publish_snapshot();
 }
 
 std::vector<UpstreamServer> UpstreamManager::get_servers() const {
-    std::lock_guard<std::mutex> lock(servers_mutex_);
-    std::vector<UpstreamServer> result;
-    for (const auto& pair : servers_) {
-        result.push_back(pair.second);
+    return *load_snapshot();
+}
+
+UpstreamHandle UpstreamManager::select_server() const {
+    SnapshotPtr snapshot = load_snapshot();
+    return make_handle(snapshot, select_from(*snapshot));
+}
+
+std::vector<UpstreamServer> UpstreamManager::rank_servers() const {
+    // Sorted on the key select_server() takes the first of, so the two
+    // agree; ranking is only a query and never advances the round robin
+    SnapshotPtr snapshot = load_snapshot();
+    SelectionStrategy strategy = strategy_.load();
+    std::vector<UpstreamServer> ranked;
+    std::vector<UpstreamServer> down;
+    ranked.reserve(snapshot->size());
+    for (const auto& server : *snapshot) {
+        if (is_available(server)) {
+            ranked.push_back(server);
+        } else if (server.enabled) {
+            down.push_back(server);
+        }
     }
-    return result;
-}
-
-UpstreamServer* UpstreamManager::select_server() {
-    std::lock_guard<std::mutex> lock(servers_mutex_);
     
-    if (servers_.empty()) {
-        return nullptr;
+    if (strategy == SelectionStrategy::ROUND_ROBIN) {
+        if (!ranked.empty()) {
+            size_t next = current_round_robin_index_.load() % ranked.size();
+            std::rotate(ranked.begin(), ranked.begin() + static_cast<std::ptrdiff_t>(next), ranked.end());
+        }
+    } else {
+        std::stable_sort(ranked.begin(), ranked.end(),
+                         [strategy](const UpstreamServer& a, const UpstreamServer& b) {
+                             return ranks_before(strategy, a, b);
+                         });
     }
     
-    switch (strategy_) {
-        case SelectionStrategy::ROUND_ROBIN:
-            return select_round_robin();
-        case SelectionStrategy::LEAST_LATENCY:
-            return select_least_latency();
-        case SelectionStrategy::HEALTH_BASED:
-            return select_health_based();
-        case SelectionStrategy::PRIORITY:
-            return select_priority();
-        default:
-            return select_health_based();
-    }
+    ranked.insert(ranked.end(), down.begin(), down.end());
+    return ranked;
 }
 
-UpstreamServer* UpstreamManager::get_primary_server() {
-    std::lock_guard<std::mutex> lock(servers_mutex_);
-    
-    UpstreamServer* best = nullptr;
-    for (auto& pair : servers_) {
-        if (!pair.second.enabled) continue;
-        if (pair.second.status == ServerStatus::FAILED) continue;
+UpstreamHandle UpstreamManager::get_primary_server() const {
+    SnapshotPtr snapshot = load_snapshot();
+    return make_handle(snapshot, find_primary_server(*snapshot));
+}
+
+const UpstreamServer* UpstreamManager::find_primary_server(const Snapshot& servers) const {
+    const UpstreamServer* best = nullptr;
+    for (const auto& server : servers) {
+        if (!server.enabled) continue;
+        if (server.status == ServerStatus::FAILED) continue;
         
-        if (!best || pair.second.priority > best->priority) {
-            best = &pair.second;
-        } else if (pair.second.priority == best->priority &&
-                   pair.second.status == ServerStatus::HEALTHY &&
+        if (!best || server.priority > best->priority) {
+            best = &server;
+        } else if (server.priority == best->priority &&
+                   server.status == ServerStatus::HEALTHY &&
                    best->status != ServerStatus::HEALTHY) {
-            best = &pair.second;
+            best = &server;
         }
     }
     
     return best;
 }
 
-UpstreamServer* UpstreamManager::get_backup_server() {
-    std::lock_guard<std::mutex> lock(servers_mutex_);
+UpstreamHandle UpstreamManager::get_backup_server() const {
+    SnapshotPtr snapshot = load_snapshot();
     
-    UpstreamServer* primary = get_primary_server();
+    const UpstreamServer* primary = find_primary_server(*snapshot);
     if (!primary) return nullptr;
     
-    UpstreamServer* backup = nullptr;
-    for (auto& pair : servers_) {
-        if (!pair.second.enabled) continue;
-        if (&pair.second == primary) continue;
-        if (pair.second.status == ServerStatus::FAILED) continue;
+    const UpstreamServer* backup = nullptr;
+    for (const auto& server : *snapshot) {
+        if (!server.enabled) continue;
+        if (&server == primary) continue;
+        if (server.status == ServerStatus::FAILED) continue;
         
-        if (!backup || pair.second.priority > backup->priority) {
-            backup = &pair.second;
+        if (!backup || server.priority > backup->priority) {
+            backup = &server;
         }
     }
     
-    return backup;
+    return make_handle(snapshot, backup);
 }
 
 bool UpstreamManager::check_server_health(const std::string& address) {
+    UpstreamServer server;
+    {
+        std::lock_guard<std::mutex> lock(servers_mutex_);
+        auto it = servers_.find(address);
+        if (it == servers_.end()) {
+            return false;
+        }
+        it->second.last_check = now();
+        server = it->second;
+    }
+
+    uint64_t response_time = probe_servers({server})[0];
+
     std::lock_guard<std::mutex> lock(servers_mutex_);
     auto it = servers_.find(address);
     if (it == servers_.end()) {
         return false;
     }
-    
-    return perform_health_check(it->second);
+    bool healthy = apply_probe_result(it->second, response_time);
+    publish_snapshot();
+    return healthy;
 }
 
 void UpstreamManager::check_all_servers_health() {
-    std::lock_guard<std::mutex> lock(servers_mutex_);
-    
-    for (auto& pair : servers_) {
-        if (pair.second.enabled) {
-            uint64_t elapsed = seconds_since(pair.second.last_check);
-            if (elapsed >= health_check_interval_seconds_) {
-                perform_health_check(pair.second);
+    // Claim the due servers; stamping last_check keeps an overlapping
+    // sweep from probing them again. Readers see the stamps with the
+    // results, in the sweep's one publish.
+    std::vector<UpstreamServer> due;
+    {
+        std::lock_guard<std::mutex> lock(servers_mutex_);
+        for (auto& pair : servers_) {
+            if (pair.second.enabled &&
+                seconds_since(pair.second.last_check) >= health_check_interval_seconds_) {
+                pair.second.last_check = now();
+                due.push_back(pair.second);
             }
         }
     }
-}
+    if (due.empty()) {
+        return;
+    }
 
-void UpstreamManager::record_success(const std::string& address, uint64_t response_time_ms) {
+    std::vector<uint64_t> response_times = probe_servers(due);
+
+    // Servers removed or replaced during the sweep are skipped
     std::lock_guard<std::mutex> lock(servers_mutex_);
-    auto it = servers_.find(address);
-    if (it != servers_.end()) {
-        auto& server = it->second;
-        server.success_count++;
-        server.last_success = now();
-        server.response_time_ms = response_time_ms;
-        update_server_health(server);
+    for (size_t i = 0; i < due.size(); ++i) {
+        auto it = servers_.find(due[i].address);
+        if (it != servers_.end() && it->second.port == due[i].port) {
+            apply_probe_result(it->second, response_times[i]);
+        }
     }
+    publish_snapshot();
+}
+
+void UpstreamManager::record_success(const std::string& address, uint64_t response_time_ms) {
+    record_success(address, std::chrono::milliseconds(response_time_ms));
+}
+
+void UpstreamManager::record_success(const std::string& address, std::chrono::microseconds response_time) {
+    record_results({{address, true, response_time}});
 }
 
 void UpstreamManager::record_failure(const std::string& address) {
+    record_results({{address, false, std::chrono::microseconds(0)}});
+}
+
+void UpstreamManager::record_results(const std::vector<UpstreamResult>& results) {
     std::lock_guard<std::mutex> lock(servers_mutex_);
-    auto it = servers_.find(address);
-    if (it != servers_.end()) {
-        auto& server = it->second;
-        server.failure_count++;
-        server.last_failure = now();
-        update_server_health(server);
+    bool changed = false;
+    for (const auto& result : results) {
+        auto it = servers_.find(result.address);
+        if (it == servers_.end()) {
+            continue;
+        }
+        if (result.success) {
+            apply_success(it->second, static_cast<uint64_t>(std::max<int64_t>(0, result.response_time.count())));
+        } else {
+            apply_failure(it->second);
+        }
+        changed = true;
+    }
+    if (changed) {
+        publish_snapshot();
     }
 }
 
 ServerStatus UpstreamManager::get_server_status(const std::string& address) const {
-    std::lock_guard<std::mutex> lock(servers_mutex_);
-    auto it = servers_.find(address);
-    if (it != servers_.end()) {
-        return it->second.status;
-    }
-    return ServerStatus::UNKNOWN;
+    SnapshotPtr snapshot = load_snapshot();
+    const UpstreamServer* server = find_server(*snapshot, address);
+    return server ? server->status : ServerStatus::UNKNOWN;
 }
 
 uint64_t UpstreamManager::get_server_response_time(const std::string& address) const {
-    std::lock_guard<std::mutex> lock(servers_mutex_);
-    auto it = servers_.find(address);
-    if (it != servers_.end()) {
-        return it->second.response_time_ms;
-    }
-    return 0;
+    SnapshotPtr snapshot = load_snapshot();
+    const UpstreamServer* server = find_server(*snapshot, address);
+    return server ? server->response_time_ms : 0;
 }
 
 bool UpstreamManager::is_server_available(const std::string& address) const {
-    std::lock_guard<std::mutex> lock(servers_mutex_);
-    auto it = servers_.find(address);
-    if (it != servers_.end()) {
-        const auto& server = it->second;
-        return server.enabled && 
-               server.status != ServerStatus::FAILED &&
-               server.status != ServerStatus::UNHEALTHY;
-    }
-    return false;
+    SnapshotPtr snapshot = load_snapshot();
+    const UpstreamServer* server = find_server(*snapshot, address);
+    return server && is_available(*server);
 }
 
 bool UpstreamManager::has_available_servers() const {
-    std::lock_guard<std::mutex> lock(servers_mutex_);
-    for (const auto& pair : servers_) {
-        if (is_server_available(pair.first)) {
+    SnapshotPtr snapshot = load_snapshot();
+    for (const auto& server : *snapshot) {
+        if (is_available(server)) {
             return true;
         }
     }
@@ -264,10 +328,10 @@ bool UpstreamManager::has_available_servers() const {
 }
 
 size_t UpstreamManager::get_healthy_server_count() const {
-    std::lock_guard<std::mutex> lock(servers_mutex_);
+    SnapshotPtr snapshot = load_snapshot();
     size_t count = 0;
-    for (const auto& pair : servers_) {
-        if (pair.second.status == ServerStatus::HEALTHY && pair.second.enabled) {
+    for (const auto& server : *snapshot) {
+        if (server.status == ServerStatus::HEALTHY && server.enabled) {
             count++;
         }
     }
@@ -275,8 +339,7 @@ size_t UpstreamManager::get_healthy_server_count() const {
 }
 
 size_t UpstreamManager::get_total_server_count() const {
-    std::lock_guard<std::mutex> lock(servers_mutex_);
-    return servers_.size();
+    return load_snapshot()->size();
 }
 
 void UpstreamManager::update_server_status() {
@@ -285,71 +348,122 @@ void UpstreamManager::update_server_status() {
     for (auto& pair : servers_) {
         update_server_health(pair.second);
     }
+    publish_snapshot();
 }
 
-bool UpstreamManager::perform_health_check(UpstreamServer& server) {
-    server.last_check = now();
-    
-    // Simple connectivity check
-    uint64_t response_time = measure_response_time(server.address, server.port);
-    
-    if (response_time > 0 && response_time < timeout_ms_) {
-        server.response_time_ms = response_time;
-        server.success_count++;
-        server.last_success = now();
-        update_server_health(server);
+void UpstreamManager::set_falsetickers(const std::vector<std::string>& addresses) {
+    std::lock_guard<std::mutex> lock(servers_mutex_);
+    for (auto& pair : servers_) {
+        pair.second.falseticker =
+            std::find(addresses.begin(), addresses.end(), pair.first) != addresses.end();
+    }
+    publish_snapshot();
+}
+
+bool UpstreamManager::parse_selection_strategy(const std::string& name, SelectionStrategy& strategy) {
+    static const std::pair<const char*, SelectionStrategy> names[] = {
+        {"round_robin", SelectionStrategy::ROUND_ROBIN},
+        {"least_latency", SelectionStrategy::LEAST_LATENCY},
+        {"health_based", SelectionStrategy::HEALTH_BASED},
+        {"priority", SelectionStrategy::PRIORITY},
+        {"intersection", SelectionStrategy::INTERSECTION},
+    };
+    for (const auto& entry : names) {
+        if (name == entry.first) {
+            strategy = entry.second;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<uint64_t> UpstreamManager::probe_servers(const std::vector<UpstreamServer>& servers) const {
+    // One NTP exchange each; the round trip is what the upstream costs a sync
+    auto samples = UpstreamSync::query(servers, std::chrono::milliseconds(timeout_ms_),
+                                       probe_concurrency_);
+    std::vector<uint64_t> response_times;
+    response_times.reserve(samples.size());
+    for (const auto& sample : samples) {
+        uint64_t delay_us = sample.valid ? static_cast<uint64_t>((sample.delay_ns + 999) / 1000) : 0;
+        response_times.push_back(sample.valid && delay_us == 0 ? 1 : delay_us);
+    }
+    return response_times;
+}
+
+bool UpstreamManager::apply_probe_result(UpstreamServer& server, uint64_t response_time_us) {
+    if (response_time_us > 0 && response_time_us < timeout_ms_ * 1000) {
+        apply_success(server, response_time_us);
         return true;
-    } else {
-        server.failure_count++;
-        server.last_failure = now();
-        update_server_health(server);
-        return false;
     }
+    apply_failure(server);
+    return false;
 }
 
-uint64_t UpstreamManager::measure_response_time(const std::string& address, int port) {
-    // Simple TCP connect test
-    int sock = socket(AF_INET, SOCK_STREAM, 0);
-    if (sock < 0) {
-        return 0;
+void UpstreamManager::apply_success(UpstreamServer& server, uint64_t response_time_us) {
+    server.success_count++;
+    server.last_success = now();
+    // Milliseconds, rounded up: zero means no data
+    server.response_time_ms = std::max<uint64_t>(1, (response_time_us + 999) / 1000);
+    server.latency.record(response_time_us);
+    update_server_health(server);
+}
+
+void UpstreamManager::apply_failure(UpstreamServer& server) {
+    server.failure_count++;
+    server.last_failure = now();
+    update_server_health(server);
+}
+
+UpstreamManager::SnapshotPtr UpstreamManager::load_snapshot() const {
+    return std::atomic_load(&snapshot_);
+}
+
+void UpstreamManager::publish_snapshot() {
+    // Copy-on-write: readers holding the old table keep it alive until done
+    auto snapshot = std::make_shared<Snapshot>();
+    snapshot->reserve(servers_.size());
+    for (const auto& pair : servers_) {
+        snapshot->push_back(pair.second);
     }
-    
-    // Set non-blocking
-    int flags = fcntl(sock, F_GETFL, 0);
-    fcntl(sock, F_SETFL, flags | O_NONBLOCK);
-    
-    struct sockaddr_in server_addr;
-    memset(&server_addr, 0, sizeof(server_addr));
-    server_addr.sin_family = AF_INET;
-    server_addr.sin_port = htons(port);
-    
-    if (inet_pton(AF_INET, address.c_str(), &server_addr.sin_addr) <= 0) {
-        close(sock);
-        return 0;
+    std::atomic_store(&snapshot_, SnapshotPtr(std::move(snapshot)));
+}
+
+const UpstreamServer* UpstreamManager::find_server(const Snapshot& servers, const std::string& address) {
+    auto it = std::lower_bound(servers.begin(), servers.end(), address,
+                               [](const UpstreamServer& server, const std::string& key) {
+                                   return server.address < key;
+                               });
+    return it != servers.end() && it->address == address ? &*it : nullptr;
+}
+
+UpstreamHandle UpstreamManager::make_handle(const SnapshotPtr& snapshot, const UpstreamServer* server) {
+    // Aliasing constructor: the handle owns the whole snapshot
+    return server ? UpstreamHandle(snapshot, server) : nullptr;
+}
+
+const UpstreamServer* UpstreamManager::select_from(const Snapshot& servers) const {
+    SelectionStrategy strategy = strategy_.load();
+    if (strategy == SelectionStrategy::ROUND_ROBIN) {
+        return select_round_robin(servers);
     }
     
-    auto start = std::chrono::steady_clock::now();
-    int result = connect(sock, (struct sockaddr*)&server_addr, sizeof(server_addr));
-    
-    if (result == 0 || errno == EINPROGRESS) {
-        // Connection successful or in progress
-        auto end = std::chrono::steady_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
-        close(sock);
-        return duration.count();
+    // The first available server nothing ranks before; ties keep address order
+    const UpstreamServer* best = nullptr;
+    for (const auto& server : servers) {
+        if (is_available(server) && (!best || ranks_before(strategy, server, *best))) {
+            best = &server;
+        }
     }
-    
-    close(sock);
-    return 0;
+    return best;
 }
 
-UpstreamServer* UpstreamManager::select_round_robin() {
-    if (servers_.empty()) return nullptr;
+const UpstreamServer* UpstreamManager::select_round_robin(const Snapshot& servers) const {
+    if (servers.empty()) return nullptr;
     
-    std::vector<UpstreamServer*> available;
-    for (auto& pair : servers_) {
-        if (is_server_available(pair.first)) {
-            available.push_back(&pair.second);
+    std::vector<const UpstreamServer*> available;
+    for (const auto& server : servers) {
+        if (is_available(server)) {
+            available.push_back(&server);
         }
     }
     
@@ -359,94 +473,86 @@ UpstreamServer* UpstreamManager::select_round_robin() {
     return available[index];
 }
 
-UpstreamServer* UpstreamManager::select_least_latency() {
-    UpstreamServer* best = nullptr;
-    uint64_t best_latency = UINT64_MAX;
-    
-    for (auto& pair : servers_) {
-        if (!is_server_available(pair.first)) continue;
-        
-        if (pair.second.response_time_ms > 0 && 
-            pair.second.response_time_ms < best_latency) {
-            best_latency = pair.second.response_time_ms;
-            best = &pair.second;
-        }
+bool UpstreamManager::ranks_before(SelectionStrategy strategy, const UpstreamServer& a, const UpstreamServer& b) {
+    switch (strategy) {
+        case SelectionStrategy::LEAST_LATENCY:
+            // Lowest median first; servers without samples follow by health
+            if (a.latency.empty() != b.latency.empty()) {
+                return !a.latency.empty();
+            }
+            return a.latency.empty() ? healthier(a, b) : faster(a, b, 0.5, 0.95);
+        case SelectionStrategy::PRIORITY:
+            // Same priority, prefer healthier server
+            if (a.priority != b.priority) {
+                return a.priority > b.priority;
+            }
+            return a.status == ServerStatus::HEALTHY && b.status != ServerStatus::HEALTHY;
+        case SelectionStrategy::INTERSECTION:
+            // Truechimers first; until a round has intersected, or if every
+            // truechimer is down, this is plain health-based
+            if (a.falseticker != b.falseticker) {
+                return !a.falseticker;
+            }
+            return healthier(a, b);
+        case SelectionStrategy::HEALTH_BASED:
+        default:
+            return healthier(a, b);
     }
-    
-    return best ? best : select_health_based();
 }
 
-UpstreamServer* UpstreamManager::select_health_based() {
-    UpstreamServer* best = nullptr;
-    
-    for (auto& pair : servers_) {
-        if (!is_server_available(pair.first)) continue;
-        
-        if (!best) {
-            best = &pair.second;
-            continue;
-        }
-        
-        // Prefer HEALTHY over DEGRADED over others
-        if (pair.second.status == ServerStatus::HEALTHY &&
-            best->status != ServerStatus::HEALTHY) {
-            best = &pair.second;
-        } else if (pair.second.status == best->status) {
-            // If same status, prefer lower response time
-            if (pair.second.response_time_ms > 0 &&
-                (best->response_time_ms == 0 || 
-                 pair.second.response_time_ms < best->response_time_ms)) {
-                best = &pair.second;
-            }
-        }
+bool UpstreamManager::healthier(const UpstreamServer& a, const UpstreamServer& b) {
+    // Prefer HEALTHY over DEGRADED over others
+    auto grade = [](ServerStatus status) {
+        return status == ServerStatus::HEALTHY ? 0 : status == ServerStatus::DEGRADED ? 1 : 2;
+    };
+    if (grade(a.status) != grade(b.status)) {
+        return grade(a.status) < grade(b.status);
     }
-    
-    return best;
+    // If same status, prefer the lower tail; no data ranks last
+    if (a.latency.empty() != b.latency.empty()) {
+        return !a.latency.empty();
+    }
+    return !a.latency.empty() && faster(a, b, 0.95, 0.5);
 }
 
-UpstreamServer* UpstreamManager::select_priority() {
-    UpstreamServer* best = nullptr;
-    
-    for (auto& pair : servers_) {
-        if (!is_server_available(pair.first)) continue;
-        
-        if (!best) {
-            best = &pair.second;
-            continue;
-        }
-        
-        if (pair.second.priority > best->priority) {
-            best = &pair.second;
-        } else if (pair.second.priority == best->priority) {
-            // Same priority, prefer healthier server
-            if (pair.second.status == ServerStatus::HEALTHY &&
-                best->status != ServerStatus::HEALTHY) {
-                best = &pair.second;
-            }
-        }
+bool UpstreamManager::faster(const UpstreamServer& a, const UpstreamServer& b, double first, double second) {
+    uint64_t a_first = a.latency.quantile_us(first);
+    uint64_t b_first = b.latency.quantile_us(first);
+    if (a_first != b_first) {
+        return a_first < b_first;
     }
-    
-    return best;
+    uint64_t a_second = a.latency.quantile_us(second);
+    uint64_t b_second = b.latency.quantile_us(second);
+    if (a_second != b_second) {
+        return a_second < b_second;
+    }
+    return a.latency.ewma_us < b.latency.ewma_us;
 }
 
 void UpstreamManager::update_server_health(UpstreamServer& server) {
+    // Grade on the smoothed round trip so one slow sample does not demote
+    uint64_t latency_ms = server.response_time_ms;
+    if (!server.latency.empty()) {
+        latency_ms = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(server.latency.ewma_us / 1000.0)));
+    }
+    
     if (should_failover(server)) {
         server.status = ServerStatus::FAILED;
     } else if (should_recover(server)) {
-        if (server.response_time_ms < 100) {
+        if (latency_ms < 100) {
             server.status = ServerStatus::HEALTHY;
-        } else if (server.response_time_ms < 500) {
+        } else if (latency_ms < 500) {
             server.status = ServerStatus::DEGRADED;
         } else {
             server.status = ServerStatus::UNHEALTHY;
         }
     } else {
         // Update based on current metrics
-        if (server.response_time_ms == 0) {
+        if (latency_ms == 0) {
             server.status = ServerStatus::UNKNOWN;
-        } else if (server.response_time_ms < 100) {
+        } else if (latency_ms < 100) {
             server.status = ServerStatus::HEALTHY;
-        } else if (server.response_time_ms < 500) {
+        } else if (latency_ms < 500) {
             server.status = ServerStatus::DEGRADED;
         } else {
             server.status = ServerStatus::UNHEALTHY;
@@ -454,6 +560,12 @@ void UpstreamManager::update_server_health(UpstreamServer& server) {
     }
 }
 
+bool UpstreamManager::is_available(const UpstreamServer& server) const {
+    return server.enabled &&
+           server.status != ServerStatus::FAILED &&
+           server.status != ServerStatus::UNHEALTHY;
+}
+
 bool UpstreamManager::should_failover(const UpstreamServer& server) const {
     return server.failure_count >= failover_threshold_ &&
            server.success_count == 0;
@@ -473,7 +585,7 @@ bool UpstreamManager::should_recover(const UpstreamServer& server) const {
 }
 
 std::chrono::system_clock::time_point UpstreamManager::now() const {
-    return std::chrono::system_clock::now();
+    return TimeSource::current().coarse_now();
 }
 
 uint64_t UpstreamManager::seconds_since(const std::chrono::system_clock::time_point& time) const {
@@ -0,0 +1,625 @@
+/*
+ * src/core/upstream_sync.cpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "simple_utcd/upstream_sync.hpp"
+#include "simple_utcd/clock_select.hpp"
+#include "simple_utcd/ntp_responder.hpp"
+#include "simple_utcd/platform.hpp"
+#include "simple_utcd/time_source.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+namespace simple_utcd {
+
+namespace {
+
+// Header byte 0: leap indicator (2 bits), version (3 bits), mode (3 bits)
+constexpr uint8_t kModeClient = 3;
+constexpr uint8_t kModeServer = 4;
+constexpr uint8_t kVersion = 4;
+constexpr uint8_t kLeapUnsynchronized = 3;
+
+// RFC 5905 MINDISP: the least delay a correctness interval assumes
+constexpr int64_t kMinDispersionNs = 10000000;
+
+constexpr size_t kRootDelayOffset = 4;
+constexpr size_t kRootDispersionOffset = 8;
+constexpr size_t kReferenceIdOffset = 12;
+constexpr size_t kOriginTimeOffset = 24;
+constexpr size_t kReceiveTimeOffset = 32;
+constexpr size_t kTransmitTimeOffset = 40;
+
+struct Exchange {
+    int fd = -1;
+    uint64_t transmit = 0;  // Sent as our transmit time, echoed back as the origin
+    uint32_t reference_id = 0;  // The address connected to, as NTP encodes it
+    bool pending = false;
+    std::chrono::steady_clock::time_point sent;
+    std::chrono::steady_clock::time_point deadline;
+};
+
+enum class ReplyCheck {
+    ACCEPT,
+    IGNORE,     // Not an answer to our request; keep waiting
+    REJECT
+};
+
+int64_t local_now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        TimeSource::current().now().time_since_epoch()).count();
+}
+
+// NTP short format: 16.16 fixed-point seconds
+int64_t read_short_ns(const uint8_t* in) {
+    uint64_t value = (uint64_t(in[0]) << 24) | (uint64_t(in[1]) << 16) | (uint64_t(in[2]) << 8) | uint64_t(in[3]);
+    return static_cast<int64_t>((value * 1000000000ull) >> 16);
+}
+
+uint64_t read_u64(const uint8_t* in) {
+    uint64_t value = 0;
+    for (int i = 0; i < 8; ++i) {
+        value = (value << 8) | in[i];
+    }
+    return value;
+}
+
+void write_u64(uint8_t* out, uint64_t value) {
+    for (int i = 7; i >= 0; --i) {
+        out[i] = static_cast<uint8_t>(value);
+        value >>= 8;
+    }
+}
+
+using AddressList = std::unique_ptr<struct addrinfo, void (*)(struct addrinfo*)>;
+
+// getaddrinfo() blocks, so every upstream is resolved before the first send
+AddressList resolve_upstream(const UpstreamServer& server, std::string& error) {
+    struct addrinfo hints;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    hints.ai_flags = AI_NUMERICSERV;
+
+    struct addrinfo* addresses = nullptr;
+    std::string service = std::to_string(server.port);
+    int result = getaddrinfo(server.address.c_str(), service.c_str(), &hints, &addresses);
+    if (result != 0 || !addresses) {
+        error = std::string("Cannot resolve upstream: ") + gai_strerror(result);
+        return AddressList(nullptr, freeaddrinfo);
+    }
+    return AddressList(addresses, freeaddrinfo);
+}
+
+// Kernel arrival stamps are on the real wall clock, so they stand in for
+// T4 only while nothing else is installed as the time source
+bool use_kernel_stamps() {
+    return &TimeSource::current() == &TimeSource::system();
+}
+
+// A connected socket only hears from its upstream and reports ICMP errors
+bool open_exchange(const struct addrinfo* addresses, Exchange& exchange, std::string& error) {
+    int fd = -1;
+    const struct addrinfo* address = addresses;
+    for (; address; address = address->ai_next) {
+        fd = Platform::create_socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+        if (fd < 0) {
+            continue;
+        }
+        if (Platform::set_non_blocking(fd) && connect(fd, address->ai_addr, address->ai_addrlen) == 0) {
+            break;
+        }
+        Platform::close_socket(fd);
+        fd = -1;
+    }
+
+    if (fd < 0) {
+        error = std::string("Cannot open socket to upstream: ") + strerror(errno);
+        return false;
+    }
+#ifdef SO_TIMESTAMPNS
+    if (use_kernel_stamps()) {
+        int enable = 1;
+        setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPNS, &enable, sizeof(enable));  // Best effort
+    }
+#endif
+    char numeric[INET6_ADDRSTRLEN] = {};
+    const void* host = address->ai_family == AF_INET6
+        ? static_cast<const void*>(&reinterpret_cast<const struct sockaddr_in6*>(address->ai_addr)->sin6_addr)
+        : static_cast<const void*>(&reinterpret_cast<const struct sockaddr_in*>(address->ai_addr)->sin_addr);
+    if (inet_ntop(address->ai_family, host, numeric, sizeof(numeric))) {
+        exchange.reference_id = NtpResponder::encode_reference_id(numeric);
+    }
+    exchange.fd = fd;
+    return true;
+}
+
+// recv() plus the kernel's arrival stamp, 0 when there is none
+ssize_t receive_reply(int fd, uint8_t* buffer, size_t size, int64_t& kernel_ns) {
+    kernel_ns = 0;
+#ifdef SO_TIMESTAMPNS
+    struct iovec iov;
+    iov.iov_base = buffer;
+    iov.iov_len = size;
+    union {
+        char buf[CMSG_SPACE(sizeof(struct timespec))];
+        struct cmsghdr align;
+    } control;
+    struct msghdr message;
+    std::memset(&message, 0, sizeof(message));
+    message.msg_iov = &iov;
+    message.msg_iovlen = 1;
+    message.msg_control = control.buf;
+    message.msg_controllen = sizeof(control.buf);
+
+    ssize_t received = recvmsg(fd, &message, 0);
+    if (received < 0) {
+        return received;
+    }
+    for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&message); cmsg; cmsg = CMSG_NXTHDR(&message, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+            struct timespec ts;
+            std::memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+            kernel_ns = static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+        }
+    }
+    return received;
+#else
+    return recv(fd, buffer, size, 0);
+#endif
+}
+
+bool send_request(Exchange& exchange, std::string& error) {
+    uint8_t request[NtpResponder::kPacketSize];
+    std::memset(request, 0, sizeof(request));
+    request[0] = static_cast<uint8_t>((kVersion << 3) | kModeClient);
+
+    exchange.transmit = NtpResponder::from_unix_nanoseconds(local_now_ns());
+    write_u64(request + kTransmitTimeOffset, exchange.transmit);
+    if (send(exchange.fd, request, sizeof(request), 0) != static_cast<ssize_t>(sizeof(request))) {
+        error = std::string("Send failed: ") + strerror(errno);
+        return false;
+    }
+    return true;
+}
+
+ReplyCheck check_reply(const uint8_t* reply, size_t size, const Exchange& exchange,
+                       int64_t received_ns, UpstreamSample& sample) {
+    if (size < NtpResponder::kPacketSize || (reply[0] & 0x07) != kModeServer) {
+        sample.error = "Not an NTP server reply";
+        return ReplyCheck::REJECT;
+    }
+    if (read_u64(reply + kOriginTimeOffset) != exchange.transmit) {
+        return ReplyCheck::IGNORE;
+    }
+
+    uint8_t leap = static_cast<uint8_t>(reply[0] >> 6);
+    uint8_t stratum = reply[1];
+    if (stratum == 0) {
+        sample.error = "Kiss-o'-death " + std::string(reinterpret_cast<const char*>(reply + kReferenceIdOffset), 4);
+        return ReplyCheck::REJECT;
+    }
+    if (leap == kLeapUnsynchronized || stratum > 15) {
+        sample.error = "Upstream is unsynchronized";
+        return ReplyCheck::REJECT;
+    }
+
+    uint64_t t1 = exchange.transmit;
+    uint64_t t2 = read_u64(reply + kReceiveTimeOffset);
+    uint64_t t3 = read_u64(reply + kTransmitTimeOffset);
+    uint64_t t4 = NtpResponder::from_unix_nanoseconds(received_ns);
+    if (t2 == 0 || t3 == 0) {
+        sample.error = "Reply is missing timestamps";
+        return ReplyCheck::REJECT;
+    }
+
+    int64_t delay = UpstreamSync::ntp_difference_ns(t4, t1) - UpstreamSync::ntp_difference_ns(t3, t2);
+    if (delay < 0) {
+        sample.error = "Negative round-trip delay";
+        return ReplyCheck::REJECT;
+    }
+
+    sample.offset_ns = (UpstreamSync::ntp_difference_ns(t2, t1) + UpstreamSync::ntp_difference_ns(t3, t4)) / 2;
+    sample.delay_ns = delay;
+    sample.local_time_ns = received_ns;
+    sample.reference_id = exchange.reference_id;
+    sample.root_delay_ns = read_short_ns(reply + kRootDelayOffset);
+    sample.root_dispersion_ns = read_short_ns(reply + kRootDispersionOffset);
+    sample.leap = leap;
+    sample.stratum = stratum;
+    sample.valid = true;
+    return ReplyCheck::ACCEPT;
+}
+
+// Exchanges with servers in order, at most max_outstanding at a time.
+// Plain rounds send the next request as soon as a slot frees and wait for
+// every answer. Hedged rounds (hedge_delay set) send one, add the next
+// after each hedge_delay without an answer or straight after a failure,
+// stop at the first valid answer, and return only the servers reached.
+std::vector<UpstreamSample> run_exchanges(const std::vector<UpstreamServer>& servers,
+                                          std::chrono::milliseconds timeout,
+                                          size_t max_outstanding,
+                                          const std::chrono::nanoseconds* hedge_delay) {
+    using Clock = std::chrono::steady_clock;
+    std::vector<UpstreamSample> samples(servers.size());
+    std::vector<Exchange> exchanges(servers.size());
+    size_t next = 0;
+    size_t in_flight = 0;
+    bool answered = false;
+    Clock::time_point next_hedge = Clock::time_point::min();
+
+    // Every lookup happens here, before anything is in flight: a slow name
+    // server then delays the round's start, never the read of an answer
+    std::vector<AddressList> addresses;
+    addresses.reserve(servers.size());
+    for (size_t i = 0; i < servers.size(); ++i) {
+        samples[i].address = servers[i].address;
+        samples[i].port = servers[i].port;
+        addresses.push_back(resolve_upstream(servers[i], samples[i].error));
+    }
+
+    auto finish = [&](size_t i, bool failed) {
+        Platform::close_socket(exchanges[i].fd);
+        exchanges[i].fd = -1;
+        exchanges[i].pending = false;
+        --in_flight;
+        if (failed) {
+            next_hedge = Clock::time_point::min();  // Replace it without waiting
+        }
+    };
+
+    auto can_launch = [&]() {
+        return !answered && next < servers.size() &&
+               (max_outstanding == 0 || in_flight < max_outstanding);
+    };
+
+    // Keep the window full: a request goes out as soon as a slot frees,
+    // and each one gets the full timeout from its own send
+    auto launch = [&]() {
+        while (can_launch()) {
+            if (hedge_delay && in_flight > 0 && Clock::now() < next_hedge) {
+                break;
+            }
+            size_t i = next++;
+            if (!addresses[i] || !open_exchange(addresses[i].get(), exchanges[i], samples[i].error)) {
+                continue;
+            }
+            if (!send_request(exchanges[i], samples[i].error)) {
+                Platform::close_socket(exchanges[i].fd);
+                exchanges[i].fd = -1;
+                continue;
+            }
+            exchanges[i].pending = true;
+            exchanges[i].sent = Clock::now();
+            exchanges[i].deadline = exchanges[i].sent + timeout;
+            ++in_flight;
+            if (hedge_delay) {
+                next_hedge = exchanges[i].sent + *hedge_delay;
+            }
+        }
+    };
+
+    std::vector<struct pollfd> polled;
+    std::vector<size_t> polled_index;
+    launch();
+    while (in_flight > 0) {
+        auto now = Clock::now();
+        auto earliest = Clock::time_point::max();
+        for (size_t i = 0; i < exchanges.size(); ++i) {
+            if (!exchanges[i].pending) {
+                continue;
+            }
+            if (exchanges[i].deadline <= now) {
+                samples[i].error = "Timed out";
+                finish(i, true);
+            } else if (exchanges[i].deadline < earliest) {
+                earliest = exchanges[i].deadline;
+            }
+        }
+        launch();
+        if (in_flight == 0) {
+            break;
+        }
+        if (hedge_delay && can_launch() && next_hedge < earliest) {
+            earliest = next_hedge;
+        }
+
+        polled.clear();
+        polled_index.clear();
+        for (size_t i = 0; i < exchanges.size(); ++i) {
+            if (exchanges[i].pending) {
+                polled.push_back({exchanges[i].fd, POLLIN, 0});
+                polled_index.push_back(i);
+                if (exchanges[i].deadline < earliest) {
+                    earliest = exchanges[i].deadline;
+                }
+            }
+        }
+
+        auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(earliest - now);
+        int ready = poll(polled.data(), polled.size(), static_cast<int>(wait.count()) + 1);
+        if (ready < 0 && errno != EINTR) {
+            break;
+        }
+
+        for (size_t p = 0; ready > 0 && p < polled.size() && !answered; ++p) {
+            if (polled[p].revents == 0) {
+                continue;
+            }
+            size_t i = polled_index[p];
+            uint8_t reply[NtpResponder::kPacketSize + 20];
+            int64_t kernel_ns = 0;
+            ssize_t received = receive_reply(exchanges[i].fd, reply, sizeof(reply), kernel_ns);
+            int64_t received_ns = local_now_ns();  // T4, straight after the read
+            int64_t received_raw_ns = TimeSource::current().raw_now_ns();
+            if (kernel_ns != 0 && kernel_ns <= received_ns) {
+                // The arrival stamp keeps time spent before the read out of T4
+                received_raw_ns -= received_ns - kernel_ns;
+                received_ns = kernel_ns;
+            }
+
+            ReplyCheck check = ReplyCheck::IGNORE;
+            if (received >= 0) {
+                check = check_reply(reply, static_cast<size_t>(received), exchanges[i], received_ns, samples[i]);
+            } else if (!Platform::would_block()) {
+                samples[i].error = std::string("Receive failed: ") + strerror(errno);
+                check = ReplyCheck::REJECT;
+            }
+            if (check == ReplyCheck::ACCEPT) {
+                samples[i].raw_time_ns = received_raw_ns;
+                samples[i].response_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    Clock::now() - exchanges[i].sent).count();
+                answered = hedge_delay != nullptr && UpstreamSync::is_usable(samples[i]);
+            }
+            if (check != ReplyCheck::IGNORE) {
+                // An unusable answer is replaced at once, like a failure
+                finish(i, check == ReplyCheck::REJECT || !UpstreamSync::is_usable(samples[i]));
+            }
+        }
+
+        if (answered) {
+            for (size_t i = 0; i < exchanges.size(); ++i) {
+                if (exchanges[i].pending) {
+                    samples[i].abandoned = true;
+                    samples[i].error = "Abandoned for a faster upstream";
+                    finish(i, false);
+                }
+            }
+        }
+        launch();
+    }
+
+    for (size_t i = 0; i < exchanges.size(); ++i) {
+        if (exchanges[i].pending) {
+            samples[i].error = "Timed out";
+            finish(i, true);
+        }
+    }
+    if (hedge_delay) {
+        samples.resize(next);
+    }
+    return samples;
+}
+
+} // namespace
+
+UpstreamSync::UpstreamSync(UpstreamManager& upstreams)
+    : upstreams_(upstreams)
+    , timeout_(1000)
+    , history_next_(0)
+{
+    response_history_.reserve(kHedgeHistory);
+}
+
+std::vector<UpstreamSample> UpstreamSync::sample_all() {
+    std::vector<UpstreamServer> servers;
+    for (const auto& server : upstreams_.get_servers()) {
+        if (server.enabled) {
+            servers.push_back(server);
+        }
+    }
+
+    std::vector<UpstreamSample> samples = query(servers, timeout_, upstreams_.get_probe_concurrency());
+    record_round(samples);
+    return samples;
+}
+
+std::vector<UpstreamSample> UpstreamSync::sample_hedged() {
+    std::vector<UpstreamSample> samples = query_hedged(upstreams_.rank_servers(), timeout_, get_hedge_delay(),
+                                                       upstreams_.get_hedge_max_outstanding());
+    record_round(samples);
+    return samples;
+}
+
+std::chrono::nanoseconds UpstreamSync::get_hedge_delay() const {
+    std::vector<int64_t> history;
+    {
+        std::lock_guard<std::mutex> lock(history_mutex_);
+        history = response_history_;
+    }
+    if (history.size() < kMinHedgeHistory) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(timeout_) / 4;
+    }
+
+    double fraction = upstreams_.get_hedge_delay_percentile() / 100.0;
+    size_t rank = static_cast<size_t>(std::ceil(fraction * static_cast<double>(history.size())));
+    rank = std::min(history.size() - 1, rank > 0 ? rank - 1 : 0);
+    std::nth_element(history.begin(), history.begin() + rank, history.end());
+    return std::chrono::nanoseconds(history[rank]);
+}
+
+void UpstreamSync::record_round(const std::vector<UpstreamSample>& samples) {
+    std::vector<UpstreamResult> results;
+    results.reserve(samples.size());
+    {
+        std::lock_guard<std::mutex> lock(history_mutex_);
+        for (const auto& sample : samples) {
+            if (sample.valid) {
+                results.push_back({sample.address, true, std::chrono::microseconds((sample.delay_ns + 999) / 1000)});
+                if (response_history_.size() < kHedgeHistory) {
+                    response_history_.push_back(sample.response_ns);
+                } else {
+                    response_history_[history_next_] = sample.response_ns;
+                }
+                history_next_ = (history_next_ + 1) % kHedgeHistory;
+            } else if (!sample.abandoned) {
+                results.push_back({sample.address, false, std::chrono::microseconds(0)});
+            }
+        }
+    }
+    // One snapshot for the round, not one per answer
+    upstreams_.record_results(results);
+}
+
+std::vector<UpstreamSample> UpstreamSync::query(const std::vector<UpstreamServer>& servers,
+                                                std::chrono::milliseconds timeout,
+                                                size_t max_outstanding) {
+    return run_exchanges(servers, timeout, max_outstanding, nullptr);
+}
+
+std::vector<UpstreamSample> UpstreamSync::query_hedged(const std::vector<UpstreamServer>& ranked,
+                                                       std::chrono::milliseconds timeout,
+                                                       std::chrono::nanoseconds hedge_delay,
+                                                       size_t max_outstanding) {
+    return run_exchanges(ranked, timeout, max_outstanding, &hedge_delay);
+}
+
+bool UpstreamSync::best_sample(const std::vector<UpstreamSample>& samples, UpstreamSample& best) {
+    const UpstreamSample* found = nullptr;
+    for (const auto& sample : samples) {
+        if (is_usable(sample) && (!found || sample.delay_ns < found->delay_ns)) {
+            found = &sample;
+        }
+    }
+    if (found) {
+        best = *found;
+    }
+    return found != nullptr;
+}
+
+bool UpstreamSync::combine_samples(const std::vector<UpstreamSample>& samples, UpstreamSample& combined) {
+    std::map<std::string, LatencySummary> latencies;
+    for (const auto& server : upstreams_.get_servers()) {
+        latencies[server.address] = server.latency;
+    }
+
+    std::vector<const UpstreamSample*> valid;
+    std::vector<ClockSelect::Candidate> candidates;
+    for (const auto& sample : samples) {
+        if (!is_usable(sample)) {
+            continue;
+        }
+        ClockSelect::Candidate candidate;
+        candidate.offset_ns = sample.offset_ns;
+        candidate.root_distance_ns = root_distance_ns(sample);
+
+        // Offset error is bounded by half the delay's variation, so the
+        // spread of recent round trips stands in for the upstream's jitter
+        auto latency = latencies.find(sample.address);
+        if (latency != latencies.end() && !latency->second.empty()) {
+            uint64_t spread_us = latency->second.quantile_us(0.95) - latency->second.quantile_us(0.5);
+            candidate.jitter_ns = static_cast<int64_t>(spread_us * 1000 / 2);
+        }
+        candidate.root_distance_ns += candidate.jitter_ns;
+        valid.push_back(&sample);
+        candidates.push_back(candidate);
+    }
+
+    ClockSelect::Result selection = ClockSelect::select(candidates);
+    if (!selection.valid) {
+        return false;
+    }
+
+    std::vector<std::string> falsetickers;
+    for (size_t i = 0, t = 0; i < valid.size(); ++i) {
+        if (t < selection.truechimers.size() && selection.truechimers[t] == i) {
+            ++t;
+        } else {
+            falsetickers.push_back(valid[i]->address);
+        }
+    }
+    upstreams_.set_falsetickers(falsetickers);
+
+    combined = *valid[selection.system_peer];
+    combined.offset_ns = selection.offset_ns;
+    return true;
+}
+
+int64_t UpstreamSync::root_distance_ns(const UpstreamSample& sample) {
+    // The floor keeps a nearby primary's interval from shrinking below
+    // its measurement noise, now that truechimers need their offset inside
+    // the intersection
+    return std::max(kMinDispersionNs, sample.delay_ns + sample.root_delay_ns) / 2 + sample.root_dispersion_ns;
+}
+
+bool UpstreamSync::parse_upstream(const std::string& entry, int default_port,
+                                  std::string& host, int& port) {
+    std::string port_text;
+    if (!entry.empty() && entry[0] == '[') {
+        size_t close = entry.find(']');
+        if (close == std::string::npos) {
+            return false;
+        }
+        host = entry.substr(1, close - 1);
+        if (close + 1 < entry.size()) {
+            if (entry[close + 1] != ':') {
+                return false;
+            }
+            port_text = entry.substr(close + 2);
+        }
+    } else {
+        // More than one colon is a bare IPv6 address
+        size_t colon = entry.find(':');
+        if (colon != std::string::npos && entry.find(':', colon + 1) == std::string::npos) {
+            host = entry.substr(0, colon);
+            port_text = entry.substr(colon + 1);
+        } else {
+            host = entry;
+        }
+    }
+
+    port = default_port;
+    if (!port_text.empty()) {
+        char* end = nullptr;
+        long value = std::strtol(port_text.c_str(), &end, 10);
+        if (*end != '\0' || value < 1 || value > 65535) {
+            return false;
+        }
+        port = static_cast<int>(value);
+    }
+    return !host.empty();
+}
+
+int64_t UpstreamSync::ntp_difference_ns(uint64_t later, uint64_t earlier) {
+    // Wrapping subtraction keeps differences right across an era boundary
+    int64_t difference = static_cast<int64_t>(later - earlier);
+    int64_t seconds = difference >> 32;
+    uint64_t fraction = static_cast<uint64_t>(difference) & 0xFFFFFFFFull;
+    return seconds * 1000000000 + static_cast<int64_t>((fraction * 1000000000ull) >> 32);
+}
+
+} // namespace simple_utcd
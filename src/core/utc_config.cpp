@@ -67,9 +67,40 @@ UTCConfig::UTCConfig(const UTCConfig& other) {
     allowed_clients_ = other.allowed_clients_;
     denied_clients_ = other.denied_clients_;
     worker_threads_ = other.worker_threads_;
+    enable_so_reuseport_ = other.enable_so_reuseport_;
+    enable_io_uring_ = other.enable_io_uring_;
+    handoff_queue_depth_ = other.handoff_queue_depth_;
     max_packet_size_ = other.max_packet_size_;
     enable_statistics_ = other.enable_statistics_;
     stats_interval_ = other.stats_interval_;
+    enable_udp_ = other.enable_udp_;
+    enable_rate_limiting_ = other.enable_rate_limiting_;
+    rate_limit_requests_per_second_ = other.rate_limit_requests_per_second_;
+    rate_limit_burst_size_ = other.rate_limit_burst_size_;
+    enable_ddos_protection_ = other.enable_ddos_protection_;
+    ddos_threshold_ = other.ddos_threshold_;
+    ddos_block_duration_ = other.ddos_block_duration_;
+    udp_batch_size_ = other.udp_batch_size_;
+    enable_fast_path_ = other.enable_fast_path_;
+    cpu_affinity_ = other.cpu_affinity_;
+    enable_numa_placement_ = other.enable_numa_placement_;
+    enable_admission_control_ = other.enable_admission_control_;
+    admission_target_ms_ = other.admission_target_ms_;
+    admission_interval_ms_ = other.admission_interval_ms_;
+    enable_ntp_ = other.enable_ntp_;
+    ntp_port_ = other.ntp_port_;
+    enable_kernel_timestamps_ = other.enable_kernel_timestamps_;
+    enable_cpu_steering_ = other.enable_cpu_steering_;
+    enable_busy_poll_ = other.enable_busy_poll_;
+    busy_poll_us_ = other.busy_poll_us_;
+    busy_poll_idle_us_ = other.busy_poll_idle_us_;
+    enable_upstream_sync_ = other.enable_upstream_sync_;
+    upstream_probe_concurrency_ = other.upstream_probe_concurrency_;
+    upstream_hedge_percentile_ = other.upstream_hedge_percentile_;
+    upstream_hedge_max_outstanding_ = other.upstream_hedge_max_outstanding_;
+    upstream_selection_strategy_ = other.upstream_selection_strategy_;
+    enable_virtual_clock_ = other.enable_virtual_clock_;
+    virtual_clock_time_constant_ = other.virtual_clock_time_constant_;
 }
 
 UTCConfig& UTCConfig::operator=(const UTCConfig& other) {
@@ -94,9 +125,40 @@ UTCConfig& UTCConfig::operator=(const UTCConfig& other) {
         allowed_clients_ = other.allowed_clients_;
         denied_clients_ = other.denied_clients_;
         worker_threads_ = other.worker_threads_;
+        enable_so_reuseport_ = other.enable_so_reuseport_;
+        enable_io_uring_ = other.enable_io_uring_;
+        handoff_queue_depth_ = other.handoff_queue_depth_;
         max_packet_size_ = other.max_packet_size_;
         enable_statistics_ = other.enable_statistics_;
         stats_interval_ = other.stats_interval_;
+        enable_udp_ = other.enable_udp_;
+        enable_rate_limiting_ = other.enable_rate_limiting_;
+        rate_limit_requests_per_second_ = other.rate_limit_requests_per_second_;
+        rate_limit_burst_size_ = other.rate_limit_burst_size_;
+        enable_ddos_protection_ = other.enable_ddos_protection_;
+        ddos_threshold_ = other.ddos_threshold_;
+        ddos_block_duration_ = other.ddos_block_duration_;
+        udp_batch_size_ = other.udp_batch_size_;
+        enable_fast_path_ = other.enable_fast_path_;
+        cpu_affinity_ = other.cpu_affinity_;
+        enable_numa_placement_ = other.enable_numa_placement_;
+        enable_admission_control_ = other.enable_admission_control_;
+        admission_target_ms_ = other.admission_target_ms_;
+        admission_interval_ms_ = other.admission_interval_ms_;
+        enable_ntp_ = other.enable_ntp_;
+        ntp_port_ = other.ntp_port_;
+        enable_kernel_timestamps_ = other.enable_kernel_timestamps_;
+        enable_cpu_steering_ = other.enable_cpu_steering_;
+        enable_busy_poll_ = other.enable_busy_poll_;
+        busy_poll_us_ = other.busy_poll_us_;
+        busy_poll_idle_us_ = other.busy_poll_idle_us_;
+        enable_upstream_sync_ = other.enable_upstream_sync_;
+        upstream_probe_concurrency_ = other.upstream_probe_concurrency_;
+        upstream_hedge_percentile_ = other.upstream_hedge_percentile_;
+        upstream_hedge_max_outstanding_ = other.upstream_hedge_max_outstanding_;
+        upstream_selection_strategy_ = other.upstream_selection_strategy_;
+        enable_virtual_clock_ = other.enable_virtual_clock_;
+        virtual_clock_time_constant_ = other.virtual_clock_time_constant_;
     }
     return *this;
 }
@@ -111,6 +173,10 @@ void UTCConfig::set_defaults() {
     listen_port_ = 37;  // UTC protocol port
     enable_ipv6_ = true;
     max_connections_ = 1000;
+    enable_udp_ = false;
+    enable_ntp_ = false;
+    ntp_port_ = 123;
+    enable_kernel_timestamps_ = false;
 
     // UTC Server Configuration
     stratum_ = 2;
@@ -119,6 +185,13 @@ void UTCConfig::set_defaults() {
     upstream_servers_ = {"time.nist.gov", "time.google.com", "pool.ntp.org"};
     sync_interval_ = 64;
     timeout_ = 1000;
+    enable_upstream_sync_ = false;
+    upstream_probe_concurrency_ = 64;
+    upstream_hedge_percentile_ = 95.0;
+    upstream_hedge_max_outstanding_ = 0;
+    upstream_selection_strategy_ = "health_based";
+    enable_virtual_clock_ = false;
+    virtual_clock_time_constant_ = 256;
 
     // Logging Configuration
     log_file_ = "/var/log/simple-utcd/simple-utcd.log";
@@ -132,12 +205,32 @@ void UTCConfig::set_defaults() {
     restrict_queries_ = false;
     allowed_clients_ = {};
     denied_clients_ = {};
+    enable_rate_limiting_ = false;
+    rate_limit_requests_per_second_ = 100;
+    rate_limit_burst_size_ = 20;
+    enable_ddos_protection_ = false;
+    ddos_threshold_ = 1000;
+    ddos_block_duration_ = 3600;
 
     // Performance Configuration
     worker_threads_ = 4;
+    enable_so_reuseport_ = false;
+    enable_io_uring_ = false;
+    handoff_queue_depth_ = 1024;
     max_packet_size_ = 1024;
     enable_statistics_ = true;
     stats_interval_ = 60;
+    udp_batch_size_ = 32;
+    enable_fast_path_ = true;
+    cpu_affinity_ = "";
+    enable_numa_placement_ = false;
+    enable_admission_control_ = false;
+    admission_target_ms_ = 5;
+    admission_interval_ms_ = 100;
+    enable_cpu_steering_ = false;
+    enable_busy_poll_ = false;
+    busy_poll_us_ = 50;
+    busy_poll_idle_us_ = 1000;
 }
 
 UTCConfig::ConfigFormat UTCConfig::detect_format(const std::string& config_file) {
@@ -234,6 +327,10 @@ bool UTCConfig::save(const std::string& config_file) {
     file << "listen_address = " << listen_address_ << "\n";
     file << "listen_port = " << listen_port_ << "\n";
     file << "enable_ipv6 = " << (enable_ipv6_ ? "true" : "false") << "\n";
+    file << "enable_udp = " << (enable_udp_ ? "true" : "false") << "\n";
+    file << "enable_ntp = " << (enable_ntp_ ? "true" : "false") << "\n";
+    file << "ntp_port = " << ntp_port_ << "\n";
+    file << "enable_kernel_timestamps = " << (enable_kernel_timestamps_ ? "true" : "false") << "\n";
     file << "max_connections = " << max_connections_ << "\n\n";
 
     // UTC Server Configuration
@@ -248,6 +345,13 @@ bool UTCConfig::save(const std::string& config_file) {
     }
     file << "]\n";
     file << "sync_interval = " << sync_interval_ << "\n";
+    file << "enable_upstream_sync = " << (enable_upstream_sync_ ? "true" : "false") << "\n";
+    file << "upstream_probe_concurrency = " << upstream_probe_concurrency_ << "\n";
+    file << "upstream_hedge_percentile = " << upstream_hedge_percentile_ << "\n";
+    file << "upstream_hedge_max_outstanding = " << upstream_hedge_max_outstanding_ << "\n";
+    file << "upstream_selection_strategy = " << upstream_selection_strategy_ << "\n";
+    file << "enable_virtual_clock = " << (enable_virtual_clock_ ? "true" : "false") << "\n";
+    file << "virtual_clock_time_constant = " << virtual_clock_time_constant_ << "\n";
     file << "timeout = " << timeout_ << "\n\n";
 
     // Logging Configuration
@@ -262,6 +366,12 @@ bool UTCConfig::save(const std::string& config_file) {
     file << "enable_authentication = " << (enable_authentication_ ? "true" : "false") << "\n";
     file << "authentication_key = " << authentication_key_ << "\n";
     file << "restrict_queries = " << (restrict_queries_ ? "true" : "false") << "\n";
+    file << "enable_rate_limiting = " << (enable_rate_limiting_ ? "true" : "false") << "\n";
+    file << "rate_limit_requests_per_second = " << rate_limit_requests_per_second_ << "\n";
+    file << "rate_limit_burst_size = " << rate_limit_burst_size_ << "\n";
+    file << "enable_ddos_protection = " << (enable_ddos_protection_ ? "true" : "false") << "\n";
+    file << "ddos_threshold = " << ddos_threshold_ << "\n";
+    file << "ddos_block_duration = " << ddos_block_duration_ << "\n";
     file << "allowed_clients = [";
     for (size_t i = 0; i < allowed_clients_.size(); ++i) {
         if (i > 0) file << ", ";
@@ -278,8 +388,22 @@ bool UTCConfig::save(const std::string& config_file) {
     // Performance Configuration
     file << "# Performance Configuration\n";
     file << "worker_threads = " << worker_threads_ << "\n";
+    file << "enable_so_reuseport = " << (enable_so_reuseport_ ? "true" : "false") << "\n";
+    file << "enable_io_uring = " << (enable_io_uring_ ? "true" : "false") << "\n";
+    file << "handoff_queue_depth = " << handoff_queue_depth_ << "\n";
     file << "max_packet_size = " << max_packet_size_ << "\n";
     file << "enable_statistics = " << (enable_statistics_ ? "true" : "false") << "\n";
+    file << "udp_batch_size = " << udp_batch_size_ << "\n";
+    file << "enable_fast_path = " << (enable_fast_path_ ? "true" : "false") << "\n";
+    file << "cpu_affinity = " << cpu_affinity_ << "\n";
+    file << "enable_numa_placement = " << (enable_numa_placement_ ? "true" : "false") << "\n";
+    file << "enable_admission_control = " << (enable_admission_control_ ? "true" : "false") << "\n";
+    file << "admission_target_ms = " << admission_target_ms_ << "\n";
+    file << "admission_interval_ms = " << admission_interval_ms_ << "\n";
+    file << "enable_cpu_steering = " << (enable_cpu_steering_ ? "true" : "false") << "\n";
+    file << "enable_busy_poll = " << (enable_busy_poll_ ? "true" : "false") << "\n";
+    file << "busy_poll_us = " << busy_poll_us_ << "\n";
+    file << "busy_poll_idle_us = " << busy_poll_idle_us_ << "\n";
     file << "stats_interval = " << stats_interval_ << "\n\n";
 
     file.close();
@@ -340,12 +464,74 @@ bool UTCConfig::parse_config_line(const std::string& line) {
         denied_clients_ = parse_list(value);
     } else if (key == "worker_threads") {
         worker_threads_ = std::stoi(value);
+    } else if (key == "enable_so_reuseport") {
+        enable_so_reuseport_ = (value == "true" || value == "1" || value == "yes");
+    } else if (key == "enable_io_uring") {
+        enable_io_uring_ = (value == "true" || value == "1" || value == "yes");
+    } else if (key == "handoff_queue_depth") {
+        handoff_queue_depth_ = std::stoi(value);
     } else if (key == "max_packet_size") {
         max_packet_size_ = std::stoi(value);
     } else if (key == "enable_statistics") {
         enable_statistics_ = (value == "true" || value == "1" || value == "yes");
     } else if (key == "stats_interval") {
         stats_interval_ = std::stoi(value);
+    } else if (key == "enable_udp") {
+        enable_udp_ = (value == "true" || value == "1" || value == "yes");
+    } else if (key == "enable_rate_limiting") {
+        enable_rate_limiting_ = (value == "true" || value == "1" || value == "yes");
+    } else if (key == "rate_limit_requests_per_second") {
+        rate_limit_requests_per_second_ = std::stoi(value);
+    } else if (key == "rate_limit_burst_size") {
+        rate_limit_burst_size_ = std::stoi(value);
+    } else if (key == "enable_ddos_protection") {
+        enable_ddos_protection_ = (value == "true" || value == "1" || value == "yes");
+    } else if (key == "ddos_threshold") {
+        ddos_threshold_ = std::stoi(value);
+    } else if (key == "ddos_block_duration") {
+        ddos_block_duration_ = std::stoi(value);
+    } else if (key == "udp_batch_size") {
+        udp_batch_size_ = std::stoi(value);
+    } else if (key == "enable_fast_path") {
+        enable_fast_path_ = (value == "true" || value == "1" || value == "yes");
+    } else if (key == "cpu_affinity") {
+        cpu_affinity_ = value;
+    } else if (key == "enable_numa_placement") {
+        enable_numa_placement_ = (value == "true" || value == "1" || value == "yes");
+    } else if (key == "enable_admission_control") {
+        enable_admission_control_ = (value == "true" || value == "1" || value == "yes");
+    } else if (key == "admission_target_ms") {
+        admission_target_ms_ = std::stoi(value);
+    } else if (key == "admission_interval_ms") {
+        admission_interval_ms_ = std::stoi(value);
+    } else if (key == "enable_ntp") {
+        enable_ntp_ = (value == "true" || value == "1" || value == "yes");
+    } else if (key == "ntp_port") {
+        ntp_port_ = std::stoi(value);
+    } else if (key == "enable_kernel_timestamps") {
+        enable_kernel_timestamps_ = (value == "true" || value == "1" || value == "yes");
+    } else if (key == "enable_cpu_steering") {
+        enable_cpu_steering_ = (value == "true" || value == "1" || value == "yes");
+    } else if (key == "enable_busy_poll") {
+        enable_busy_poll_ = (value == "true" || value == "1" || value == "yes");
+    } else if (key == "busy_poll_us") {
+        busy_poll_us_ = std::stoi(value);
+    } else if (key == "busy_poll_idle_us") {
+        busy_poll_idle_us_ = std::stoi(value);
+    } else if (key == "enable_upstream_sync") {
+        enable_upstream_sync_ = (value == "true" || value == "1" || value == "yes");
+    } else if (key == "upstream_probe_concurrency") {
+        upstream_probe_concurrency_ = std::stoi(value);
+    } else if (key == "upstream_hedge_percentile") {
+        upstream_hedge_percentile_ = std::stod(value);
+    } else if (key == "upstream_hedge_max_outstanding") {
+        upstream_hedge_max_outstanding_ = std::stoi(value);
+    } else if (key == "upstream_selection_strategy") {
+        upstream_selection_strategy_ = value;
+    } else if (key == "enable_virtual_clock") {
+        enable_virtual_clock_ = (value == "true" || value == "1" || value == "yes");
+    } else if (key == "virtual_clock_time_constant") {
+        virtual_clock_time_constant_ = std::stoi(value);
     } else {
         // Unknown configuration option
         return false;
@@ -364,6 +550,51 @@ std::string UTCConfig::trim(const std::string& str) {
     return str.substr(first, (last - first + 1));
 }
 
+std::vector<int> UTCConfig::get_cpu_affinity_list() const {
+    std::vector<int> cpus;
+    if (!parse_cpu_list(cpu_affinity_, cpus)) {
+        cpus.clear();
+    }
+    return cpus;
+}
+
+bool UTCConfig::parse_cpu_list(const std::string& list, std::vector<int>& cpus) {
+    // Same syntax as taskset/cpuset: comma-separated ids and inclusive ranges
+    constexpr int kMaxCpu = 1023;
+    std::stringstream ss(list);
+    std::string item;
+
+    while (std::getline(ss, item, ',')) {
+        item.erase(std::remove_if(item.begin(), item.end(), ::isspace), item.end());
+        if (item.empty()) {
+            continue;
+        }
+
+        size_t dash = item.find('-');
+        std::string first_str = item.substr(0, dash);
+        std::string last_str = dash == std::string::npos ? first_str : item.substr(dash + 1);
+        if (first_str.empty() || last_str.empty() ||
+            !std::all_of(first_str.begin(), first_str.end(), ::isdigit) ||
+            !std::all_of(last_str.begin(), last_str.end(), ::isdigit) ||
+            first_str.size() > 4 || last_str.size() > 4) {
+            return false;
+        }
+
+        int first = std::stoi(first_str);
+        int last = std::stoi(last_str);
+        if (first > last || last > kMaxCpu) {
+            return false;
+        }
+
+        for (int cpu = first; cpu <= last; ++cpu) {
+            if (std::find(cpus.begin(), cpus.end(), cpu) == cpus.end()) {
+                cpus.push_back(cpu);
+            }
+        }
+    }
+    return true;
+}
+
 std::vector<std::string> UTCConfig::parse_list(const std::string& str) {
     std::vector<std::string> result;
 
@@ -472,6 +703,18 @@ bool UTCConfig::load_json(const std::string& config_file) {
         if (network.isMember("max_connections")) {
             max_connections_ = network["max_connections"].asInt();
         }
+        if (network.isMember("enable_udp")) {
+            enable_udp_ = network["enable_udp"].asBool();
+        }
+        if (network.isMember("enable_ntp")) {
+            enable_ntp_ = network["enable_ntp"].asBool();
+        }
+        if (network.isMember("ntp_port")) {
+            ntp_port_ = network["ntp_port"].asInt();
+        }
+        if (network.isMember("enable_kernel_timestamps")) {
+            enable_kernel_timestamps_ = network["enable_kernel_timestamps"].asBool();
+        }
     }
     
     if (root.isMember("server")) {
@@ -497,6 +740,27 @@ bool UTCConfig::load_json(const std::string& config_file) {
         if (server.isMember("timeout")) {
             timeout_ = server["timeout"].asInt();
         }
+        if (server.isMember("enable_upstream_sync")) {
+            enable_upstream_sync_ = server["enable_upstream_sync"].asBool();
+        }
+        if (server.isMember("upstream_probe_concurrency")) {
+            upstream_probe_concurrency_ = server["upstream_probe_concurrency"].asInt();
+        }
+        if (server.isMember("upstream_hedge_percentile")) {
+            upstream_hedge_percentile_ = server["upstream_hedge_percentile"].asDouble();
+        }
+        if (server.isMember("upstream_hedge_max_outstanding")) {
+            upstream_hedge_max_outstanding_ = server["upstream_hedge_max_outstanding"].asInt();
+        }
+        if (server.isMember("upstream_selection_strategy")) {
+            upstream_selection_strategy_ = server["upstream_selection_strategy"].asString();
+        }
+        if (server.isMember("enable_virtual_clock")) {
+            enable_virtual_clock_ = server["enable_virtual_clock"].asBool();
+        }
+        if (server.isMember("virtual_clock_time_constant")) {
+            virtual_clock_time_constant_ = server["virtual_clock_time_constant"].asInt();
+        }
     }
     
     if (root.isMember("logging")) {
@@ -538,6 +802,24 @@ bool UTCConfig::load_json(const std::string& config_file) {
                 denied_clients_.push_back(client.asString());
             }
         }
+        if (security.isMember("enable_rate_limiting")) {
+            enable_rate_limiting_ = security["enable_rate_limiting"].asBool();
+        }
+        if (security.isMember("rate_limit_requests_per_second")) {
+            rate_limit_requests_per_second_ = security["rate_limit_requests_per_second"].asInt();
+        }
+        if (security.isMember("rate_limit_burst_size")) {
+            rate_limit_burst_size_ = security["rate_limit_burst_size"].asInt();
+        }
+        if (security.isMember("enable_ddos_protection")) {
+            enable_ddos_protection_ = security["enable_ddos_protection"].asBool();
+        }
+        if (security.isMember("ddos_threshold")) {
+            ddos_threshold_ = security["ddos_threshold"].asInt();
+        }
+        if (security.isMember("ddos_block_duration")) {
+            ddos_block_duration_ = security["ddos_block_duration"].asInt();
+        }
     }
     
     if (root.isMember("performance")) {
@@ -545,6 +827,15 @@ bool UTCConfig::load_json(const std::string& config_file) {
         if (performance.isMember("worker_threads")) {
             worker_threads_ = performance["worker_threads"].asInt();
         }
+        if (performance.isMember("enable_so_reuseport")) {
+            enable_so_reuseport_ = performance["enable_so_reuseport"].asBool();
+        }
+        if (performance.isMember("enable_io_uring")) {
+            enable_io_uring_ = performance["enable_io_uring"].asBool();
+        }
+        if (performance.isMember("handoff_queue_depth")) {
+            handoff_queue_depth_ = performance["handoff_queue_depth"].asInt();
+        }
         if (performance.isMember("max_packet_size")) {
             max_packet_size_ = performance["max_packet_size"].asInt();
         }
@@ -554,6 +845,39 @@ bool UTCConfig::load_json(const std::string& config_file) {
         if (performance.isMember("stats_interval")) {
             stats_interval_ = performance["stats_interval"].asInt();
         }
+        if (performance.isMember("udp_batch_size")) {
+            udp_batch_size_ = performance["udp_batch_size"].asInt();
+        }
+        if (performance.isMember("enable_fast_path")) {
+            enable_fast_path_ = performance["enable_fast_path"].asBool();
+        }
+        if (performance.isMember("cpu_affinity")) {
+            cpu_affinity_ = performance["cpu_affinity"].asString();
+        }
+        if (performance.isMember("enable_numa_placement")) {
+            enable_numa_placement_ = performance["enable_numa_placement"].asBool();
+        }
+        if (performance.isMember("enable_admission_control")) {
+            enable_admission_control_ = performance["enable_admission_control"].asBool();
+        }
+        if (performance.isMember("admission_target_ms")) {
+            admission_target_ms_ = performance["admission_target_ms"].asInt();
+        }
+        if (performance.isMember("admission_interval_ms")) {
+            admission_interval_ms_ = performance["admission_interval_ms"].asInt();
+        }
+        if (performance.isMember("enable_cpu_steering")) {
+            enable_cpu_steering_ = performance["enable_cpu_steering"].asBool();
+        }
+        if (performance.isMember("enable_busy_poll")) {
+            enable_busy_poll_ = performance["enable_busy_poll"].asBool();
+        }
+        if (performance.isMember("busy_poll_us")) {
+            busy_poll_us_ = performance["busy_poll_us"].asInt();
+        }
+        if (performance.isMember("busy_poll_idle_us")) {
+            busy_poll_idle_us_ = performance["busy_poll_idle_us"].asInt();
+        }
     }
     
     return true;
@@ -662,6 +986,139 @@ void UTCConfig::load_from_environment() {
         }
     }
     
+    env_value = get_env_var("SIMPLE_UTCD_ENABLE_SO_REUSEPORT");
+    if (!env_value.empty()) {
+        enable_so_reuseport_ = (env_value == "true" || env_value == "1" || env_value == "yes");
+    }
+    
+    env_value = get_env_var("SIMPLE_UTCD_ENABLE_IO_URING");
+    if (!env_value.empty()) {
+        enable_io_uring_ = (env_value == "true" || env_value == "1" || env_value == "yes");
+    }
+    
+    env_value = get_env_var("SIMPLE_UTCD_ENABLE_UDP");
+    if (!env_value.empty()) {
+        enable_udp_ = (env_value == "true" || env_value == "1" || env_value == "yes");
+    }
+    
+    env_value = get_env_var("SIMPLE_UTCD_ENABLE_FAST_PATH");
+    if (!env_value.empty()) {
+        enable_fast_path_ = (env_value == "true" || env_value == "1" || env_value == "yes");
+    }
+    
+    env_value = get_env_var("SIMPLE_UTCD_CPU_AFFINITY");
+    if (!env_value.empty()) {
+        cpu_affinity_ = env_value;
+    }
+    
+    env_value = get_env_var("SIMPLE_UTCD_ENABLE_NUMA_PLACEMENT");
+    if (!env_value.empty()) {
+        enable_numa_placement_ = (env_value == "true" || env_value == "1" || env_value == "yes");
+    }
+    
+    env_value = get_env_var("SIMPLE_UTCD_ENABLE_ADMISSION_CONTROL");
+    if (!env_value.empty()) {
+        enable_admission_control_ = (env_value == "true" || env_value == "1" || env_value == "yes");
+    }
+    
+    env_value = get_env_var("SIMPLE_UTCD_ENABLE_NTP");
+    if (!env_value.empty()) {
+        enable_ntp_ = (env_value == "true" || env_value == "1" || env_value == "yes");
+    }
+    
+    env_value = get_env_var("SIMPLE_UTCD_NTP_PORT");
+    if (!env_value.empty()) {
+        try {
+            ntp_port_ = std::stoi(env_value);
+        } catch (...) {
+            // Invalid value, keep default
+        }
+    }
+    
+    env_value = get_env_var("SIMPLE_UTCD_ENABLE_KERNEL_TIMESTAMPS");
+    if (!env_value.empty()) {
+        enable_kernel_timestamps_ = (env_value == "true" || env_value == "1" || env_value == "yes");
+    }
+    
+    env_value = get_env_var("SIMPLE_UTCD_ENABLE_CPU_STEERING");
+    if (!env_value.empty()) {
+        enable_cpu_steering_ = (env_value == "true" || env_value == "1" || env_value == "yes");
+    }
+    
+    env_value = get_env_var("SIMPLE_UTCD_ENABLE_BUSY_POLL");
+    if (!env_value.empty()) {
+        enable_busy_poll_ = (env_value == "true" || env_value == "1" || env_value == "yes");
+    }
+    
+    env_value = get_env_var("SIMPLE_UTCD_BUSY_POLL_US");
+    if (!env_value.empty()) {
+        try {
+            busy_poll_us_ = std::stoi(env_value);
+        } catch (...) {
+            // Invalid value, keep default
+        }
+    }
+    
+    env_value = get_env_var("SIMPLE_UTCD_BUSY_POLL_IDLE_US");
+    if (!env_value.empty()) {
+        try {
+            busy_poll_idle_us_ = std::stoi(env_value);
+        } catch (...) {
+            // Invalid value, keep default
+        }
+    }
+    
+    env_value = get_env_var("SIMPLE_UTCD_ENABLE_UPSTREAM_SYNC");
+    if (!env_value.empty()) {
+        enable_upstream_sync_ = (env_value == "true" || env_value == "1" || env_value == "yes");
+    }
+    
+    env_value = get_env_var("SIMPLE_UTCD_UPSTREAM_PROBE_CONCURRENCY");
+    if (!env_value.empty()) {
+        try {
+            upstream_probe_concurrency_ = std::stoi(env_value);
+        } catch (...) {
+            // Invalid value, keep default
+        }
+    }
+    
+    env_value = get_env_var("SIMPLE_UTCD_UPSTREAM_HEDGE_PERCENTILE");
+    if (!env_value.empty()) {
+        try {
+            upstream_hedge_percentile_ = std::stod(env_value);
+        } catch (...) {
+            // Invalid value, keep default
+        }
+    }
+    
+    env_value = get_env_var("SIMPLE_UTCD_UPSTREAM_HEDGE_MAX_OUTSTANDING");
+    if (!env_value.empty()) {
+        try {
+            upstream_hedge_max_outstanding_ = std::stoi(env_value);
+        } catch (...) {
+            // Invalid value, keep default
+        }
+    }
+    
+    env_value = get_env_var("SIMPLE_UTCD_UPSTREAM_SELECTION_STRATEGY");
+    if (!env_value.empty()) {
+        upstream_selection_strategy_ = env_value;
+    }
+    
+    env_value = get_env_var("SIMPLE_UTCD_ENABLE_VIRTUAL_CLOCK");
+    if (!env_value.empty()) {
+        enable_virtual_clock_ = (env_value == "true" || env_value == "1" || env_value == "yes");
+    }
+    
+    env_value = get_env_var("SIMPLE_UTCD_VIRTUAL_CLOCK_TIME_CONSTANT");
+    if (!env_value.empty()) {
+        try {
+            virtual_clock_time_constant_ = std::stoi(env_value);
+        } catch (...) {
+            // Invalid value, keep default
+        }
+    }
+    
     // Security configuration (sensitive data)
     env_value = get_env_var("SIMPLE_UTCD_AUTH_KEY");
     if (!env_value.empty()) {
@@ -712,6 +1169,11 @@ bool UTCConfig::validate_network_config() const {
         validation_errors_.push_back("listen_address cannot be empty");
         valid = false;
     }
+
+    if (ntp_port_ < 1 || ntp_port_ > 65535) {
+        validation_errors_.push_back("Invalid ntp_port: must be between 1 and 65535");
+        valid = false;
+    }
     
     return valid;
 }
@@ -733,6 +1195,35 @@ bool UTCConfig::validate_server_config() const {
         validation_errors_.push_back("Invalid timeout: must be between 1 and 60000 ms");
         valid = false;
     }
+
+    if (upstream_probe_concurrency_ < 0 || upstream_probe_concurrency_ > 4096) {
+        validation_errors_.push_back("Invalid upstream_probe_concurrency: must be between 0 and 4096");
+        valid = false;
+    }
+
+    if (!(upstream_hedge_percentile_ > 0.0 && upstream_hedge_percentile_ <= 100.0)) {
+        validation_errors_.push_back("Invalid upstream_hedge_percentile: must be above 0 and at most 100");
+        valid = false;
+    }
+
+    if (upstream_hedge_max_outstanding_ < 0 || upstream_hedge_max_outstanding_ > 64) {
+        validation_errors_.push_back("Invalid upstream_hedge_max_outstanding: must be between 0 and 64");
+        valid = false;
+    }
+
+    std::vector<std::string> valid_strategies = {"round_robin", "least_latency", "health_based",
+                                                 "priority", "intersection"};
+    if (std::find(valid_strategies.begin(), valid_strategies.end(), upstream_selection_strategy_) ==
+        valid_strategies.end()) {
+        validation_errors_.push_back("Invalid upstream_selection_strategy: must be round_robin, least_latency, "
+                                     "health_based, priority, or intersection");
+        valid = false;
+    }
+
+    if (virtual_clock_time_constant_ < 16 || virtual_clock_time_constant_ > 65536) {
+        validation_errors_.push_back("Invalid virtual_clock_time_constant: must be between 16 and 65536 seconds");
+        valid = false;
+    }
     
     return valid;
 }
@@ -760,6 +1251,16 @@ bool UTCConfig::validate_security_config() const {
         valid = false;
     }
     
+    if (enable_rate_limiting_ && (rate_limit_requests_per_second_ < 1 || rate_limit_burst_size_ < 1)) {
+        validation_errors_.push_back("Invalid rate limit: requests per second and burst size must be at least 1");
+        valid = false;
+    }
+    
+    if (enable_ddos_protection_ && (ddos_threshold_ < 1 || ddos_block_duration_ < 1)) {
+        validation_errors_.push_back("Invalid DDoS protection: threshold and block duration must be at least 1");
+        valid = false;
+    }
+    
     return valid;
 }
 
@@ -771,6 +1272,38 @@ bool UTCConfig::validate_performance_config() const {
         valid = false;
     }
     
+    if (handoff_queue_depth_ < 1 || handoff_queue_depth_ > 1048576) {
+        validation_errors_.push_back("Invalid handoff_queue_depth: must be between 1 and 1048576");
+        valid = false;
+    }
+    
+    if (udp_batch_size_ < 1 || udp_batch_size_ > 1024) {
+        validation_errors_.push_back("Invalid udp_batch_size: must be between 1 and 1024");
+        valid = false;
+    }
+    
+    if (enable_admission_control_ &&
+        (admission_target_ms_ < 1 || admission_interval_ms_ < admission_target_ms_ || admission_interval_ms_ > 60000)) {
+        validation_errors_.push_back("Invalid admission control: target must be at least 1 ms and interval between target and 60000 ms");
+        valid = false;
+    }
+    
+    if (busy_poll_us_ < 0 || busy_poll_us_ > 10000 || busy_poll_idle_us_ < 0 || busy_poll_idle_us_ > 10000000) {
+        validation_errors_.push_back("Invalid busy poll: busy_poll_us must be between 0 and 10000 and busy_poll_idle_us between 0 and 10000000");
+        valid = false;
+    }
+    
+    if (busy_poll_us_ < 0 || busy_poll_us_ > 10000 || busy_poll_idle_us_ < 0 || busy_poll_idle_us_ > 10000000) {
+        validation_errors_.push_back("Invalid busy poll: busy_poll_us must be between 0 and 10000 and busy_poll_idle_us between 0 and 10000000");
+        valid = false;
+    }
+    
+    std::vector<int> cpus;
+    if (!parse_cpu_list(cpu_affinity_, cpus)) {
+        validation_errors_.push_back("Invalid cpu_affinity: expected CPU ids or ranges such as 0-3,8 (ids 0-1023)");
+        valid = false;
+    }
+    
     if (max_packet_size_ < 4 || max_packet_size_ > 65535) {
         validation_errors_.push_back("Invalid max_packet_size: must be between 4 and 65535");
         valid = false;
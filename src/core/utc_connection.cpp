@@ -39,10 +39,10 @@
 
 namespace simple_utcd {
 
-UTCConnection::UTCConnection(int socket_fd, const std::string& client_address,
+UTCConnection::UTCConnection(int socket_fd, const struct sockaddr_storage& peer,
                              UTCConfig* config, Logger* logger)
     : socket_fd_(socket_fd)
-    , client_address_(client_address)
+    , peer_(PeerAddress::from_sockaddr(peer))
     , config_(config)
     , logger_(logger)
     , connected_(true)
@@ -50,9 +50,12 @@ UTCConnection::UTCConnection(int socket_fd, const std::string& client_address,
     , packets_received_(0)
     , bytes_sent_(0)
     , bytes_received_(0)
+    , send_size_(0)
+    , send_offset_(0)
+    , accepted_at_(std::chrono::steady_clock::now())
 {
-    if (logger_) {
-        logger_->info("New connection from {}", client_address_);
+    if (logger_ && logger_->is_enabled(LogLevel::DEBUG)) {
+        logger_->debug("New connection from {}", get_client_address());
     }
 }
 
@@ -60,6 +63,31 @@ UTCConnection::~UTCConnection() {
     close_connection();
 }
 
+PeerAddress PeerAddress::from_sockaddr(const struct sockaddr_storage& address) {
+    PeerAddress peer;
+    if (address.ss_family == AF_INET) {
+        const auto* v4 = reinterpret_cast<const struct sockaddr_in*>(&address);
+        peer.family = AF_INET;
+        peer.port = v4->sin_port;
+        std::memcpy(peer.bytes, &v4->sin_addr, sizeof(v4->sin_addr));
+    } else if (address.ss_family == AF_INET6) {
+        const auto* v6 = reinterpret_cast<const struct sockaddr_in6*>(&address);
+        peer.family = AF_INET6;
+        peer.port = v6->sin6_port;
+        std::memcpy(peer.bytes, &v6->sin6_addr, sizeof(v6->sin6_addr));
+    }
+    return peer;
+}
+
+std::string PeerAddress::to_string() const {
+    if (family != AF_INET && family != AF_INET6) {
+        return std::string();
+    }
+    char text[INET6_ADDRSTRLEN] = {0};
+    inet_ntop(family, bytes, text, sizeof(text));
+    return std::string(text);
+}
+
 bool UTCConnection::send_packet(const UTCPacket& packet) {
     if (!connected_) {
         return false;
@@ -68,24 +96,25 @@ bool UTCConnection::send_packet(const UTCPacket& packet) {
     // Check if client is allowed
     if (!is_client_allowed()) {
         if (logger_) {
-            logger_->warn("Connection from {} denied by access control", client_address_);
+            logger_->warn("Connection from {} denied by access control", get_client_address());
         }
         return false;
     }
 
-    // Convert packet to bytes
-    std::vector<uint8_t> data = packet.to_bytes();
+    UTCPacket::encode_timestamp(packet.get_timestamp(), send_buffer_);
+    send_size_ = sizeof(send_buffer_);
+    send_offset_ = 0;
 
-    // Send packet data
-    if (!send_data(data.data(), data.size())) {
+    // Send packet data; a would-block remainder is finished by later flush() calls
+    if (!flush()) {
         return false;
     }
 
     packets_sent_++;
-    bytes_sent_ += data.size();
+    bytes_sent_ += send_size_;
 
-    if (logger_) {
-        logger_->debug("Sent UTC packet to {}: {}", client_address_, packet.to_string());
+    if (logger_ && logger_->is_enabled(LogLevel::DEBUG)) {
+        logger_->debug("Sent UTC packet to {}: {}", get_client_address(), packet.to_string());
     }
 
     return true;
@@ -106,7 +135,7 @@ bool UTCConnection::receive_packet(UTCPacket& packet) {
 
     if (!packet.from_bytes(data)) {
         if (logger_) {
-            logger_->warn("Invalid packet received from {}", client_address_);
+            logger_->warn("Invalid packet received from {}", get_client_address());
         }
         return false;
     }
@@ -114,49 +143,56 @@ bool UTCConnection::receive_packet(UTCPacket& packet) {
     packets_received_++;
     bytes_received_ += data.size();
 
-    if (logger_) {
-        logger_->debug("Received packet from {}: {}", client_address_, packet.to_string());
+    if (logger_ && logger_->is_enabled(LogLevel::DEBUG)) {
+        logger_->debug("Received packet from {}: {}", get_client_address(), packet.to_string());
     }
 
     return true;
 }
 
-void UTCConnection::close_connection() {
-    if (connected_) {
-        connected_ = false;
-
-        if (logger_) {
-            logger_->info("Closing connection from {} (sent: {}, received: {})",
-                         client_address_, packets_sent_, packets_received_);
-        }
-
-        Platform::close_socket(socket_fd_);
-    }
-}
-
-bool UTCConnection::send_data(const void* data, size_t size) {
+bool UTCConnection::flush() {
     if (!connected_) {
         return false;
     }
 
-    const char* buffer = static_cast<const char*>(data);
-    size_t total_sent = 0;
+#ifdef MSG_NOSIGNAL
+    const int flags = MSG_NOSIGNAL;  // A vanished client must not raise SIGPIPE
+#else
+    const int flags = 0;
+#endif
 
-    while (total_sent < size) {
-        ssize_t sent = send(socket_fd_, buffer + total_sent, size - total_sent, 0);
+    while (has_pending_data()) {
+        ssize_t sent = send(socket_fd_, send_buffer_ + send_offset_,
+                            send_size_ - send_offset_, flags);
 
         if (sent < 0) {
-            UTC_ERROR("UTCConnection", "Failed to send data to " + client_address_ + ": " + Platform::get_last_error());
+            if (Platform::would_block()) {
+                return true;  // Remainder goes out on the next writable event
+            }
+            UTC_ERROR("UTCConnection", "Failed to send data to " + get_client_address() + ": " + std::string(strerror(errno)));
             connected_ = false;
             return false;
         }
 
-        total_sent += sent;
+        send_offset_ += static_cast<size_t>(sent);
     }
 
     return true;
 }
 
+void UTCConnection::close_connection() {
+    if (connected_) {
+        connected_ = false;
+
+        if (logger_ && logger_->is_enabled(LogLevel::DEBUG)) {
+            logger_->debug("Closing connection from {} (sent: {}, received: {})",
+                          get_client_address(), packets_sent_, packets_received_);
+        }
+
+        Platform::close_socket(socket_fd_);
+    }
+}
+
 bool UTCConnection::receive_data(void* data, size_t size) {
     if (!connected_) {
         return false;
@@ -170,12 +206,12 @@ bool UTCConnection::receive_data(void* data, size_t size) {
                                size - total_received, 0);
 
         if (received < 0) {
-            UTC_ERROR("UTCConnection", "Failed to receive data from " + client_address_ + ": " + Platform::get_last_error());
+            UTC_ERROR("UTCConnection", "Failed to receive data from " + get_client_address() + ": " + Platform::get_last_error());
             connected_ = false;
             return false;
         } else if (received == 0) {
             // Connection closed by client
-            UTC_INFO("UTCConnection", "Connection closed by client " + client_address_);
+            UTC_INFO("UTCConnection", "Connection closed by client " + get_client_address());
             connected_ = false;
             return false;
         }
@@ -187,25 +223,34 @@ bool UTCConnection::receive_data(void* data, size_t size) {
 }
 
 bool UTCConnection::is_client_allowed() const {
-    if (!config_) {
+    if (!has_address_restrictions(config_)) {
+        return true;
+    }
+    return is_address_allowed(config_, get_client_address());
+}
+
+bool UTCConnection::is_address_allowed(const UTCConfig* config, const std::string& address) {
+    if (!config) {
         return true; // No restrictions if no config
     }
 
     // Check if client is in denied list
-    if (is_client_denied()) {
-        return false;
+    for (const auto& denied : config->get_denied_clients()) {
+        if (address == denied) {
+            return false;
+        }
     }
 
     // If query restriction is enabled, check allowed list
-    if (config_->is_query_restriction_enabled()) {
-        const auto& allowed_clients = config_->get_allowed_clients();
+    if (config->is_query_restriction_enabled()) {
+        const auto& allowed_clients = config->get_allowed_clients();
         if (allowed_clients.empty()) {
             return true; // No restrictions if list is empty
         }
 
         // Check if client is in allowed list
         for (const auto& allowed : allowed_clients) {
-            if (client_address_ == allowed) {
+            if (address == allowed) {
                 return true;
             }
         }
@@ -216,24 +261,12 @@ bool UTCConnection::is_client_allowed() const {
     return true; // No restrictions
 }
 
-bool UTCConnection::is_client_denied() const {
-    if (!config_) {
-        return false; // No restrictions if no config
-    }
-
-    const auto& denied_clients = config_->get_denied_clients();
-    if (denied_clients.empty()) {
-        return false; // No restrictions if list is empty
-    }
-
-    // Check if client is in denied list
-    for (const auto& denied : denied_clients) {
-        if (client_address_ == denied) {
-            return true;
-        }
+bool UTCConnection::has_address_restrictions(const UTCConfig* config) {
+    if (!config) {
+        return false;
     }
-
-    return false; // Not in denied list
+    return !config->get_denied_clients().empty() ||
+           (config->is_query_restriction_enabled() && !config->get_allowed_clients().empty());
 }
 
 } // namespace simple_utcd
@@ -18,6 +18,7 @@
 
 #include "simple_utcd/utc_packet.hpp"
 #include "simple_utcd/error_handler.hpp"
+#include "simple_utcd/time_source.hpp"
 #include <chrono>
 #include <ctime>
 #include <sstream>
@@ -89,24 +90,28 @@ bool UTCPacket::from_bytes(const std::vector<uint8_t>& data) {
 
 std::vector<uint8_t> UTCPacket::to_bytes() const {
     std::vector<uint8_t> data(get_packet_size());
+    encode_timestamp(timestamp_, data.data());
+    return data;
+}
 
+void UTCPacket::encode_timestamp(uint32_t timestamp, uint8_t* out) {
     // Convert timestamp to network byte order (big-endian)
-    data[0] = static_cast<uint8_t>((timestamp_ >> 24) & 0xFF);
-    data[1] = static_cast<uint8_t>((timestamp_ >> 16) & 0xFF);
-    data[2] = static_cast<uint8_t>((timestamp_ >> 8) & 0xFF);
-    data[3] = static_cast<uint8_t>(timestamp_ & 0xFF);
-
-    return data;
+    out[0] = static_cast<uint8_t>((timestamp >> 24) & 0xFF);
+    out[1] = static_cast<uint8_t>((timestamp >> 16) & 0xFF);
+    out[2] = static_cast<uint8_t>((timestamp >> 8) & 0xFF);
+    out[3] = static_cast<uint8_t>(timestamp & 0xFF);
 }
 
 uint32_t UTCPacket::get_current_utc_timestamp() {
-    auto now = std::chrono::system_clock::now();
+    // Precise read: a coarse clock can still show the previous second
+    // just after the boundary the time publisher wakes on
+    auto now = TimeSource::current().now();
     auto time_t = std::chrono::system_clock::to_time_t(now);
     return static_cast<uint32_t>(time_t);
 }
 
 std::pair<uint32_t, uint32_t> UTCPacket::get_current_utc_timestamp_with_microseconds() {
-    auto now = std::chrono::system_clock::now();
+    auto now = TimeSource::current().now();
     auto time_t = std::chrono::system_clock::to_time_t(now);
     auto timestamp_sec = static_cast<uint32_t>(time_t);
     
@@ -200,7 +205,7 @@ bool UTCPacket::validate_timestamp(uint32_t timestamp) const {
     }
 
     // Check if timestamp is not too far in the future (e.g., 100 years from now)
-    auto now = std::chrono::system_clock::now();
+    auto now = TimeSource::current().coarse_now();
     auto now_time_t = std::chrono::system_clock::to_time_t(now);
     uint32_t current_timestamp = static_cast<uint32_t>(now_time_t);
 
@@ -24,6 +24,8 @@
 #include "simple_utcd/metrics.hpp"
 #include "simple_utcd/health_check.hpp"
 #include "simple_utcd/async_io.hpp"
+#include "simple_utcd/datagram_batch.hpp"
+#include "simple_utcd/time_source.hpp"
 #include <mutex>
 #include <thread>
 #include <chrono>
@@ -33,6 +35,7 @@
 #include <arpa/inet.h>
 #include <unistd.h>
 #include <signal.h>
+#include <errno.h>
 #include <cstring>
 
 #ifdef _WIN32
@@ -47,19 +50,116 @@
 
 namespace simple_utcd {
 
+namespace {
+
+// Same clock as the kernel's software packet stamps
+int64_t wall_clock_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// The virtual clock's timescale
+int64_t raw_clock_ns() {
+    return TimeSource::current().raw_now_ns();
+}
+
+uint64_t elapsed_ns(int64_t from, int64_t to) {
+    return to > from ? static_cast<uint64_t>(to - from) : 0;  // A clock step reads as zero
+}
+
+// How long an accept loop out of descriptors waits before trying again
+constexpr int kAcceptBackoffMs = 10;
+
+// What a failed accept() leaves for the loop to do
+enum class AcceptFailure {
+    RETRY,      // Only that connection was lost; the next may be fine
+    STARVED,    // Out of descriptors; the backlog stays queued
+    DRAINED     // Backlog empty, or a real error
+};
+
+AcceptFailure classify_accept_error(int error) {
+    if (error == EINTR || error == ECONNABORTED) {
+        return AcceptFailure::RETRY;
+    }
+    if (error == EMFILE || error == ENFILE) {
+        return AcceptFailure::STARVED;
+    }
+    return AcceptFailure::DRAINED;
+}
+
+} // namespace
+
+UTCServer::Worker::Worker(size_t queue_depth, size_t pool_capacity)
+    : connection_pool(pool_capacity)
+    , inbox(queue_depth)
+    , inbox_depth(queue_depth)
+{
+}
+
 UTCServer::UTCServer(UTCConfig* config, Logger* logger)
     : config_(config)
     , logger_(logger)
     , running_(false)
-    , active_connections_(0)
-    , total_connections_(0)
-    , packets_sent_(0)
-    , packets_received_(0)
+    , next_worker_(0)
     , server_socket_(-1)
+    , bound_port_(0)
+    , udp_bound_port_(0)
+    , ntp_bound_port_(0)
+    , reuseport_active_(false)
+    , io_uring_active_(false)
+    , fast_path_active_(false)
+    , cpu_steering_active_(false)
+    , busy_poll_warned_(false)
     , performance_metrics_(std::make_unique<PerformanceMetrics>())
     , health_checker_(std::make_unique<HealthChecker>())
     , async_io_manager_(std::make_unique<AsyncIOManager>(config ? config->get_worker_threads() : 4))
+    , time_publisher_(std::make_unique<TimePublisher>())
+    , admission_controller_(std::make_unique<AdmissionController>())
+    , graceful_degradation_(std::make_unique<GracefulDegradation>())
+    , admission_control_active_(false)
+    , admission_state_seen_(0)
+    , rate_limiter_(std::make_unique<RateLimiter>())
+    , ddos_protection_(std::make_unique<DDoSProtection>())
+    , upstream_manager_(std::make_unique<UpstreamManager>())
+    , virtual_clock_(std::make_unique<VirtualClock>())
 {
+    upstream_sync_ = std::make_unique<UpstreamSync>(*upstream_manager_);
+
+    // Connection counts live in the per-thread blocks; the exporter sums them
+    performance_metrics_->set_connection_source([this](uint64_t& active, uint64_t& total) {
+        active = get_active_connections();
+        total = get_total_connections();
+    });
+    performance_metrics_->set_timestamp_delay_source([this](LatencyHistogram& rx_delay,
+                                                            LatencyHistogram& tx_delay) {
+        get_kernel_rx_delay(rx_delay);
+        get_kernel_tx_delay(tx_delay);
+    });
+    performance_metrics_->set_cpu_accept_source([this](std::map<int, uint64_t>& accepts,
+                                                       std::map<int, uint64_t>& local) {
+        get_cpu_accept_counts(accepts, local);
+    });
+    performance_metrics_->set_busy_poll_source([this](uint64_t& spin_ns, uint64_t& work_ns, uint64_t& sleeps) {
+        spin_ns = get_busy_poll_spin_ns();
+        work_ns = get_busy_poll_work_ns();
+        sleeps = get_busy_poll_sleeps();
+    });
+    performance_metrics_->set_upstream_latency_source([this](std::map<std::string, LatencySummary>& latencies) {
+        for (const auto& server : upstream_manager_->get_servers()) {
+            bool ipv6 = server.address.find(':') != std::string::npos;
+            std::string host = ipv6 ? "[" + server.address + "]" : server.address;
+            latencies[host + ":" + std::to_string(server.port)] = server.latency;
+        }
+    });
+    performance_metrics_->set_virtual_clock_source([this](VirtualClock::Stats& stats) {
+        if (!config_ || !config_->is_virtual_clock_enabled()) {
+            return false;
+        }
+        stats = virtual_clock_->get_stats();
+        return stats.synchronized;
+    });
+    time_publisher_->set_discipline(&discipline_);
+
     if (logger_) {
         logger_->info("UTC Server initialized");
     }
@@ -91,27 +191,165 @@ bool UTCServer::start() {
         return false;
     }
 
-    // Create server socket
-    if (!create_server_socket()) {
+    configure_admission();
+
+    // The fast path has no per-connection state, so any feature that needs
+    // the peer address or a handshake keeps the full connection path. It
+    // also has no queue for admission control to measure.
+    fast_path_active_ = config_->is_fast_path_enabled() &&
+                        !config_->is_authentication_enabled() &&
+                        !admission_control_active_ &&
+                        !needs_client_address();
+
+    cpu_affinity_ = config_->get_cpu_affinity_list();
+    async_io_manager_->set_cpu_affinity(cpu_affinity_);
+    busy_poll_warned_ = false;
+
+    // Steering maps CPUs to workers, so every worker needs a CPU; without
+    // cpu_affinity they take the CPUs this process may run on in order
+    bool cpu_steering = config_->is_cpu_steering_enabled() && config_->is_so_reuseport_enabled();
+    if (cpu_steering && cpu_affinity_.empty() && !Platform::get_thread_affinity(cpu_affinity_)) {
+        cpu_affinity_.clear();
+    }
+
+    // NUMA placement: build each worker while running on its CPU so
+    // first-touch puts its queue and tables on that CPU's node. Worker
+    // threads allocate everything else after pinning themselves.
+    std::vector<int> original_cpus;
+    bool numa_placement = config_->is_numa_placement_enabled() && !cpu_affinity_.empty();
+    if (numa_placement && !Platform::get_thread_affinity(original_cpus)) {
+        if (logger_) {
+            logger_->warn("NUMA placement unavailable: {}", Platform::get_last_error());
+        }
+        numa_placement = false;
+    }
+
+    // Create worker reactors. Each admits and pools its share of
+    // max_connections, so the limit is checked without reading every
+    // other thread's counters; the pool spills over to the heap rather
+    // than failing.
+    int num_threads = config_->get_worker_threads();
+    size_t thread_count = static_cast<size_t>(num_threads > 0 ? num_threads : 1);
+    size_t max_connections = static_cast<size_t>(config_->get_max_connections());
+    size_t pool_capacity = max_connections / thread_count + 1;
+    size_t connection_budget = (max_connections + thread_count - 1) / thread_count;
+    bool workers_ready = true;
+    for (int i = 0; i < num_threads; ++i) {
+        int cpu = cpu_affinity_.empty() ? -1 : cpu_affinity_[i % cpu_affinity_.size()];
+        if (numa_placement) {
+            Platform::set_thread_affinity({cpu});
+        }
+
+        auto worker = std::make_unique<Worker>(config_->get_handoff_queue_depth(), pool_capacity);
+        worker->index = static_cast<size_t>(i);
+        worker->cpu = cpu;
+        worker->connection_budget = connection_budget;
+        if (!worker->loop.open()) {
+            UTC_ERROR("UTCServer", "Failed to create worker event loop");
+            workers_ready = false;
+            break;
+        }
+        std::lock_guard<std::mutex> lock(threads_mutex_);
+        workers_.push_back(std::move(worker));
+    }
+
+    if (numa_placement) {
+        Platform::set_thread_affinity(original_cpus);
+    }
+    if (!workers_ready) {
+        retire_workers();
+        return false;
+    }
+
+    // Sharded listeners when requested, otherwise one shared acceptor
+    reuseport_active_ = config_->is_so_reuseport_enabled() && create_shard_listeners();
+    cpu_steering_active_ = reuseport_active_ && cpu_steering && !cpu_affinity_.empty() &&
+                           steer_reuseport_group(workers_.front()->listen_fd, workers_.size());
+
+    // With io_uring every worker's ring accepts for itself
+    io_uring_active_ = config_->is_io_uring_enabled() && open_rings();
+
+    if (!reuseport_active_) {
+        if (!create_server_socket()) {
+            retire_workers();
+            return false;
+        }
+    }
+
+    // No acceptor thread backs the rings up: a worker that cannot accept
+    // would leave the server running but deaf
+    if (io_uring_active_ && !arm_ring_accepts()) {
+        close_server_socket();
+        for (auto& worker : workers_) {
+            if (worker->listen_fd >= 0) {
+                Platform::close_socket(worker->listen_fd);
+            }
+        }
+        retire_workers();
+        return false;
+    }
+
+    if (!reuseport_active_ && !io_uring_active_) {
+        if (!accept_loop_.open() ||
+            !accept_loop_.add(server_socket_, EVENT_READ, &accept_loop_)) {
+            UTC_ERROR("UTCServer", "Failed to create accept event loop");
+            accept_loop_.close();
+            close_server_socket();
+            retire_workers();
+            return false;
+        }
+    }
+
+    // UDP joins the port TCP resolved so both answer on the same number
+    bool datagrams_ready = !config_->is_udp_enabled() ||
+                           create_datagram_shards(DatagramProtocol::TIME, bound_port_, udp_bound_port_);
+    if (datagrams_ready && config_->is_ntp_enabled()) {
+        ntp_responder_.configure(config_->get_stratum(), config_->get_reference_id(),
+                                 NtpResponder::measure_precision());
+        datagrams_ready = create_datagram_shards(DatagramProtocol::NTP, config_->get_ntp_port(),
+                                                 ntp_bound_port_);
+    }
+    if (!datagrams_ready) {
+        accept_loop_.close();
+        close_server_socket();
+        for (auto& worker : workers_) {
+            if (worker->listen_fd >= 0) {
+                Platform::close_socket(worker->listen_fd);
+            }
+        }
+        retire_workers();
         return false;
     }
 
+    update_reference_time();
+    time_publisher_->start();
     running_ = true;
 
+    if (configure_upstreams()) {
+        sync_thread_ = std::thread(&UTCServer::sync_thread_main, this);
+    }
+
     if (logger_) {
         logger_->info("Starting UTC Server on {}:{}",
                      config_->get_listen_address(), config_->get_listen_port());
     }
 
-    // Start worker threads
-    int num_threads = config_->get_worker_threads();
-    for (int i = 0; i < num_threads; ++i) {
-        worker_threads_.emplace_back(&UTCServer::worker_thread_main, this);
+    for (auto& worker : workers_) {
+        if (io_uring_active_) {
+            worker->thread = std::thread(&UTCServer::ring_worker_main, this, worker.get());
+        } else {
+            worker->thread = std::thread(&UTCServer::worker_thread_main, this, worker.get());
+        }
     }
 
     // Start accepting connections
-    std::thread accept_thread(&UTCServer::accept_connections, this);
-    accept_thread.detach();
+    if (!reuseport_active_ && !io_uring_active_) {
+        accept_thread_ = std::thread(&UTCServer::accept_connections, this);
+    }
+
+    for (auto& shard : udp_shards_) {
+        shard->thread = std::thread(&UTCServer::udp_thread_main, this, shard.get());
+    }
 
     if (logger_) {
         logger_->info("UTC Server started successfully with {} worker threads", num_threads);
@@ -131,27 +369,52 @@ void UTCServer::stop() {
 
     running_ = false;
 
+    {
+        std::lock_guard<std::mutex> lock(sync_mutex_);
+        sync_cv_.notify_all();
+    }
+    if (sync_thread_.joinable()) {
+        sync_thread_.join();
+    }
+
+    // Wake the acceptor and every worker out of their waits
+    if (accept_loop_.is_open()) {
+        accept_loop_.wakeup();
+    }
+    if (accept_thread_.joinable()) {
+        accept_thread_.join();
+    }
+    accept_loop_.close();
+
     // Close server socket
     close_server_socket();
 
-    // Close all connections
-    {
-        std::lock_guard<std::mutex> lock(connections_mutex_);
-        for (auto& connection : connections_) {
-            if (connection) {
-                connection->close_connection();
-            }
+    // Workers close the connections they own on the way out
+    for (auto& worker : workers_) {
+        if (worker->ring.is_open()) {
+            worker->ring.wakeup();
+        }
+        worker->loop.wakeup();
+    }
+    for (auto& worker : workers_) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
         }
-        connections_.clear();
     }
+    retire_workers();
+    io_uring_active_ = false;
+    fast_path_active_ = false;
 
-    // Wait for worker threads to finish
-    for (auto& thread : worker_threads_) {
-        if (thread.joinable()) {
-            thread.join();
+    for (auto& shard : udp_shards_) {
+        shard->loop.wakeup();
+    }
+    for (auto& shard : udp_shards_) {
+        if (shard->thread.joinable()) {
+            shard->thread.join();
         }
     }
-    worker_threads_.clear();
+    close_udp_sockets();
+    time_publisher_->stop();
 
     if (logger_) {
         logger_->info("UTC Server stopped");
@@ -159,55 +422,252 @@ void UTCServer::stop() {
 }
 
 void UTCServer::accept_connections() {
-    while (running_) {
-        std::string client_address;
-        int client_fd = Platform::accept_connection(server_socket_, client_address);
+    IOEvent events[4];
+    const std::string thread_name = "acceptor";
+    int last_cpu = -1;
 
-        if (client_fd < 0) {
+    // The shared acceptor may run anywhere in the configured set
+    if (!cpu_affinity_.empty() && !Platform::set_thread_affinity(cpu_affinity_) && logger_) {
+        logger_->warn("Failed to set acceptor CPU affinity: {}", Platform::get_last_error());
+    }
+
+    BusyPoller poller(config_->is_busy_poll_enabled(),
+                      std::chrono::microseconds(config_->get_busy_poll_idle_us()), acceptor_stats_);
+
+    bool starved = false;
+    while (running_) {
+        int count = accept_loop_.wait(events, 4, starved ? kAcceptBackoffMs : poller.next_timeout());
+        if (count < 0) {
             if (running_) {
-                UTC_ERROR("UTCServer", "Failed to accept connection: " + Platform::get_last_error());
+                UTC_ERROR("UTCServer", "Accept event loop failed: " + std::string(strerror(errno)));
+            }
+            break;
+        }
+        poller.woke(count);
+        if (count == 0) {
+            // The listener will not fire again for a backlog it already reported
+            if (starved) {
+                accept_pending(server_socket_, nullptr, starved);
             }
             continue;
         }
 
-        // Check connection limit
-        if (active_connections_ >= config_->get_max_connections()) {
-            if (logger_) {
-                logger_->warn("Connection limit reached, rejecting connection from {}", client_address);
+        report_thread_cpu(thread_name, last_cpu);
+
+        accept_pending(server_socket_, nullptr, starved);
+        poller.handled(count);
+    }
+}
+
+void UTCServer::accept_pending(int listen_fd, Worker* shard, bool& starved) {
+    bool was_starved = starved;
+    starved = fast_path_active_ ? serve_fast_path(listen_fd, shard) : accept_backlog(listen_fd, shard);
+
+    // Once per episode: the loop retries every kAcceptBackoffMs until
+    // connections close and free descriptors
+    if (starved && !was_starved && logger_) {
+        logger_->warn("Out of file descriptors, retrying accept in {} ms: {}",
+                      kAcceptBackoffMs, Platform::get_last_error());
+    }
+}
+
+bool UTCServer::accept_backlog(int listen_fd, Worker* shard) {
+    // Edge-triggered: drain the whole backlog before waiting again. The
+    // peer address stays binary; it is only formatted if something needs it.
+    struct sockaddr_storage peer;
+    bool starved = false;
+    while (running_) {
+        int client_fd = Platform::accept_socket(listen_fd, &peer);
+
+        if (client_fd < 0) {
+            int error = errno;
+            AcceptFailure failure = classify_accept_error(error);
+            if (failure == AcceptFailure::RETRY) {
+                continue;
             }
-            Platform::close_socket(client_fd);
+            starved = failure == AcceptFailure::STARVED;
+            if (!starved && error != EAGAIN && error != EWOULDBLOCK) {
+                UTC_ERROR("UTCServer", "Failed to accept connection: " + Platform::get_last_error());
+            }
+            break;
+        }
+
+        // Round-robin across workers; only the accept thread touches next_worker_
+        Worker& worker = shard ? *shard : *workers_[next_worker_ % workers_.size()];
+        auto connection = admit_connection(client_fd, peer, worker, thread_stats(shard));
+        if (!connection) {
             continue;
         }
 
-        // Create connection object
-        auto connection = std::make_unique<UTCConnection>(client_fd, client_address, config_, logger_);
+        if (shard) {
+            // Accepted on this worker's own listener; no hand-off needed
+            count_shard_accept(*shard, client_fd);
+            register_connection(*shard, std::move(connection));
+        } else {
+            next_worker_++;
+            dispatch_connection(worker, std::move(connection));
+        }
+    }
+
+    if (!shard) {
+        flush_wakeups();
+    }
+    return starved;
+}
+
+bool UTCServer::serve_fast_path(int listen_fd, Worker* shard) {
+#ifdef MSG_NOSIGNAL
+    const int flags = MSG_NOSIGNAL | MSG_DONTWAIT;  // A vanished client must not raise SIGPIPE
+#else
+    const int flags = 0;
+#endif
+
+    // No connection object, peer address or log line: the reply is written
+    // and the socket closed before the next accept. Nothing here allocates.
+    StatsBlock& stats = thread_stats(shard);
+    while (running_) {
+        int client_fd = Platform::accept_socket(listen_fd);
+        if (client_fd < 0) {
+            int error = errno;
+            AcceptFailure failure = classify_accept_error(error);
+            if (failure == AcceptFailure::RETRY) {
+                continue;
+            }
+            if (failure == AcceptFailure::STARVED) {
+                return true;
+            }
+            if (error != EAGAIN && error != EWOULDBLOCK) {
+                UTC_ERROR("UTCServer", "Failed to accept connection: " + Platform::get_last_error());
+            }
+            break;
+        }
 
-        // Add to connections list
-        {
-            std::lock_guard<std::mutex> lock(connections_mutex_);
-            connections_.push_back(std::move(connection));
+        // Count the connection before the client can see the reply. It is
+        // over by the time this loop iteration ends.
+        StatsBlock::add(stats.connections_opened);
+        StatsBlock::add(stats.connections_closed);
+        if (shard) {
+            count_shard_accept(*shard, client_fd);
         }
 
-        active_connections_++;
-        total_connections_++;
-        
-        // Update metrics
+        auto start_time = std::chrono::steady_clock::now();
         if (performance_metrics_) {
-            performance_metrics_->update_total_connections(total_connections_.load());
-            performance_metrics_->update_active_connections(active_connections_.load());
+            performance_metrics_->record_request();
+        }
+
+        uint8_t reply[4];
+        time_publisher_->encode_rfc868(reply);
+
+        // A fresh socket's send buffer always has room for 4 bytes
+        ssize_t sent = ::send(client_fd, reinterpret_cast<const char*>(reply), sizeof(reply), flags);
+        Platform::close_socket(client_fd);
+
+        if (sent == static_cast<ssize_t>(sizeof(reply))) {
+            StatsBlock::add(stats.packets_sent);
+            if (performance_metrics_) {
+                auto duration = std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - start_time);
+                performance_metrics_->record_response(static_cast<uint64_t>(duration.count()));
+            }
+        } else if (performance_metrics_) {
+            performance_metrics_->record_error();
         }
+    }
+    return false;
+}
 
+UTCServer::ConnectionPtr UTCServer::admit_connection(int client_fd, const struct sockaddr_storage& peer,
+                                                     Worker& owner, StatsBlock& stats) {
+    // Check the owner's share of the connection limit
+    uint64_t active = owner.open_connections.load(std::memory_order_relaxed);
+    if (active >= owner.connection_budget) {
         if (logger_) {
-            logger_->debug("Accepted connection from {} (active: {})",
-                          client_address, active_connections_);
+            logger_->warn("Connection limit reached, rejecting connection from {}",
+                          Platform::address_to_string(peer));
+        }
+        Platform::close_socket(client_fd);
+        return nullptr;
+    }
+
+    if (needs_client_address()) {
+        std::string client_address = Platform::address_to_string(peer);
+        if (!admit_client(client_address)) {
+            if (logger_) {
+                logger_->warn("Connection from {} rejected by admission checks", client_address);
+            }
+            Platform::close_socket(client_fd);
+            return nullptr;
         }
     }
+
+    StatsBlock::add(stats.connections_opened);
+    owner.open_connections.fetch_add(1, std::memory_order_relaxed);
+
+    if (logger_ && logger_->is_enabled(LogLevel::DEBUG)) {
+        logger_->debug("Accepted connection from {} (active: {})",
+                      Platform::address_to_string(peer), active + 1);
+    }
+
+    // Drawn from the pool of the worker that will own it
+    return owner.connection_pool.acquire(client_fd, peer, config_, logger_);
 }
 
-void UTCServer::handle_connection(std::unique_ptr<UTCConnection> connection) {
-    if (!connection) {
+void UTCServer::dispatch_connection(Worker& worker, ConnectionPtr connection) {
+    // The ring rounds its size up to a power of two, so the configured
+    // depth is checked here. Only this thread pushes, so size_approx()
+    // can overcount but never undercount: the bound holds exactly.
+    if (worker.inbox.size_approx() >= worker.inbox_depth || !worker.inbox.try_push(std::move(connection))) {
+        // Worker is backed up; shed the connection rather than queue it
+        StatsBlock::add(acceptor_stats_.handoff_rejections);
+        if (logger_) {
+            logger_->warn("Hand-off queue full, rejecting connection from {}",
+                          connection->get_client_address());
+        }
+        connection->close_connection();
+        StatsBlock::add(acceptor_stats_.connections_closed);
+        worker.open_connections.fetch_sub(1, std::memory_order_relaxed);
         return;
     }
+    worker.accepted++;
+
+    // Wake each worker once per batch rather than once per connection;
+    // accept_backlog() flushes the remainder when the backlog is drained
+    if (++worker.pending_wakeups >= kWakeupBatch) {
+        worker.pending_wakeups = 0;
+        worker.loop.wakeup();
+    }
+}
+
+void UTCServer::flush_wakeups() {
+    for (auto& worker : workers_) {
+        if (worker->pending_wakeups > 0) {
+            worker->pending_wakeups = 0;
+            worker->loop.wakeup();
+        }
+    }
+}
+
+bool UTCServer::handle_connection(Worker& worker, UTCConnection* connection, uint32_t events) {
+    if (!(events & EVENT_WRITE)) {
+        // Nothing to write yet; the peer going away ends the connection
+        return (events & EVENT_HANGUP) != 0;
+    }
+
+    // Finish a response that an earlier write left partially sent
+    if (connection->get_packets_sent() > 0) {
+        if (!connection->flush()) {
+            if (performance_metrics_) {
+                performance_metrics_->record_error();
+            }
+            return true;
+        }
+        return !connection->has_pending_data();
+    }
+
+    // Shed work that sat in the queue while the server is overloaded
+    if (admission_control_active_ && !admit_queued(connection->get_accepted_at())) {
+        return true;
+    }
 
     auto start_time = std::chrono::steady_clock::now();
     if (performance_metrics_) {
@@ -218,8 +678,8 @@ void UTCServer::handle_connection(std::unique_ptr<UTCConnection> connection) {
     UTCPacket packet(get_utc_timestamp());
 
     if (connection->send_packet(packet)) {
-        packets_sent_++;
-        
+        StatsBlock::add(worker.stats.packets_sent);
+
         // Record response time
         if (performance_metrics_) {
             auto end_time = std::chrono::steady_clock::now();
@@ -227,7 +687,7 @@ void UTCServer::handle_connection(std::unique_ptr<UTCConnection> connection) {
             performance_metrics_->record_response(static_cast<uint64_t>(duration.count()));
         }
 
-        if (logger_) {
+        if (logger_ && logger_->is_enabled(LogLevel::DEBUG)) {
             logger_->debug("Sent UTC time to {}: {}",
                           connection->get_client_address(), packet.to_string());
         }
@@ -238,112 +698,1036 @@ void UTCServer::handle_connection(std::unique_ptr<UTCConnection> connection) {
         if (logger_) {
             logger_->warn("Failed to send UTC time to {}", connection->get_client_address());
         }
+        return true;
     }
 
-    // Close connection after sending (UTC protocol is typically one-shot)
-    connection->close_connection();
+    // UTC protocol is one-shot: done once the reply is fully written
+    return !connection->has_pending_data();
+}
 
-    // Remove from connections list
-    {
-        std::lock_guard<std::mutex> lock(connections_mutex_);
-        auto it = std::find_if(connections_.begin(), connections_.end(),
-                              [&connection](const std::unique_ptr<UTCConnection>& conn) {
-                                  return conn.get() == connection.get();
-                              });
-        if (it != connections_.end()) {
-            connections_.erase(it);
-        }
-    }
+void UTCServer::worker_thread_main(Worker* worker) {
+    constexpr int kMaxEvents = 64;
+    IOEvent events[kMaxEvents];
+    const std::string thread_name = "worker-" + std::to_string(worker->index);
+    int last_cpu = -1;
 
-    active_connections_--;
-    if (performance_metrics_) {
-        performance_metrics_->update_active_connections(active_connections_.load());
-    }
-}
+    pin_thread(worker->cpu);
+    report_thread_cpu(thread_name, last_cpu);
+
+    // Size the connection table from this thread so its buckets are local
+    worker->connections.reserve(static_cast<size_t>(config_->get_max_connections()) / workers_.size() + 1);
 
-void UTCServer::worker_thread_main() {
+    BusyPoller poller(config_->is_busy_poll_enabled(),
+                      std::chrono::microseconds(config_->get_busy_poll_idle_us()), worker->stats);
+
+    bool starved = false;   // Only a shard's own listener can run out of descriptors
     while (running_) {
-        std::unique_ptr<UTCConnection> connection;
+        adopt_connections(*worker);
 
-        // Get next connection to handle
-        {
-            std::lock_guard<std::mutex> lock(connections_mutex_);
-            if (!connections_.empty()) {
-                connection = std::move(connections_.front());
-                connections_.erase(connections_.begin());
+        int count = worker->loop.wait(events, kMaxEvents, starved ? kAcceptBackoffMs : poller.next_timeout());
+        if (count < 0) {
+            UTC_ERROR("UTCServer", "Worker event loop failed: " + std::string(strerror(errno)));
+            break;
+        }
+        poller.woke(count);
+        if (count == 0) {
+            if (starved) {
+                accept_pending(worker->listen_fd, worker, starved);
             }
+            continue;
         }
 
-        if (connection) {
-            handle_connection(std::move(connection));
-        } else {
-            // No connections to handle, sleep briefly
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        report_thread_cpu(thread_name, last_cpu);
+
+        for (int i = 0; i < count; ++i) {
+            if (events[i].data == worker) {
+                accept_pending(worker->listen_fd, worker, starved);
+                continue;
+            }
+
+            auto* connection = static_cast<UTCConnection*>(events[i].data);
+            if (handle_connection(*worker, connection, events[i].events)) {
+                release_connection(*worker, connection);
+            }
         }
+        poller.handled(count);
+    }
+
+    // Close everything this worker still owns
+    if (worker->listen_fd >= 0) {
+        worker->loop.remove(worker->listen_fd);
+        Platform::close_socket(worker->listen_fd);
+        worker->listen_fd = -1;
+    }
+    adopt_connections(*worker);
+    while (!worker->connections.empty()) {
+        release_connection(*worker, worker->connections.begin()->first);
     }
 }
 
-bool UTCServer::create_server_socket() {
-    // Create socket
-    server_socket_ = Platform::create_socket(AF_INET, SOCK_STREAM, 0);
-    if (server_socket_ < 0) {
-        UTC_ERROR("UTCServer", "Failed to create server socket: " + Platform::get_last_error());
-        return false;
+void UTCServer::adopt_connections(Worker& worker) {
+    ConnectionPtr connection;
+    while (worker.inbox.try_pop(connection)) {
+        register_connection(worker, std::move(connection));
+    }
+}
+
+void UTCServer::register_connection(Worker& worker, ConnectionPtr connection) {
+    UTCConnection* raw = connection.get();
+    worker.connections.emplace(raw, std::move(connection));
+
+    // A fresh socket is writable at once, so the edge fires immediately
+    if (!worker.loop.add(raw->get_socket_fd(), EVENT_READ | EVENT_WRITE, raw)) {
+        UTC_ERROR("UTCServer", "Failed to register connection: " + std::string(strerror(errno)));
+        release_connection(worker, raw);
     }
+}
 
-    // Set socket options
-    int reuse = 1;
-    if (!Platform::set_socket_option(server_socket_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse))) {
+void UTCServer::release_connection(Worker& worker, UTCConnection* connection) {
+    auto it = worker.connections.find(connection);
+    if (it == worker.connections.end()) {
+        return;
+    }
+
+    worker.loop.remove(connection->get_socket_fd());
+    connection->close_connection();
+    worker.connections.erase(it);
+    StatsBlock::add(worker.stats.connections_closed);
+    worker.open_connections.fetch_sub(1, std::memory_order_relaxed);
+}
+
+bool UTCServer::open_rings() {
+    if (!IoUringLoop::is_available()) {
         if (logger_) {
-            logger_->warn("Failed to set SO_REUSEADDR: {}", Platform::get_last_error());
+            logger_->warn("io_uring unavailable, using the epoll event loop");
         }
+        return false;
     }
-
-    // Bind socket
-    if (!Platform::bind_socket(server_socket_, config_->get_listen_address(), config_->get_listen_port())) {
-        UTC_ERROR("UTCServer", "Failed to bind socket: " + Platform::get_last_error());
-        Platform::close_socket(server_socket_);
-        server_socket_ = -1;
+    // Before 5.19 the kernel has the opcodes but rejects multishot accept
+    if (!IoUringLoop::supports_multishot_accept()) {
+        if (logger_) {
+            logger_->warn("io_uring multishot accept unsupported by this kernel, using the epoll event loop");
+        }
         return false;
     }
 
-    // Listen for connections
-    if (!Platform::listen_socket(server_socket_, config_->get_max_connections())) {
-        UTC_ERROR("UTCServer", "Failed to listen on socket: " + Platform::get_last_error());
-        Platform::close_socket(server_socket_);
-        server_socket_ = -1;
-        return false;
+    // Two entries per reply (send + close); the ring is flushed every wait
+    constexpr unsigned kRingEntries = 1024;
+    for (auto& worker : workers_) {
+        if (!worker->ring.open(kRingEntries)) {
+            for (auto& opened : workers_) {
+                opened->ring.close();
+            }
+            if (logger_) {
+                logger_->warn("Failed to set up io_uring, using the epoll event loop");
+            }
+            return false;
+        }
     }
 
+    if (logger_) {
+        logger_->info("Using io_uring accept/send/close on {} workers", workers_.size());
+    }
     return true;
 }
 
-void UTCServer::close_server_socket() {
-    if (server_socket_ >= 0) {
-        Platform::close_socket(server_socket_);
-        server_socket_ = -1;
+bool UTCServer::arm_ring_accepts() {
+    // Queued from here, before the workers start, and submitted by each
+    // worker's first wait(). Shards accept on their own listener;
+    // otherwise the rings share one.
+    for (auto& worker : workers_) {
+        int listen_fd = worker->listen_fd >= 0 ? worker->listen_fd : server_socket_;
+        if (listen_fd < 0 || !worker->ring.accept(listen_fd)) {
+            UTC_ERROR("UTCServer", "Failed to queue io_uring accept");
+            return false;
+        }
     }
+    return true;
 }
 
-uint32_t UTCServer::get_utc_timestamp() {
-    return UTCPacket::get_current_utc_timestamp();
+void UTCServer::ring_worker_main(Worker* worker) {
+    constexpr int kMaxCompletions = 64;
+    UringCompletion completions[kMaxCompletions];
+    const std::string thread_name = "worker-" + std::to_string(worker->index);
+    int last_cpu = -1;
+
+    pin_thread(worker->cpu);
+    report_thread_cpu(thread_name, last_cpu);
+
+    // Reply slots are allocated here, after pinning, so they are node-local
+    size_t slots = static_cast<size_t>(config_->get_max_connections());
+    worker->reply_slots.resize(slots);
+    worker->free_slots.clear();
+    for (size_t i = slots; i > 0; --i) {
+        worker->free_slots.push_back(static_cast<uint32_t>(i - 1));
+    }
+
+    // Accept was armed by start(); completions re-arm it
+    int listen_fd = worker->listen_fd >= 0 ? worker->listen_fd : server_socket_;
+
+    while (running_) {
+        int count = worker->ring.wait(completions, kMaxCompletions, -1);
+        if (count < 0) {
+            UTC_ERROR("UTCServer", "Worker io_uring wait failed: " + std::string(strerror(errno)));
+            break;
+        }
+
+        report_thread_cpu(thread_name, last_cpu);
+
+        for (int i = 0; i < count; ++i) {
+            handle_ring_completion(*worker, completions[i], listen_fd);
+        }
+    }
+
+    // Let replies already in flight finish so their sockets get closed
+    while (worker->free_slots.size() < worker->reply_slots.size()) {
+        int count = worker->ring.wait(completions, kMaxCompletions, 1000);
+        if (count <= 0) {
+            break;
+        }
+        for (int i = 0; i < count; ++i) {
+            handle_ring_completion(*worker, completions[i], listen_fd);
+        }
+    }
+    worker->ring.close();
+
+    if (worker->listen_fd >= 0) {
+        worker->loop.remove(worker->listen_fd);
+        Platform::close_socket(worker->listen_fd);
+        worker->listen_fd = -1;
+    }
 }
 
-void UTCServer::update_reference_time() {
-    // Version 0.1.0: Basic implementation using system time
-    // This provides functional UTC time service using the local system clock.
-    // 
-    // Future versions (0.2.0+) will add:
-    // - Upstream NTP server synchronization
-    // - Time offset calculation and drift compensation
-    // - Multiple upstream server support with failover
-    // - Stratum management and reference clock support
-    //
-    // For now, the system time is sufficient for basic UTC daemon functionality.
-    // The system clock should be synchronized via the OS's time service (ntpd, systemd-timesyncd, etc.)
-    
-    if (logger_) {
-        logger_->debug("Reference time updated (using system time)");
+void UTCServer::handle_ring_completion(Worker& worker, const UringCompletion& completion, int listen_fd) {
+    switch (completion.op) {
+    case UringOp::ACCEPT:
+        if (completion.result >= 0) {
+            if (running_) {
+                serve_ring_connection(worker, completion.result);
+            } else {
+                Platform::close_socket(completion.result);
+            }
+        } else if (completion.result == -EINVAL) {
+            if (!worker.ring.is_multishot()) {
+                // Even single-shot accept is refused; re-arming would spin
+                UTC_ERROR("UTCServer", "io_uring accept rejected, worker " + std::to_string(worker.index) +
+                          " stops accepting");
+                return;
+            }
+            // Multishot refused after all: re-arm one accept at a time
+            if (logger_) {
+                logger_->warn("io_uring multishot accept rejected, falling back to single-shot accept");
+            }
+            worker.ring.disable_multishot();
+        } else if (completion.result != -ECONNABORTED && completion.result != -EINTR &&
+                   completion.result != -ECANCELED) {
+            UTC_ERROR("UTCServer", "Failed to accept connection: " + std::string(strerror(-completion.result)));
+        }
+
+        // Single-shot accept always needs re-arming; multishot disarms
+        // itself on errors and CQ overflow
+        if (!completion.more && running_ && !worker.ring.accept(listen_fd)) {
+            UTC_ERROR("UTCServer", "Failed to re-arm io_uring accept");
+        }
+        break;
+
+    case UringOp::SEND: {
+        const auto& slot = worker.reply_slots[completion.tag];
+        if (completion.result == static_cast<int>(sizeof(slot.data))) {
+            StatsBlock::add(worker.stats.packets_sent);
+            if (performance_metrics_) {
+                auto duration = std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - slot.queued_at);
+                performance_metrics_->record_response(static_cast<uint64_t>(duration.count()));
+            }
+        } else if (performance_metrics_) {
+            performance_metrics_->record_error();
+        }
+        break;
+    }
+
+    case UringOp::CLOSE:
+        // The hard-linked close runs whatever the send did
+        worker.free_slots.push_back(completion.tag);
+        StatsBlock::add(worker.stats.connections_closed);
+        worker.open_connections.fetch_sub(1, std::memory_order_relaxed);
+        break;
+    }
+}
+
+void UTCServer::serve_ring_connection(Worker& worker, int client_fd) {
+    if (worker.open_connections.load(std::memory_order_relaxed) >= worker.connection_budget ||
+        worker.free_slots.empty()) {
+        if (logger_) {
+            logger_->warn("Connection limit reached, rejecting connection");
+        }
+        Platform::close_socket(client_fd);
+        return;
+    }
+
+    // Only resolve the peer address when an admission check could reject it
+    if (needs_client_address()) {
+        std::string client_address;
+        if (!Platform::get_peer_address(client_fd, client_address) ||
+            !admit_client(client_address)) {
+            if (logger_) {
+                logger_->warn("Connection from {} rejected by admission checks", client_address);
+            }
+            if (performance_metrics_) {
+                performance_metrics_->record_error();
+            }
+            Platform::close_socket(client_fd);
+            return;
+        }
+    }
+
+    uint32_t tag = worker.free_slots.back();
+    worker.free_slots.pop_back();
+
+    auto& slot = worker.reply_slots[tag];
+    slot.queued_at = std::chrono::steady_clock::now();
+    if (performance_metrics_) {
+        performance_metrics_->record_request();
+    }
+
+    time_publisher_->encode_rfc868(slot.data);
+
+    if (!worker.ring.send_and_close(client_fd, slot.data, sizeof(slot.data), tag)) {
+        UTC_ERROR("UTCServer", "io_uring submission queue full, dropping connection");
+        worker.free_slots.push_back(tag);
+        if (performance_metrics_) {
+            performance_metrics_->record_error();
+        }
+        Platform::close_socket(client_fd);
+        return;
+    }
+
+    StatsBlock::add(worker.stats.connections_opened);
+    worker.open_connections.fetch_add(1, std::memory_order_relaxed);
+    count_shard_accept(worker, client_fd);
+}
+
+int UTCServer::open_listener(int port, bool reuse_port) {
+    // Create socket
+    int listen_fd = Platform::create_socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd < 0) {
+        UTC_ERROR("UTCServer", "Failed to create server socket: " + Platform::get_last_error());
+        return -1;
+    }
+
+    // Set socket options
+    int reuse = 1;
+    if (!Platform::set_socket_option(listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse))) {
+        if (logger_) {
+            logger_->warn("Failed to set SO_REUSEADDR: {}", Platform::get_last_error());
+        }
+    }
+
+    if (reuse_port) {
+#ifdef SO_REUSEPORT
+        if (!Platform::set_socket_option(listen_fd, SOL_SOCKET, SO_REUSEPORT, &reuse, sizeof(reuse))) {
+            if (logger_) {
+                logger_->warn("Failed to set SO_REUSEPORT: {}", Platform::get_last_error());
+            }
+            Platform::close_socket(listen_fd);
+            return -1;
+        }
+#else
+        Platform::close_socket(listen_fd);
+        return -1;
+#endif
+    }
+
+    set_socket_busy_poll(listen_fd);
+
+    // Bind socket
+    if (!Platform::bind_socket(listen_fd, config_->get_listen_address(), port)) {
+        UTC_ERROR("UTCServer", "Failed to bind socket: " + Platform::get_last_error());
+        Platform::close_socket(listen_fd);
+        return -1;
+    }
+
+    // Listen for connections
+    if (!Platform::listen_socket(listen_fd, config_->get_max_connections())) {
+        UTC_ERROR("UTCServer", "Failed to listen on socket: " + Platform::get_last_error());
+        Platform::close_socket(listen_fd);
+        return -1;
+    }
+
+    // Accept loops drain the backlog until it would block
+    if (!Platform::set_non_blocking(listen_fd)) {
+        UTC_ERROR("UTCServer", "Failed to make server socket non-blocking: " + Platform::get_last_error());
+        Platform::close_socket(listen_fd);
+        return -1;
+    }
+
+    // Record the real port (listen_port = 0 binds an ephemeral one)
+    struct sockaddr_in bound_addr;
+    socklen_t bound_len = sizeof(bound_addr);
+    if (getsockname(listen_fd, reinterpret_cast<struct sockaddr*>(&bound_addr), &bound_len) == 0) {
+        bound_port_ = ntohs(bound_addr.sin_port);
+    }
+
+    return listen_fd;
+}
+
+bool UTCServer::create_server_socket() {
+    server_socket_ = open_listener(config_->get_listen_port(), false);
+    return server_socket_ >= 0;
+}
+
+bool UTCServer::create_shard_listeners() {
+    // Later shards join the port the first one bound (matters for port 0)
+    int port = config_->get_listen_port();
+    for (auto& worker : workers_) {
+        worker->listen_fd = open_listener(port, true);
+        if (worker->listen_fd < 0 ||
+            !worker->loop.add(worker->listen_fd, EVENT_READ, worker.get())) {
+            break;
+        }
+        port = bound_port_;
+    }
+
+    bool complete = std::all_of(workers_.begin(), workers_.end(),
+                                [](const std::unique_ptr<Worker>& w) { return w->listen_fd >= 0; });
+    if (complete) {
+        if (logger_) {
+            logger_->info("Using {} SO_REUSEPORT listener shards", workers_.size());
+        }
+        return true;
+    }
+
+    // Undo any partial setup and fall back to the single acceptor
+    for (auto& worker : workers_) {
+        if (worker->listen_fd >= 0) {
+            worker->loop.remove(worker->listen_fd);
+            Platform::close_socket(worker->listen_fd);
+            worker->listen_fd = -1;
+        }
+    }
+    if (logger_) {
+        logger_->warn("SO_REUSEPORT unavailable, falling back to a single acceptor");
+    }
+    return false;
+}
+
+bool UTCServer::steer_reuseport_group(int fd, size_t sockets) {
+    // Socket i of the group belongs to the thread pinned like worker i
+    std::vector<int> socket_cpus(sockets);
+    for (size_t i = 0; i < sockets; ++i) {
+        socket_cpus[i] = cpu_affinity_[i % cpu_affinity_.size()];
+    }
+
+    if (!Platform::attach_reuseport_cpu_steering(fd, socket_cpus)) {
+        if (logger_) {
+            logger_->warn("CPU steering unavailable: {}", Platform::get_last_error());
+        }
+        return false;
+    }
+    if (logger_) {
+        logger_->info("Steering {} SO_REUSEPORT sockets by receiving CPU", sockets);
+    }
+    return true;
+}
+
+void UTCServer::set_socket_busy_poll(int fd) {
+#ifdef SO_BUSY_POLL
+    int budget = config_->get_busy_poll_us();
+    if (!config_->is_busy_poll_enabled() || budget <= 0) {
+        return;
+    }
+    // Raising it above net.core.busy_read needs CAP_NET_ADMIN; spinning
+    // in userspace works either way
+    if (!Platform::set_socket_option(fd, SOL_SOCKET, SO_BUSY_POLL, &budget, sizeof(budget)) &&
+        !busy_poll_warned_ && logger_) {
+        busy_poll_warned_ = true;
+        logger_->warn("Failed to set SO_BUSY_POLL: {}", Platform::get_last_error());
+    }
+#else
+    (void)fd;
+#endif
+}
+
+void UTCServer::count_shard_accept(Worker& shard, int client_fd) {
+    shard.accepted++;
+    if (cpu_steering_active_ && Platform::get_incoming_cpu(client_fd) == shard.cpu) {
+        shard.local_accepts++;
+    }
+}
+
+void UTCServer::get_cpu_accept_counts(std::map<int, uint64_t>& accepts, std::map<int, uint64_t>& local) const {
+    std::lock_guard<std::mutex> lock(threads_mutex_);
+    for (const auto& worker : workers_) {
+        if (worker->cpu >= 0) {
+            accepts[worker->cpu] += worker->accepted.load();
+            local[worker->cpu] += worker->local_accepts.load();
+        }
+    }
+}
+
+std::vector<uint64_t> UTCServer::get_shard_accept_counts() const {
+    std::lock_guard<std::mutex> lock(threads_mutex_);
+    std::vector<uint64_t> counts;
+    counts.reserve(workers_.size());
+    for (const auto& worker : workers_) {
+        counts.push_back(worker->accepted.load());
+    }
+    return counts;
+}
+
+uint64_t UTCServer::sum_stats(StatsBlock::Counter StatsBlock::*counter) const {
+    std::lock_guard<std::mutex> lock(threads_mutex_);
+    uint64_t total = StatsBlock::read(acceptor_stats_.*counter) + StatsBlock::read(retired_stats_.*counter);
+    for (const auto& worker : workers_) {
+        total += StatsBlock::read(worker->stats.*counter);
+    }
+    for (const auto& shard : udp_shards_) {
+        total += StatsBlock::read(shard->stats.*counter);
+    }
+    return total;
+}
+
+void UTCServer::sum_histogram(LatencyHistogram StatsBlock::*histogram, LatencyHistogram& into) const {
+    std::lock_guard<std::mutex> lock(threads_mutex_);
+    into.absorb(retired_stats_.*histogram);
+    for (const auto& shard : udp_shards_) {
+        into.absorb(shard->stats.*histogram);
+    }
+}
+
+uint64_t UTCServer::get_active_connections() const {
+    // Closes first: every close read has its open visible to the next sum
+    uint64_t closed = sum_stats(&StatsBlock::connections_closed);
+    uint64_t opened = sum_stats(&StatsBlock::connections_opened);
+    return opened > closed ? opened - closed : 0;
+}
+
+uint64_t UTCServer::get_connection_pool_fallbacks() const {
+    std::lock_guard<std::mutex> lock(threads_mutex_);
+    uint64_t fallbacks = 0;
+    for (const auto& worker : workers_) {
+        fallbacks += worker->connection_pool.get_heap_fallbacks();
+    }
+    return fallbacks;
+}
+
+void UTCServer::close_server_socket() {
+    if (server_socket_ >= 0) {
+        Platform::close_socket(server_socket_);
+        server_socket_ = -1;
+    }
+}
+
+int UTCServer::open_datagram_socket(int port, bool reuse_port, int& bound_port,
+                                    DatagramBatch::Timestamping& timestamping) {
+    int fd = Platform::create_socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        UTC_ERROR("UTCServer", "Failed to create UDP socket: " + Platform::get_last_error());
+        return -1;
+    }
+
+    int reuse = 1;
+    Platform::set_socket_option(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+#ifdef SO_REUSEPORT
+    if (reuse_port &&
+        !Platform::set_socket_option(fd, SOL_SOCKET, SO_REUSEPORT, &reuse, sizeof(reuse))) {
+        UTC_ERROR("UTCServer", "Failed to set SO_REUSEPORT on UDP socket: " + Platform::get_last_error());
+        Platform::close_socket(fd);
+        return -1;
+    }
+#endif
+
+    set_socket_busy_poll(fd);
+
+    // Before bind, so the first datagram is already stamped
+    if (config_->is_kernel_timestamps_enabled()) {
+        timestamping = DatagramBatch::enable_timestamping(fd);
+        if (timestamping == DatagramBatch::Timestamping::NONE && logger_) {
+            logger_->warn("Kernel packet timestamps unavailable; stamping in userspace");
+        }
+    }
+
+    if (!Platform::bind_socket(fd, config_->get_listen_address(), port)) {
+        UTC_ERROR("UTCServer", "Failed to bind UDP socket: " + Platform::get_last_error());
+        Platform::close_socket(fd);
+        return -1;
+    }
+
+    if (!Platform::set_non_blocking(fd)) {
+        UTC_ERROR("UTCServer", "Failed to make UDP socket non-blocking: " + Platform::get_last_error());
+        Platform::close_socket(fd);
+        return -1;
+    }
+
+    struct sockaddr_in bound_addr;
+    socklen_t bound_len = sizeof(bound_addr);
+    if (getsockname(fd, reinterpret_cast<struct sockaddr*>(&bound_addr), &bound_len) == 0) {
+        bound_port = ntohs(bound_addr.sin_port);
+    }
+
+    return fd;
+}
+
+bool UTCServer::create_datagram_shards(DatagramProtocol protocol, int port, int& bound_port) {
+    // Same sharding as TCP: the kernel spreads datagrams across shards
+    size_t shards = reuseport_active_ ? workers_.size() : 1;
+    for (size_t i = 0; i < shards; ++i) {
+        auto shard = std::make_unique<UdpShard>();
+        shard->protocol = protocol;
+        shard->index = i;
+        shard->cpu = cpu_affinity_.empty() ? -1 : cpu_affinity_[i % cpu_affinity_.size()];
+        shard->fd = open_datagram_socket(port, shards > 1, bound_port, shard->timestamping);
+        if (shard->fd < 0 || !shard->loop.open() ||
+            !shard->loop.add(shard->fd, EVENT_READ, shard.get())) {
+            if (shard->fd >= 0) {
+                Platform::close_socket(shard->fd);
+            }
+            close_udp_sockets();
+            return false;
+        }
+        port = bound_port;
+        std::lock_guard<std::mutex> lock(threads_mutex_);
+        udp_shards_.push_back(std::move(shard));
+    }
+
+    // Same CPU-to-shard mapping as the TCP listeners; unsteered otherwise
+    if (cpu_steering_active_ && shards > 1) {
+        steer_reuseport_group(udp_shards_[udp_shards_.size() - shards]->fd, shards);
+    }
+
+    if (logger_) {
+        if (protocol == DatagramProtocol::NTP) {
+            logger_->info("Serving NTPv4 on UDP port {} with {} shard(s)", bound_port, shards);
+        } else {
+            logger_->info("Serving RFC 868 over UDP on port {} with {} shard(s)", bound_port, shards);
+        }
+    }
+    return true;
+}
+
+void UTCServer::close_udp_sockets() {
+    for (auto& shard : udp_shards_) {
+        if (shard->fd >= 0) {
+            shard->loop.remove(shard->fd);
+            Platform::close_socket(shard->fd);
+            shard->fd = -1;
+        }
+    }
+    // Fold the blocks in and drop the shards in one step, so a concurrent
+    // sum neither misses nor double-counts them
+    std::lock_guard<std::mutex> lock(threads_mutex_);
+    for (auto& shard : udp_shards_) {
+        retired_stats_.absorb(shard->stats);
+    }
+    udp_shards_.clear();
+}
+
+void UTCServer::retire_workers() {
+    std::lock_guard<std::mutex> lock(threads_mutex_);
+    for (auto& worker : workers_) {
+        retired_stats_.absorb(worker->stats);
+    }
+    workers_.clear();
+}
+
+void UTCServer::udp_thread_main(UdpShard* shard) {
+    bool ntp = shard->protocol == DatagramProtocol::NTP;
+    const std::string thread_name = (ntp ? "ntp-" : "udp-") + std::to_string(shard->index);
+    int last_cpu = -1;
+
+    // Pin before allocating so the batch buffers land on the local node
+    pin_thread(shard->cpu);
+    report_thread_cpu(thread_name, last_cpu);
+
+    DatagramBatch batch(static_cast<size_t>(config_->get_udp_batch_size()));
+    batch.set_timestamping(shard->timestamping);
+    IOEvent events[4];
+    BusyPoller poller(config_->is_busy_poll_enabled(),
+                      std::chrono::microseconds(config_->get_busy_poll_idle_us()), shard->stats);
+
+    while (running_) {
+        // Spinning reads the socket directly, which is where SO_BUSY_POLL
+        // polls the device queue; only an idle shard blocks in the loop
+        if (!poller.is_spinning()) {
+            if (shard->loop.wait(events, 4, -1) < 0) {
+                UTC_ERROR("UTCServer", "UDP event loop failed: " + std::string(strerror(errno)));
+                break;
+            }
+            poller.woke(1);
+            report_thread_cpu(thread_name, last_cpu);
+        }
+
+        int received = ntp ? serve_ntp(shard->fd, batch, shard->stats)
+                           : serve_datagrams(shard->fd, batch, shard->stats);
+        poller.polled(received);
+    }
+}
+
+int UTCServer::serve_datagrams(int fd, DatagramBatch& batch, StatsBlock& stats) {
+    bool check_clients = needs_client_address();
+    int received = 0;
+
+    // Edge-triggered: drain until a receive comes back short
+    while (running_) {
+        int count = batch.receive(fd);
+        if (count < 0) {
+            UTC_ERROR("UTCServer", "Failed to receive datagrams: " + std::string(strerror(errno)));
+            return received;
+        }
+        if (count == 0) {
+            return received;
+        }
+        received += count;
+        StatsBlock::add(stats.packets_received, static_cast<uint64_t>(count));
+
+        uint8_t reply[4];
+        time_publisher_->encode_rfc868(reply);
+        int64_t read_ns = batch.has_receive_timestamps() ? wall_clock_ns() : 0;
+
+        for (int i = 0; i < count; ++i) {
+            if (performance_metrics_) {
+                performance_metrics_->record_request();
+            }
+            if (batch.request(i).kernel_time_ns != 0) {
+                stats.kernel_rx_delay.record(elapsed_ns(batch.request(i).kernel_time_ns, read_ns));
+            }
+            if (check_clients &&
+                !admit_client(Platform::address_to_string(batch.request(i).peer))) {
+                StatsBlock::add(stats.datagrams_rejected);
+                continue;
+            }
+            batch.add_reply(i, reply, sizeof(reply));
+        }
+
+        size_t queued = batch.pending_replies();
+        int64_t transmit_ns = batch.has_transmit_timestamps() ? wall_clock_ns() : 0;
+        int sent = batch.flush(fd);
+        record_transmit_delays(fd, batch, transmit_ns, stats);
+        StatsBlock::add(stats.packets_sent, static_cast<uint64_t>(sent));
+        if (performance_metrics_) {
+            for (size_t i = static_cast<size_t>(sent); i < queued; ++i) {
+                performance_metrics_->record_error();
+            }
+        }
+
+        if (static_cast<size_t>(count) < batch.capacity()) {
+            return received;
+        }
+    }
+    return received;
+}
+
+void UTCServer::configure_admission() {
+    admission_control_active_ = config_->is_admission_control_enabled();
+
+    // Sharded listeners and io_uring accept on the thread that serves, so
+    // connections queue only in the kernel backlog, where accept-to-service
+    // delay cannot see them. Say so instead of measuring zeros.
+    if (admission_control_active_ && (config_->is_so_reuseport_enabled() || config_->is_io_uring_enabled())) {
+        if (logger_) {
+            logger_->warn("enable_admission_control has no effect with enable_so_reuseport or enable_io_uring; "
+                          "admission control disabled");
+        }
+        admission_control_active_ = false;
+    }
+    admission_controller_->set_target(std::chrono::milliseconds(config_->get_admission_target_ms()));
+    admission_controller_->set_interval(std::chrono::milliseconds(config_->get_admission_interval_ms()));
+
+    rate_limiter_->set_enabled(config_->is_rate_limiting_enabled());
+    rate_limiter_->set_rate(static_cast<uint64_t>(config_->get_rate_limit_requests_per_second()));
+    rate_limiter_->set_burst_size(static_cast<uint64_t>(config_->get_rate_limit_burst_size()));
+
+    ddos_protection_->set_enabled(config_->is_ddos_protection_enabled());
+    ddos_protection_->set_threshold(static_cast<uint64_t>(config_->get_ddos_threshold()));
+    ddos_protection_->set_block_duration(static_cast<uint64_t>(config_->get_ddos_block_duration()));
+}
+
+int UTCServer::serve_ntp(int fd, DatagramBatch& batch, StatsBlock& stats) {
+    bool check_clients = needs_client_address();
+    uint8_t reply[NtpResponder::kPacketSize];
+    int received = 0;
+
+    // Edge-triggered: drain until a receive comes back short
+    while (running_) {
+        int count = batch.receive(fd);
+        if (count < 0) {
+            UTC_ERROR("UTCServer", "Failed to receive NTP requests: " + std::string(strerror(errno)));
+            return received;
+        }
+        if (count == 0) {
+            return received;
+        }
+        received += count;
+
+        // One clock read for the batch, straight after the receive: every
+        // request in it had arrived by now. A kernel arrival stamp, when
+        // there is one, is closer to the truth. Kernel stamps are on the
+        // wall clock, so a raw-clock discipline takes the batch time less
+        // how long each stamped request waited, at the cost of one more
+        // read only when stamps are on.
+        DisciplineState discipline = discipline_.read();
+        int64_t read_ns = discipline.raw_clock ? raw_clock_ns() : wall_clock_ns();
+        int64_t stamp_read_ns = !discipline.raw_clock ? read_ns
+            : (batch.has_receive_timestamps() ? wall_clock_ns() : 0);
+        uint64_t batch_receive_time = NtpResponder::from_unix_nanoseconds(discipline.corrected_ns(read_ns));
+        StatsBlock::add(stats.packets_received, static_cast<uint64_t>(count));
+
+        for (int i = 0; i < count; ++i) {
+            if (performance_metrics_) {
+                performance_metrics_->record_request();
+            }
+            const auto& request = batch.request(i);
+            uint64_t receive_time = batch_receive_time;
+            if (request.kernel_time_ns != 0) {
+                uint64_t waited = elapsed_ns(request.kernel_time_ns, stamp_read_ns);
+                int64_t arrival_ns = discipline.raw_clock ? read_ns - static_cast<int64_t>(waited)
+                                                          : request.kernel_time_ns;
+                receive_time = NtpResponder::from_unix_nanoseconds(discipline.corrected_ns(arrival_ns));
+                stats.kernel_rx_delay.record(waited);
+            }
+            if (!ntp_responder_.build_reply(request.data, request.size, receive_time, reply) ||
+                (check_clients && !admit_client(Platform::address_to_string(request.peer)))) {
+                StatsBlock::add(stats.datagrams_rejected);
+                continue;
+            }
+            NtpResponder::set_sync_state(reply, discipline);
+            batch.add_reply(i, reply, sizeof(reply));
+        }
+
+        // Transmit time goes in last, immediately before the send
+        size_t queued = batch.pending_replies();
+        int64_t transmit_ns = discipline.raw_clock ? raw_clock_ns() : wall_clock_ns();
+        int64_t stamp_transmit_ns = !discipline.raw_clock ? transmit_ns
+            : (batch.has_transmit_timestamps() ? wall_clock_ns() : 0);
+        uint64_t transmit_time = NtpResponder::from_unix_nanoseconds(discipline.corrected_ns(transmit_ns));
+        for (size_t i = 0; i < queued; ++i) {
+            NtpResponder::set_transmit_time(batch.reply_data(i), transmit_time);
+        }
+
+        int sent = batch.flush(fd);
+        record_transmit_delays(fd, batch, stamp_transmit_ns, stats);
+        StatsBlock::add(stats.packets_sent, static_cast<uint64_t>(sent));
+        if (performance_metrics_) {
+            for (size_t i = static_cast<size_t>(sent); i < queued; ++i) {
+                performance_metrics_->record_error();
+            }
+        }
+
+        if (static_cast<size_t>(count) < batch.capacity()) {
+            return received;
+        }
+    }
+    return received;
+}
+
+void UTCServer::record_transmit_delays(int fd, DatagramBatch& batch, int64_t transmit_ns,
+                                       StatsBlock& stats) {
+    // Software send stamps are taken as the driver queues the packet, so
+    // for the common case they are already waiting once flush() returns
+    int stamped = batch.read_transmit_timestamps(fd);
+    for (int i = 0; i < stamped; ++i) {
+        stats.kernel_tx_delay.record(elapsed_ns(transmit_ns, batch.transmit_timestamp(static_cast<size_t>(i))));
+    }
+}
+
+bool UTCServer::needs_client_address() const {
+    return UTCConnection::has_address_restrictions(config_) ||
+           rate_limiter_->is_enabled() || ddos_protection_->is_enabled();
+}
+
+bool UTCServer::admit_client(const std::string& client_address) {
+    if (!UTCConnection::is_address_allowed(config_, client_address)) {
+        return false;
+    }
+    if (ddos_protection_->is_enabled() && !ddos_protection_->check_request(client_address).allowed) {
+        return false;
+    }
+    if (rate_limiter_->is_enabled() && !rate_limiter_->check_limit(client_address).allowed) {
+        return false;
+    }
+    return true;
+}
+
+bool UTCServer::admit_queued(std::chrono::steady_clock::time_point accepted_at) {
+    bool admitted = admission_controller_->admit(accepted_at);
+
+    if (performance_metrics_) {
+        performance_metrics_->update_queue_delay(admission_controller_->get_queue_delay_us());
+        if (!admitted) {
+            performance_metrics_->record_shed();
+        }
+    }
+
+    // Report overload transitions once each, from whichever worker sees them
+    uint64_t changes = admission_controller_->get_state_changes();
+    if (admission_state_seen_.exchange(changes) != changes) {
+        bool overloaded = admission_controller_->is_overloaded();
+        graceful_degradation_->update_queue_delay(admission_controller_->get_queue_delay_us(), overloaded);
+        if (performance_metrics_) {
+            performance_metrics_->update_overloaded(overloaded);
+        }
+        if (logger_) {
+            if (overloaded) {
+                logger_->warn("Queueing delay {}us above target, shedding delayed connections",
+                              admission_controller_->get_queue_delay_us());
+            } else {
+                logger_->info("Queueing delay back under target, admission control idle");
+            }
+        }
+    }
+
+    return admitted;
+}
+
+void UTCServer::pin_thread(int cpu) {
+    if (cpu < 0) {
+        return;
+    }
+    if (!Platform::set_thread_affinity({cpu}) && logger_) {
+        logger_->warn("Failed to pin thread to CPU {}: {}", cpu, Platform::get_last_error());
+    }
+}
+
+void UTCServer::report_thread_cpu(const std::string& name, int& last_cpu) {
+    // sched_getcpu() is a vDSO read; metrics are only touched on migration
+    int cpu = Platform::get_current_cpu();
+    if (cpu != last_cpu && performance_metrics_) {
+        last_cpu = cpu;
+        performance_metrics_->update_thread_cpu(name, cpu);
+    }
+}
+
+std::map<std::string, int> UTCServer::get_thread_cpus() const {
+    return performance_metrics_ ? performance_metrics_->get_thread_cpus() : std::map<std::string, int>();
+}
+
+uint32_t UTCServer::get_utc_timestamp() {
+    return time_publisher_->get_seconds();
+}
+
+void UTCServer::publish_discipline(const DisciplineState& state) {
+    {
+        std::lock_guard<std::mutex> lock(discipline_mutex_);
+        discipline_.publish(state);
+    }
+
+    // Re-encode the served second now rather than at the next tick
+    time_publisher_->refresh();
+}
+
+void UTCServer::update_reference_time() {
+    // Until an upstream disciplines it, the local clock is the reference:
+    // no correction, advertised with the configured stratum
+    DisciplineState state;
+    state.last_update_ns = wall_clock_ns();
+    state.leap = static_cast<uint8_t>(ntp_responder_.get_leap_indicator());
+    state.stratum = static_cast<uint8_t>(ntp_responder_.get_stratum());
+    publish_discipline(state);
+
+    if (logger_) {
+        logger_->debug("Reference time updated (using system time)");
+    }
+}
+
+bool UTCServer::configure_upstreams() {
+    upstream_manager_->clear_servers();
+    // Switching the virtual clock off forgets its loop, so switching it
+    // back on starts from the next answer rather than stale state
+    virtual_clock_->set_time_constant(std::chrono::seconds(config_->get_virtual_clock_time_constant()));
+    if (!config_->is_virtual_clock_enabled()) {
+        virtual_clock_->reset();
+    }
+    if (!config_->is_upstream_sync_enabled()) {
+        return false;
+    }
+
+    for (const auto& entry : config_->get_upstream_servers()) {
+        std::string host;
+        int port = 0;
+        if (!UpstreamSync::parse_upstream(entry, 123, host, port)) {
+            if (logger_) {
+                logger_->warn("Ignoring malformed upstream server '{}'", entry);
+            }
+            continue;
+        }
+        upstream_manager_->add_server(host, port);
+    }
+    upstream_manager_->set_timeout(static_cast<uint64_t>(config_->get_timeout()));
+    upstream_manager_->set_probe_concurrency(static_cast<size_t>(config_->get_upstream_probe_concurrency()));
+    SelectionStrategy strategy = SelectionStrategy::HEALTH_BASED;
+    if (!UpstreamManager::parse_selection_strategy(config_->get_upstream_selection_strategy(), strategy) &&
+        logger_) {
+        logger_->warn("Unknown upstream selection strategy '{}'; using health_based",
+                      config_->get_upstream_selection_strategy());
+    }
+    upstream_manager_->set_selection_strategy(strategy);
+    upstream_manager_->set_hedge_delay_percentile(config_->get_upstream_hedge_percentile());
+    upstream_manager_->set_hedge_max_outstanding(static_cast<size_t>(config_->get_upstream_hedge_max_outstanding()));
+    upstream_sync_->set_timeout(std::chrono::milliseconds(config_->get_timeout()));
+
+    if (upstream_manager_->get_total_server_count() == 0) {
+        if (logger_) {
+            logger_->warn("Upstream sync enabled without usable upstream servers");
+        }
+        return false;
+    }
+    return true;
+}
+
+void UTCServer::sync_thread_main() {
+    std::unique_lock<std::mutex> lock(sync_mutex_);
+    while (running_) {
+        lock.unlock();
+        // Hedged rounds stop at the first good answer; plain ones ask
+        // everyone, as intersection needs
+        if (upstream_manager_->get_hedge_max_outstanding() > 0 &&
+            upstream_manager_->get_selection_strategy() != SelectionStrategy::INTERSECTION) {
+            apply_sync_round(upstream_sync_->sample_hedged());
+        } else {
+            apply_sync_round(upstream_sync_->sample_all());
+        }
+        lock.lock();
+
+        sync_cv_.wait_for(lock, std::chrono::seconds(config_->get_sync_interval()),
+                          [this] { return !running_; });
+    }
+}
+
+void UTCServer::apply_sync_round(const std::vector<UpstreamSample>& samples) {
+    UpstreamSample best;
+    bool found = upstream_manager_->get_selection_strategy() == SelectionStrategy::INTERSECTION
+        ? upstream_sync_->combine_samples(samples, best)
+        : UpstreamSync::best_sample(samples, best);
+    if (!found) {
+        // Hold the last published state until upstreams answer (and, for
+        // intersection, a majority agrees) again
+        if (logger_) {
+            logger_->warn("No usable upstream time this sync round ({} queried)", samples.size());
+        }
+        return;
+    }
+
+    DisciplineState state;
+    if (config_->is_virtual_clock_enabled()) {
+        // The loop filters the answer; served time follows the raw clock
+        virtual_clock_->update(best.raw_time_ns, best.local_time_ns + best.offset_ns);
+        state = virtual_clock_->get_state();
+    } else {
+        state.offset_ns = best.offset_ns;
+        state.last_update_ns = best.local_time_ns;
+    }
+    state.leap = best.leap;
+    state.stratum = static_cast<uint8_t>(best.stratum + 1);   // Usable samples are below kMaxStratum
+    // What replies advertise about the path to the primary reference
+    state.reference_time_ns = best.local_time_ns + best.offset_ns;
+    state.root_delay_ns = best.root_delay_ns + best.delay_ns;
+    state.root_dispersion_ns = best.root_dispersion_ns;
+    state.reference_id = best.reference_id;
+    publish_discipline(state);
+
+    if (logger_ && logger_->is_enabled(LogLevel::DEBUG)) {
+        logger_->debug("Synchronized to {}:{} offset {} ns delay {} ns",
+                       best.address, best.port, best.offset_ns, best.delay_ns);
     }
 }
 
@@ -0,0 +1,161 @@
+/*
+ * src/core/virtual_clock.cpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "simple_utcd/virtual_clock.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace simple_utcd {
+
+namespace {
+
+// FLL share of each measured frequency error
+constexpr double kFllGain = 0.25;
+
+// Gain of the tracking-error averages, as for LatencySummary's EWMA
+constexpr double kStatsGain = 1.0 / 8.0;
+
+} // namespace
+
+VirtualClock::VirtualClock(std::chrono::seconds time_constant)
+    : time_constant_s_(1.0) {
+    set_time_constant(time_constant);
+}
+
+void VirtualClock::set_time_constant(std::chrono::seconds time_constant) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    time_constant_s_ = static_cast<double>(std::max<int64_t>(1, time_constant.count()));
+}
+
+std::chrono::seconds VirtualClock::get_time_constant() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return std::chrono::seconds(static_cast<int64_t>(time_constant_s_));
+}
+
+void VirtualClock::update(int64_t raw_ns, int64_t reference_ns) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.updates++;
+    if (phase_ == Phase::UNSET) {
+        set_locked(raw_ns, reference_ns);
+        phase_ = Phase::FREQUENCY;
+        return;
+    }
+
+    int64_t current = now_locked(raw_ns);
+    int64_t offset = reference_ns - current;
+    double offset_ns = static_cast<double>(offset);
+    stats_.offset_ns = offset;
+    offset_square_ns2_ += (offset_ns * offset_ns - offset_square_ns2_) * kStatsGain;
+
+    if (offset > kStepThresholdNs || offset < -kStepThresholdNs) {
+        // Keep the frequency: a step says nothing about the oscillator
+        set_locked(raw_ns, reference_ns);
+        stats_.steps++;
+        return;
+    }
+
+    double mu = static_cast<double>(std::max<int64_t>(0, raw_ns - last_update_raw_ns_)) / 1e9;
+    double tau = std::max(time_constant_s_, mu);
+    int64_t adjustment = static_cast<int64_t>(std::llround(offset_ns * mu / tau));
+    double previous = frequency_ppm_;
+
+    if (phase_ == Phase::FREQUENCY) {
+        // Whatever phase error has built up since the measurement began,
+        // corrections included, is the frequency error
+        double elapsed = static_cast<double>(raw_ns - frequency_start_raw_ns_) / 1e9;
+        if (elapsed >= time_constant_s_) {
+            frequency_ppm_ += static_cast<double>(offset + frequency_phase_ns_) / elapsed / 1e3;
+            phase_ = Phase::LOCKED;
+        } else {
+            frequency_phase_ns_ += adjustment;
+        }
+    } else if (mu >= kAllanInterceptS) {
+        frequency_ppm_ += kFllGain * offset_ns / mu / 1e3;
+    } else {
+        frequency_ppm_ += offset_ns * mu / (4.0 * tau * tau) / 1e3;
+    }
+    frequency_ppm_ = std::min(kMaxFrequencyPpm, std::max(-kMaxFrequencyPpm, frequency_ppm_));
+
+    // Restart the line here so the new frequency only applies from now on
+    raw_base_ns_ = raw_ns;
+    time_base_ns_ = current + adjustment;
+    last_update_raw_ns_ = raw_ns;
+
+    double change = frequency_ppm_ - previous;
+    wander_square_ppm2_ += (change * change - wander_square_ppm2_) * kStatsGain;
+}
+
+void VirtualClock::reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    phase_ = Phase::UNSET;
+    raw_base_ns_ = 0;
+    time_base_ns_ = 0;
+    frequency_ppm_ = 0.0;
+    last_update_raw_ns_ = 0;
+    frequency_start_raw_ns_ = 0;
+    frequency_phase_ns_ = 0;
+    stats_ = Stats();
+    offset_square_ns2_ = 0.0;
+    wander_square_ppm2_ = 0.0;
+}
+
+int64_t VirtualClock::now_ns(int64_t raw_ns) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return now_locked(raw_ns);
+}
+
+DisciplineState VirtualClock::get_state() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    DisciplineState state;
+    state.raw_clock = true;
+    state.offset_ns = time_base_ns_ - raw_base_ns_;
+    state.frequency_ppm = frequency_ppm_;
+    state.last_update_ns = raw_base_ns_;
+    return state;
+}
+
+VirtualClock::Stats VirtualClock::get_stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats = stats_;
+    stats.synchronized = phase_ != Phase::UNSET;
+    stats.rms_offset_ns = std::sqrt(offset_square_ns2_);
+    stats.frequency_ppm = frequency_ppm_;
+    stats.wander_ppm = std::sqrt(wander_square_ppm2_);
+    return stats;
+}
+
+bool VirtualClock::is_synchronized() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return phase_ != Phase::UNSET;
+}
+
+int64_t VirtualClock::now_locked(int64_t raw_ns) const {
+    // Same arithmetic as DisciplineState::corrected_ns(), so both agree to the nanosecond
+    double drift = static_cast<double>(raw_ns - raw_base_ns_) * frequency_ppm_ * 1e-6;
+    return time_base_ns_ + (raw_ns - raw_base_ns_) + static_cast<int64_t>(drift);
+}
+
+void VirtualClock::set_locked(int64_t raw_ns, int64_t reference_ns) {
+    raw_base_ns_ = raw_ns;
+    time_base_ns_ = reference_ns;
+    last_update_raw_ns_ = raw_ns;
+    frequency_start_raw_ns_ = raw_ns;
+    frequency_phase_ns_ = 0;
+}
+
+} // namespace simple_utcd
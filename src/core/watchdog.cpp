@@ -17,6 +17,7 @@
  */
 
 #include "simple_utcd/watchdog.hpp"
+#include "simple_utcd/time_source.hpp"
 #include <thread>
 #include <chrono>
 
@@ -28,8 +29,8 @@ Watchdog::Watchdog()
     , failure_count_(0)
     , restart_count_(0)
     , consecutive_failures_(0)
-    , last_check_time_(std::chrono::system_clock::now())
-    , last_restart_time_(std::chrono::system_clock::now())
+    , last_check_time_(now())
+    , last_restart_time_()  // Epoch: no restart has happened yet
 {
 }
 
@@ -88,10 +89,7 @@ void Watchdog::stop() {
 }
 
 bool Watchdog::trigger_restart() {
-    if (!running_) {
-        return false;
-    }
-    
+    // Manual restarts are allowed whether or not the monitor loop is running
     return perform_restart();
 }
 
@@ -180,10 +178,11 @@ bool Watchdog::perform_restart() {
     if (config_.restart_delay_seconds > 0) {
         std::this_thread::sleep_for(
             std::chrono::seconds(config_.restart_delay_seconds));
-    }
-    
-    if (!running_) {
-        return false;
+        
+        // Watchdog was stopped while we waited
+        if (!running_) {
+            return false;
+        }
     }
     
     // Call restart callback if available
@@ -205,7 +204,7 @@ void Watchdog::reset_failure_count() {
 }
 
 std::chrono::system_clock::time_point Watchdog::now() const {
-    return std::chrono::system_clock::now();
+    return TimeSource::current().coarse_now();
 }
 
 uint64_t Watchdog::seconds_since(const std::chrono::system_clock::time_point& time) const {
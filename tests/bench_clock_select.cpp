@@ -0,0 +1,110 @@
+/*
+ * tests/bench_clock_select.cpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Cost of intersecting, clustering and combining an upstream pool.
+// Usage: simple_utcd_bench_clock_select [rounds]
+// Exits non-zero if selection goes wrong, or if a pool of up to 48
+// servers costs more than a millisecond per round (96 is only reported).
+
+#include "simple_utcd/clock_select.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace simple_utcd;
+
+namespace {
+
+const double kBudgetNsPerRound = 1000000.0;
+
+struct Result {
+    bool ok;
+    double ns_per_round;
+    size_t survivors;
+};
+
+// A pool like a public one: most servers agree within a few milliseconds,
+// one in eight is wildly off, and each reports its own distance and jitter
+std::vector<ClockSelect::Candidate> make_pool(size_t servers, std::mt19937_64& random) {
+    std::normal_distribution<double> noise(0.0, 2e6);
+    std::uniform_int_distribution<int64_t> distance(5000000, 40000000);
+    std::uniform_int_distribution<int64_t> jitter(100000, 2000000);
+
+    std::vector<ClockSelect::Candidate> pool(servers);
+    for (size_t i = 0; i < servers; ++i) {
+        bool falseticker = i % 8 == 7;
+        pool[i].offset_ns = falseticker ? 500000000 + static_cast<int64_t>(i) * 100000000
+                                        : static_cast<int64_t>(noise(random));
+        pool[i].root_distance_ns = distance(random);
+        pool[i].jitter_ns = jitter(random);
+    }
+    return pool;
+}
+
+Result run(size_t servers, int rounds) {
+    std::mt19937_64 random(servers);
+    std::vector<std::vector<ClockSelect::Candidate>> pools;
+    for (int i = 0; i < 16; ++i) {
+        pools.push_back(make_pool(servers, random));
+    }
+
+    size_t survivors = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; ++i) {
+        const auto& pool = pools[i % pools.size()];
+        ClockSelect::Result result = ClockSelect::select(pool);
+        if (!result.valid || std::llabs(result.offset_ns) > 20000000) {
+            return {false, 0.0, 0};
+        }
+        for (size_t index : result.survivors) {
+            if (index % 8 == 7) {
+                return {false, 0.0, 0};  // A falseticker survived
+            }
+        }
+        survivors += result.survivors.size();
+    }
+    auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start);
+    return {true, elapsed.count() / rounds, survivors / static_cast<size_t>(rounds)};
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int rounds = argc > 1 ? std::atoi(argv[1]) : 20000;
+    if (rounds <= 0) {
+        std::fprintf(stderr, "usage: %s [rounds]\n", argv[0]);
+        return 2;
+    }
+
+    bool ok = true;
+    std::printf("%8s %14s %10s\n", "servers", "ns/round", "survivors");
+    for (size_t servers : {4, 12, 24, 48, 96}) {
+        Result result = run(servers, rounds);
+        if (!result.ok) {
+            std::fprintf(stderr, "selection failed with %zu servers\n", servers);
+            return 1;
+        }
+        std::printf("%8zu %14.0f %10zu\n", servers, result.ns_per_round, result.survivors);
+        if (servers <= 48 && result.ns_per_round > kBudgetNsPerRound) {
+            ok = false;
+        }
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,164 @@
+/*
+ * tests/bench_fast_path.cpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Request throughput and heap allocations per request for the TCP path.
+// Usage: simple_utcd_bench_fast_path [requests]
+// Exits non-zero if the fast path allocates in steady state.
+
+#include "simple_utcd/utc_server.hpp"
+#include "simple_utcd/utc_config.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+namespace {
+
+std::atomic<uint64_t> g_allocations{0};
+
+} // namespace
+
+// Count every heap allocation in the process; the benchmark client itself
+// only makes system calls, so anything counted comes from the server
+void* operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+using namespace simple_utcd;
+
+namespace {
+
+bool query(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    if (connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0) {
+        close(fd);
+        return false;
+    }
+
+    uint8_t buffer[4];
+    size_t received = 0;
+    while (received < sizeof(buffer)) {
+        ssize_t n = recv(fd, buffer + received, sizeof(buffer) - received, 0);
+        if (n <= 0) {
+            break;
+        }
+        received += n;
+    }
+    close(fd);
+    return received == sizeof(buffer);
+}
+
+struct Result {
+    bool ok;
+    double requests_per_second;
+    double allocations_per_request;
+};
+
+Result run(bool fast_path, int requests) {
+    UTCConfig config;
+    config.set_listen_address("127.0.0.1");
+    config.set_listen_port(0);
+    config.set_worker_threads(1);
+    config.set_fast_path_enabled(fast_path);
+
+    UTCServer server(&config, nullptr);
+    if (!server.start() || server.is_fast_path_active() != fast_path) {
+        return {false, 0.0, 0.0};
+    }
+
+    // Warm up so one-time growth (metrics history, first-use statics) is
+    // not charged to the measured requests
+    for (int i = 0; i < 200; ++i) {
+        if (!query(server.get_bound_port())) {
+            return {false, 0.0, 0.0};
+        }
+    }
+
+    uint64_t before = g_allocations.load();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < requests; ++i) {
+        if (!query(server.get_bound_port())) {
+            return {false, 0.0, 0.0};
+        }
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+    uint64_t allocations = g_allocations.load() - before;
+
+    server.stop();
+    return {true, requests / elapsed.count(), static_cast<double>(allocations) / requests};
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int requests = argc > 1 ? std::atoi(argv[1]) : 10000;
+    if (requests <= 0) {
+        std::fprintf(stderr, "usage: %s [requests]\n", argv[0]);
+        return 2;
+    }
+
+    Result slow = run(false, requests);
+    Result fast = run(true, requests);
+    if (!slow.ok || !fast.ok) {
+        std::fprintf(stderr, "benchmark failed to run\n");
+        return 1;
+    }
+
+    std::printf("%-16s %12s %18s\n", "path", "requests/s", "allocations/req");
+    std::printf("%-16s %12.0f %18.2f\n", "connection", slow.requests_per_second, slow.allocations_per_request);
+    std::printf("%-16s %12.0f %18.2f\n", "fast path", fast.requests_per_second, fast.allocations_per_request);
+
+    return fast.allocations_per_request == 0.0 ? 0 : 1;
+}
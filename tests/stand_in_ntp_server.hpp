@@ -0,0 +1,131 @@
+/*
+ * tests/stand_in_ntp_server.hpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "simple_utcd/ntp_responder.hpp"
+#include "simple_utcd/upstream_manager.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <unistd.h>
+
+namespace simple_utcd {
+
+// A local NTP server whose clock runs offset_ns ahead of ours
+class StandInServer {
+public:
+    int64_t offset_ns = 0;
+    std::chrono::milliseconds network_delay{0};     // Before the request is stamped
+    std::chrono::milliseconds processing_delay{0};  // Between receive and transmit stamps
+    uint8_t stratum = 1;
+    uint8_t leap = 0;
+    bool silent = false;
+
+    // Any 127.0.0.0/8 address works on Linux, so each stand-in can have its own
+    explicit StandInServer(const std::string& address = "127.0.0.1") : address_(address) {
+        fd_ = socket(AF_INET, SOCK_DGRAM, 0);
+        struct sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        inet_pton(AF_INET, address.c_str(), &addr.sin_addr);
+        bind(fd_, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr));
+        socklen_t length = sizeof(addr);
+        getsockname(fd_, reinterpret_cast<struct sockaddr*>(&addr), &length);
+        port_ = ntohs(addr.sin_port);
+    }
+
+    ~StandInServer() {
+        running_ = false;
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+        close(fd_);
+    }
+
+    void start() {
+        running_ = true;
+        thread_ = std::thread(&StandInServer::serve, this);
+    }
+
+    UpstreamServer upstream() const {
+        UpstreamServer server;
+        server.address = address_;
+        server.port = port_;
+        return server;
+    }
+
+    int port() const { return port_; }
+
+private:
+    std::string address_;
+    int fd_ = -1;
+    int port_ = 0;
+    std::atomic<bool> running_{false};
+    std::thread thread_;
+
+    uint64_t stamp() const {
+        int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        return NtpResponder::from_unix_nanoseconds(now + offset_ns);
+    }
+
+    static void put(uint8_t* out, uint64_t value) {
+        for (int i = 7; i >= 0; --i) {
+            out[i] = static_cast<uint8_t>(value);
+            value >>= 8;
+        }
+    }
+
+    void serve() {
+        while (running_) {
+            struct pollfd pfd = {fd_, POLLIN, 0};
+            if (poll(&pfd, 1, 20) <= 0) {
+                continue;
+            }
+            uint8_t request[48];
+            struct sockaddr_in peer = {};
+            socklen_t length = sizeof(peer);
+            if (recvfrom(fd_, request, sizeof(request), 0,
+                         reinterpret_cast<struct sockaddr*>(&peer), &length) != 48 || silent) {
+                continue;
+            }
+
+            std::this_thread::sleep_for(network_delay);
+            uint8_t reply[48] = {};
+            reply[0] = static_cast<uint8_t>((leap << 6) | (4 << 3) | 4);
+            reply[1] = stratum;
+            if (stratum == 0) {
+                std::memcpy(reply + 12, "RATE", 4);
+            }
+            std::memcpy(reply + 24, request + 40, 8);
+            put(reply + 32, stamp());
+            std::this_thread::sleep_for(processing_delay);
+            put(reply + 40, stamp());
+            sendto(fd_, reply, sizeof(reply), 0, reinterpret_cast<struct sockaddr*>(&peer), length);
+        }
+    }
+};
+
+
+} // namespace simple_utcd
@@ -0,0 +1,98 @@
+/*
+ * tests/test_admission_control.cpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include "simple_utcd/admission_control.hpp"
+
+using namespace simple_utcd;
+using std::chrono::milliseconds;
+
+class AdmissionControllerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        controller_.set_target(milliseconds(5));
+        controller_.set_interval(milliseconds(100));
+        base_ = AdmissionController::Clock::now();
+    }
+
+    // Report a connection served at base_ + at_ms that waited wait_ms
+    bool serve(int at_ms, int wait_ms) {
+        auto now = base_ + milliseconds(at_ms);
+        return controller_.admit(now - milliseconds(wait_ms), now);
+    }
+
+    AdmissionController controller_;
+    AdmissionController::Clock::time_point base_;
+};
+
+// Test defaults follow CoDel
+TEST_F(AdmissionControllerTest, Defaults) {
+    AdmissionController controller;
+    EXPECT_EQ(controller.get_target(), milliseconds(5));
+    EXPECT_EQ(controller.get_interval(), milliseconds(100));
+    EXPECT_FALSE(controller.is_overloaded());
+}
+
+// Test short waits never trigger shedding
+TEST_F(AdmissionControllerTest, ShortDelaysAdmitted) {
+    for (int t = 0; t < 1000; t += 10) {
+        EXPECT_TRUE(serve(t, 1));
+    }
+    EXPECT_FALSE(controller_.is_overloaded());
+    EXPECT_EQ(controller_.get_shed_count(), 0u);
+}
+
+// Test a brief burst above target is tolerated
+TEST_F(AdmissionControllerTest, BurstTolerated) {
+    EXPECT_TRUE(serve(0, 1));
+    EXPECT_TRUE(serve(110, 1));
+    EXPECT_TRUE(serve(150, 50));   // One slow sample, but the minimum stays low
+    EXPECT_TRUE(serve(160, 1));
+    EXPECT_TRUE(serve(220, 1));
+    EXPECT_FALSE(controller_.is_overloaded());
+}
+
+// Test a standing queue turns on shedding of delayed work only
+TEST_F(AdmissionControllerTest, StandingQueueSheds) {
+    EXPECT_TRUE(serve(0, 20));
+    for (int t = 10; t < 100; t += 10) {
+        EXPECT_TRUE(serve(t, 20));
+    }
+    // The next interval sees a minimum of 20 ms > 5 ms target
+    EXPECT_FALSE(serve(110, 20));
+    EXPECT_TRUE(controller_.is_overloaded());
+    EXPECT_EQ(controller_.get_queue_delay_us(), 20000u);
+    EXPECT_EQ(controller_.get_state_changes(), 1u);
+
+    // Fresh work is still served
+    EXPECT_TRUE(serve(120, 1));
+    EXPECT_EQ(controller_.get_shed_count(), 1u);
+}
+
+// Test recovery once the queue drains
+TEST_F(AdmissionControllerTest, RecoversWhenDrained) {
+    serve(0, 20);
+    serve(50, 20);
+    serve(110, 20);
+    ASSERT_TRUE(controller_.is_overloaded());
+
+    serve(150, 1);      // Minimum of this interval drops below target
+    EXPECT_TRUE(serve(220, 1));
+    EXPECT_FALSE(controller_.is_overloaded());
+    EXPECT_EQ(controller_.get_state_changes(), 2u);
+}
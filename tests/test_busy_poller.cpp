@@ -0,0 +1,80 @@
+/*
+ * tests/test_busy_poller.cpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include "simple_utcd/busy_poller.hpp"
+#include <thread>
+
+using namespace simple_utcd;
+
+// Test a disabled poller always blocks and charges nothing
+TEST(BusyPollerTest, DisabledBlocks) {
+    StatsBlock stats;
+    BusyPoller poller(false, std::chrono::microseconds(1000), stats);
+    EXPECT_EQ(poller.next_timeout(), -1);
+
+    poller.woke(3);
+    poller.handled(3);
+    poller.polled(0);
+    EXPECT_EQ(poller.next_timeout(), -1);
+    EXPECT_EQ(StatsBlock::read(stats.busy_poll_spin_ns), 0u);
+    EXPECT_EQ(StatsBlock::read(stats.busy_poll_work_ns), 0u);
+}
+
+// Test spinning backs off after the idle threshold and resumes on events
+TEST(BusyPollerTest, IdleBackoff) {
+    StatsBlock stats;
+    BusyPoller poller(true, std::chrono::microseconds(2000), stats);
+    EXPECT_EQ(poller.next_timeout(), 0);
+
+    poller.woke(0);
+    EXPECT_TRUE(poller.is_spinning());
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    poller.woke(0);
+    EXPECT_FALSE(poller.is_spinning());
+    EXPECT_EQ(poller.next_timeout(), -1);
+    EXPECT_EQ(StatsBlock::read(stats.busy_poll_sleeps), 1u);
+    uint64_t spun = StatsBlock::read(stats.busy_poll_spin_ns);
+    EXPECT_GE(spun, 5000000u);
+
+    // Time blocked is neither spin nor work
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    poller.woke(1);
+    EXPECT_TRUE(poller.is_spinning());
+    EXPECT_EQ(StatsBlock::read(stats.busy_poll_spin_ns), spun);
+    EXPECT_EQ(StatsBlock::read(stats.busy_poll_work_ns), 0u);
+}
+
+// Test event handling is charged as work
+TEST(BusyPollerTest, ChargesWork) {
+    StatsBlock stats;
+    BusyPoller poller(true, std::chrono::seconds(10), stats);
+
+    poller.woke(2);
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    poller.handled(2);
+    EXPECT_GE(StatsBlock::read(stats.busy_poll_work_ns), 2000000u);
+
+    // A direct-read pass that found data is work too
+    uint64_t work = StatsBlock::read(stats.busy_poll_work_ns);
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    poller.polled(4);
+    EXPECT_GE(StatsBlock::read(stats.busy_poll_work_ns), work + 2000000u);
+    EXPECT_EQ(StatsBlock::read(stats.busy_poll_sleeps), 0u);
+}
@@ -0,0 +1,118 @@
+/*
+ * tests/test_clock_select.cpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include "simple_utcd/clock_select.hpp"
+#include <algorithm>
+
+using namespace simple_utcd;
+
+namespace {
+
+ClockSelect::Candidate candidate(int64_t offset_us, int64_t distance_us, int64_t jitter_us = 0) {
+    ClockSelect::Candidate result;
+    result.offset_ns = offset_us * 1000;
+    result.root_distance_ns = distance_us * 1000;
+    result.jitter_ns = jitter_us * 1000;
+    return result;
+}
+
+bool contains(const std::vector<size_t>& indexes, size_t index) {
+    return std::find(indexes.begin(), indexes.end(), index) != indexes.end();
+}
+
+} // namespace
+
+// Test agreeing upstreams are all truechimers and combine to their middle
+TEST(ClockSelectTest, AgreeingCandidates) {
+    auto result = ClockSelect::select({candidate(-200, 1000), candidate(0, 1000), candidate(200, 1000)});
+    ASSERT_TRUE(result.valid);
+    EXPECT_EQ(result.truechimers.size(), 3u);
+    EXPECT_EQ(result.survivors.size(), 3u);
+    EXPECT_EQ(result.offset_ns, 0);
+    EXPECT_LE(result.low_ns, 0);
+    EXPECT_GE(result.high_ns, 0);
+    EXPECT_NEAR(static_cast<double>(result.jitter_ns), 200000.0, 1.0);
+}
+
+// Test an interval disjoint from the majority is a falseticker
+TEST(ClockSelectTest, RejectsFalseticker) {
+    auto result = ClockSelect::select({candidate(100, 1000), candidate(-300, 1000), candidate(50000, 1000),
+                                       candidate(0, 1000), candidate(400, 1000)});
+    ASSERT_TRUE(result.valid);
+    EXPECT_EQ(result.truechimers.size(), 4u);
+    EXPECT_FALSE(contains(result.truechimers, 2));
+    EXPECT_FALSE(contains(result.survivors, 2));
+    EXPECT_LT(std::abs(result.offset_ns), 500000);
+}
+
+// Test a wide interval around a wrong offset does not make a truechimer
+TEST(ClockSelectTest, RejectsWideIntervalFalseticker) {
+    auto result = ClockSelect::select({candidate(0, 1000), candidate(100, 1000), candidate(-100, 1000),
+                                       candidate(50000, 100000)});
+    ASSERT_TRUE(result.valid);
+    EXPECT_LE(result.high_ns, 1000000);
+    EXPECT_EQ(result.truechimers.size(), 3u);
+    EXPECT_FALSE(contains(result.truechimers, 3));
+    EXPECT_FALSE(contains(result.survivors, 3));
+    EXPECT_LT(std::abs(result.offset_ns), 200000);
+}
+
+// Test there is no answer when no majority agrees
+TEST(ClockSelectTest, NoMajority) {
+    EXPECT_FALSE(ClockSelect::select({}).valid);
+    EXPECT_FALSE(ClockSelect::select({candidate(0, 100), candidate(10000, 100)}).valid);
+    EXPECT_FALSE(ClockSelect::select({candidate(0, 100), candidate(0, 100),
+                                      candidate(10000, 100), candidate(10000, 100)}).valid);
+
+    int64_t low = 0;
+    int64_t high = 0;
+    ASSERT_TRUE(ClockSelect::intersect({candidate(0, 100)}, low, high));
+    EXPECT_EQ(low, -100000);
+    EXPECT_EQ(high, 100000);
+}
+
+// Test clustering drops the truechimer furthest from the rest
+TEST(ClockSelectTest, ClusteringPrunesOutlier) {
+    std::vector<ClockSelect::Candidate> candidates = {
+        candidate(10, 20000, 100), candidate(-20, 20000, 100), candidate(30, 20000, 100),
+        candidate(0, 20000, 100), candidate(8000, 20000, 100),
+    };
+    auto result = ClockSelect::select(candidates);
+    ASSERT_TRUE(result.valid);
+    EXPECT_EQ(result.truechimers.size(), 5u);
+    EXPECT_FALSE(contains(result.survivors, 4));
+    EXPECT_GE(result.survivors.size(), ClockSelect::kMinSurvivors);
+    EXPECT_LT(std::abs(result.offset_ns), 50000);
+
+    // Noisy candidates are not worth pruning below their own jitter
+    for (auto& noisy : candidates) {
+        noisy.jitter_ns = 10000000;
+    }
+    EXPECT_EQ(ClockSelect::select(candidates).survivors.size(), 5u);
+}
+
+// Test tighter intervals weigh more and the tightest is the system peer
+TEST(ClockSelectTest, WeightsByRootDistance) {
+    auto result = ClockSelect::select({candidate(0, 4000), candidate(1000, 1000), candidate(500, 2000)});
+    ASSERT_TRUE(result.valid);
+    EXPECT_EQ(result.system_peer, 1u);
+    EXPECT_EQ(result.survivors[0], 1u);
+    // Weights 1/4, 1, 1/2: (0 + 1000 + 250) / 1.75 us
+    EXPECT_NEAR(static_cast<double>(result.offset_ns), 1250000.0 / 1.75, 2.0);
+}
@@ -0,0 +1,193 @@
+/*
+ * tests/test_datagram_batch.cpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include "simple_utcd/datagram_batch.hpp"
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <chrono>
+
+using namespace simple_utcd;
+
+class DatagramBatchTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        server_fd_ = bind_loopback();
+        client_fd_ = bind_loopback();
+        ASSERT_GE(server_fd_, 0);
+        ASSERT_GE(client_fd_, 0);
+        fcntl(server_fd_, F_SETFL, fcntl(server_fd_, F_GETFL, 0) | O_NONBLOCK);
+
+        struct timeval tv = {1, 0};
+        setsockopt(client_fd_, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    }
+
+    void TearDown() override {
+        close(server_fd_);
+        close(client_fd_);
+    }
+
+    static int bind_loopback() {
+        int fd = socket(AF_INET, SOCK_DGRAM, 0);
+        struct sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+        if (bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0) {
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    struct sockaddr_in address_of(int fd) {
+        struct sockaddr_in addr = {};
+        socklen_t len = sizeof(addr);
+        getsockname(fd, reinterpret_cast<struct sockaddr*>(&addr), &len);
+        return addr;
+    }
+
+    void send_to_server(const char* payload, size_t size) {
+        struct sockaddr_in addr = address_of(server_fd_);
+        ASSERT_EQ(sendto(client_fd_, payload, size, 0,
+                         reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)),
+                  static_cast<ssize_t>(size));
+    }
+
+    int server_fd_;
+    int client_fd_;
+};
+
+// Test an empty socket reports drained rather than an error
+TEST_F(DatagramBatchTest, ReceiveEmpty) {
+    DatagramBatch batch(8);
+    EXPECT_EQ(batch.receive(server_fd_), 0);
+}
+
+// Test several datagrams arrive in one receive and keep their sender
+TEST_F(DatagramBatchTest, ReceiveBatch) {
+    send_to_server("a", 1);
+    send_to_server("bb", 2);
+    send_to_server("", 0);
+
+    DatagramBatch batch(8);
+    ASSERT_EQ(batch.receive(server_fd_), 3);
+    EXPECT_EQ(batch.request(0).size, 1u);
+    EXPECT_EQ(batch.request(1).size, 2u);
+    EXPECT_EQ(batch.request(2).size, 0u);
+
+    struct sockaddr_in client = address_of(client_fd_);
+    const auto* peer = reinterpret_cast<const struct sockaddr_in*>(&batch.request(0).peer);
+    EXPECT_EQ(peer->sin_port, client.sin_port);
+}
+
+// Test receive stops at capacity and leaves the rest queued
+TEST_F(DatagramBatchTest, CapacityBound) {
+    for (int i = 0; i < 5; ++i) {
+        send_to_server("x", 1);
+    }
+
+    DatagramBatch batch(2);
+    EXPECT_EQ(batch.receive(server_fd_), 2);
+    EXPECT_EQ(batch.receive(server_fd_), 2);
+    EXPECT_EQ(batch.receive(server_fd_), 1);
+    EXPECT_EQ(batch.receive(server_fd_), 0);
+}
+
+// Test queued replies go back to each sender in one flush
+TEST_F(DatagramBatchTest, ReplyBatch) {
+    send_to_server("1", 1);
+    send_to_server("2", 1);
+
+    DatagramBatch batch(8);
+    ASSERT_EQ(batch.receive(server_fd_), 2);
+    const uint8_t reply[4] = {0xDE, 0xAD, 0xBE, 0xEF};
+    EXPECT_TRUE(batch.add_reply(0, reply, sizeof(reply)));
+    EXPECT_TRUE(batch.add_reply(1, reply, sizeof(reply)));
+    EXPECT_EQ(batch.pending_replies(), 2u);
+    EXPECT_EQ(batch.flush(server_fd_), 2);
+    EXPECT_EQ(batch.pending_replies(), 0u);
+
+    for (int i = 0; i < 2; ++i) {
+        uint8_t buffer[16];
+        ASSERT_EQ(recv(client_fd_, buffer, sizeof(buffer), 0), 4);
+        EXPECT_EQ(buffer[0], 0xDE);
+        EXPECT_EQ(buffer[3], 0xEF);
+    }
+}
+
+// Test oversized replies are refused
+TEST_F(DatagramBatchTest, OversizedReply) {
+    send_to_server("x", 1);
+
+    DatagramBatch batch(1);
+    ASSERT_EQ(batch.receive(server_fd_), 1);
+    uint8_t big[DatagramBatch::kMaxDatagramSize + 1] = {};
+    EXPECT_FALSE(batch.add_reply(0, big, sizeof(big)));
+    EXPECT_EQ(batch.flush(server_fd_), 0);
+}
+
+// Test kernel receive stamps reach each datagram and send stamps are
+// matched to the last flush only
+TEST_F(DatagramBatchTest, KernelTimestamps) {
+    auto mode = DatagramBatch::enable_timestamping(server_fd_);
+    if (mode == DatagramBatch::Timestamping::NONE) {
+        GTEST_SKIP() << "Kernel packet timestamps unavailable";
+    }
+    DatagramBatch batch(8);
+    batch.set_timestamping(mode);
+
+    auto wall_ns = []() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    };
+    // The kernel switches software stamping on system-wide in the
+    // background, so the first datagrams after enabling may be unstamped
+    int64_t before = 0;
+    int64_t after = 0;
+    for (int attempt = 0; attempt < 100; ++attempt) {
+        before = wall_ns();
+        send_to_server("1", 1);
+        send_to_server("2", 1);
+        ASSERT_EQ(batch.receive(server_fd_), 2);
+        after = wall_ns();
+        if (batch.request(1).kernel_time_ns != 0) {
+            break;
+        }
+        usleep(1000);
+    }
+    for (size_t i = 0; i < 2; ++i) {
+        EXPECT_GE(batch.request(i).kernel_time_ns, before);
+        EXPECT_LE(batch.request(i).kernel_time_ns, after);
+    }
+
+    if (!batch.has_transmit_timestamps()) {
+        return;
+    }
+    const uint8_t reply[4] = {1, 2, 3, 4};
+    batch.add_reply(0, reply, sizeof(reply));
+    batch.add_reply(1, reply, sizeof(reply));
+    int64_t flushed = wall_ns();
+    ASSERT_EQ(batch.flush(server_fd_), 2);
+    ASSERT_EQ(batch.read_transmit_timestamps(server_fd_), 2);
+    EXPECT_GE(batch.transmit_timestamp(0), flushed);
+    EXPECT_GE(batch.transmit_timestamp(1), flushed);
+    EXPECT_EQ(batch.read_transmit_timestamps(server_fd_), 0);
+}
@@ -0,0 +1,119 @@
+/*
+ * tests/test_discipline_state.cpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include "simple_utcd/discipline_state.hpp"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace simple_utcd;
+
+// Test nothing published reads as an unsynchronized, uncorrected clock
+TEST(DisciplineStateTest, DefaultsUnsynchronized) {
+    DisciplinePublisher publisher;
+    DisciplineState state = publisher.read();
+    EXPECT_EQ(publisher.get_version(), 0u);
+    EXPECT_EQ(state.leap, DisciplineState::kLeapUnsynchronized);
+    EXPECT_EQ(state.stratum, DisciplineState::kUnsynchronizedStratum);
+    EXPECT_EQ(state.corrected_ns(123456789), 123456789);
+}
+
+// Test the correction adds the offset plus frequency drift since the update
+TEST(DisciplineStateTest, CorrectedTime) {
+    DisciplineState state;
+    state.offset_ns = 5000;
+    state.frequency_ppm = 10.0;
+    state.last_update_ns = 1000000000;
+
+    EXPECT_EQ(state.corrected_ns(1000000000), 1000005000);
+    // One second later the clock has drifted a further 10 us
+    EXPECT_EQ(state.corrected_ns(2000000000), 2000015000);
+
+    state.frequency_ppm = -10.0;
+    EXPECT_EQ(state.corrected_ns(2000000000), 1999995000);
+}
+
+// Test a published state reads back whole and bumps the version
+TEST(DisciplineStateTest, PublishAndRead) {
+    DisciplinePublisher publisher;
+    DisciplineState state;
+    state.offset_ns = -42;
+    state.frequency_ppm = 1.5;
+    state.last_update_ns = 77;
+    state.leap = 1;
+    state.stratum = 3;
+    publisher.publish(state);
+
+    DisciplineState read = publisher.read();
+    EXPECT_EQ(read.offset_ns, -42);
+    EXPECT_DOUBLE_EQ(read.frequency_ppm, 1.5);
+    EXPECT_EQ(read.last_update_ns, 77);
+    EXPECT_EQ(read.leap, 1);
+    EXPECT_EQ(read.stratum, 3);
+    EXPECT_EQ(publisher.get_version(), 1u);
+}
+
+// Test readers never see a state mixed from two publishes
+TEST(DisciplineStateTest, ReadersNeverSeeTornState) {
+    DisciplinePublisher publisher;
+    std::atomic<bool> done{false};
+    std::atomic<uint64_t> torn{0};
+    std::atomic<uint64_t> reads{0};
+
+    // Every field of publish n is derived from n
+    auto publish = [&publisher](int64_t n) {
+        DisciplineState state;
+        state.offset_ns = n;
+        state.last_update_ns = n * 2;
+        state.frequency_ppm = static_cast<double>(n);
+        state.stratum = static_cast<uint8_t>(n % 16);
+        state.leap = static_cast<uint8_t>(n % 4);
+        publisher.publish(state);
+    };
+    publish(0);
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 3; ++r) {
+        readers.emplace_back([&]() {
+            while (!done.load(std::memory_order_acquire)) {
+                DisciplineState state = publisher.read();
+                int64_t n = state.offset_ns;
+                if (state.last_update_ns != n * 2 || state.frequency_ppm != static_cast<double>(n) ||
+                    state.stratum != static_cast<uint8_t>(n % 16) || state.leap != static_cast<uint8_t>(n % 4)) {
+                    torn.fetch_add(1);
+                }
+                reads.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+
+    const int64_t kPublishes = 200000;
+    for (int64_t n = 1; n < kPublishes; ++n) {
+        publish(n);
+    }
+    done.store(true, std::memory_order_release);
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    EXPECT_EQ(torn.load(), 0u);
+    EXPECT_GT(reads.load(), 0u);
+    EXPECT_EQ(publisher.get_version(), static_cast<uint64_t>(kPublishes));
+    EXPECT_EQ(publisher.read().offset_ns, kPublishes - 1);
+}
@@ -0,0 +1,111 @@
+/*
+ * tests/test_event_loop.cpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include "simple_utcd/event_loop.hpp"
+#include <thread>
+#include <chrono>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace simple_utcd;
+
+class EventLoopTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_TRUE(loop_.open());
+        ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds_), 0);
+    }
+
+    void TearDown() override {
+        loop_.close();
+        close(fds_[0]);
+        close(fds_[1]);
+    }
+
+    EventLoop loop_;
+    int fds_[2];
+};
+
+// Test open/close lifecycle
+TEST_F(EventLoopTest, OpenClose) {
+    EXPECT_TRUE(loop_.is_open());
+    loop_.close();
+    EXPECT_FALSE(loop_.is_open());
+    EXPECT_TRUE(loop_.open());
+}
+
+// Test timeout with nothing registered
+TEST_F(EventLoopTest, WaitTimeout) {
+    IOEvent events[4];
+    EXPECT_EQ(loop_.wait(events, 4, 10), 0);
+}
+
+// Test read readiness carries the registration pointer
+TEST_F(EventLoopTest, ReadReadiness) {
+    int tag = 42;
+    ASSERT_TRUE(loop_.add(fds_[0], EVENT_READ, &tag));
+
+    ASSERT_EQ(write(fds_[1], "x", 1), 1);
+
+    IOEvent events[4];
+    ASSERT_EQ(loop_.wait(events, 4, 1000), 1);
+    EXPECT_EQ(events[0].data, &tag);
+    EXPECT_TRUE(events[0].events & EVENT_READ);
+
+    EXPECT_TRUE(loop_.remove(fds_[0]));
+}
+
+// Test write readiness on a fresh socket
+TEST_F(EventLoopTest, WriteReadiness) {
+    int tag = 7;
+    ASSERT_TRUE(loop_.add(fds_[0], EVENT_WRITE, &tag));
+
+    IOEvent events[4];
+    ASSERT_EQ(loop_.wait(events, 4, 1000), 1);
+    EXPECT_TRUE(events[0].events & EVENT_WRITE);
+}
+
+// Test peer close reports hangup
+TEST_F(EventLoopTest, Hangup) {
+    int tag = 1;
+    ASSERT_TRUE(loop_.add(fds_[0], EVENT_READ, &tag));
+
+    close(fds_[1]);
+    fds_[1] = -1;
+
+    IOEvent events[4];
+    ASSERT_EQ(loop_.wait(events, 4, 1000), 1);
+    EXPECT_TRUE(events[0].events & EVENT_HANGUP);
+}
+
+// Test wakeup interrupts a blocking wait from another thread
+TEST_F(EventLoopTest, Wakeup) {
+    std::thread waker([this]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        loop_.wakeup();
+    });
+
+    IOEvent events[4];
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(loop_.wait(events, 4, 5000), 0);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    EXPECT_LT(elapsed, std::chrono::seconds(2));
+
+    waker.join();
+}
@@ -173,3 +173,14 @@ TEST_F(GracefulDegradationTest, DegradationReason) {
     EXPECT_FALSE(degradation_.get_degradation_reason().empty());
 }
 
+
+// Test sustained queueing delay degrades service
+TEST_F(GracefulDegradationTest, QueueDelayDegrades) {
+    degradation_.update_queue_delay(20000, true);
+    EXPECT_EQ(degradation_.get_degradation_level(), DegradationLevel::DEGRADED);
+    EXPECT_EQ(degradation_.get_queue_delay_us(), 20000u);
+    EXPECT_EQ(degradation_.get_degradation_reason(), "Queueing delay above admission target");
+
+    degradation_.update_queue_delay(1000, false);
+    EXPECT_EQ(degradation_.get_degradation_level(), DegradationLevel::NORMAL);
+}
@@ -0,0 +1,141 @@
+/*
+ * tests/test_io_uring_loop.cpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include "simple_utcd/io_uring_loop.hpp"
+#include <thread>
+#include <chrono>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+using namespace simple_utcd;
+
+class IoUringLoopTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        if (!IoUringLoop::is_available()) {
+            GTEST_SKIP() << "io_uring not built in or not supported by this kernel";
+        }
+        ASSERT_TRUE(ring_.open(64));
+    }
+
+    IoUringLoop ring_;
+};
+
+// Test open/close lifecycle
+TEST_F(IoUringLoopTest, OpenClose) {
+    EXPECT_TRUE(ring_.is_open());
+    ring_.close();
+    EXPECT_FALSE(ring_.is_open());
+    EXPECT_TRUE(ring_.open(64));
+}
+
+// Test timeout with nothing queued
+TEST_F(IoUringLoopTest, WaitTimeout) {
+    UringCompletion completions[4];
+    EXPECT_EQ(ring_.wait(completions, 4, 10), 0);
+}
+
+// Test a linked send and close deliver the payload and close the socket
+TEST_F(IoUringLoopTest, SendAndClose) {
+    int fds[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+
+    const uint8_t payload[4] = {1, 2, 3, 4};
+    ASSERT_TRUE(ring_.send_and_close(fds[0], payload, sizeof(payload), 9));
+
+    bool sent = false;
+    bool closed = false;
+    UringCompletion completions[4];
+    for (int attempt = 0; attempt < 10 && !(sent && closed); ++attempt) {
+        int count = ring_.wait(completions, 4, 1000);
+        ASSERT_GE(count, 0);
+        for (int i = 0; i < count; ++i) {
+            EXPECT_EQ(completions[i].tag, 9u);
+            if (completions[i].op == UringOp::SEND) {
+                EXPECT_EQ(completions[i].result, 4);
+                sent = true;
+            } else if (completions[i].op == UringOp::CLOSE) {
+                EXPECT_EQ(completions[i].result, 0);
+                closed = true;
+            }
+        }
+    }
+    EXPECT_TRUE(sent);
+    EXPECT_TRUE(closed);
+
+    uint8_t buffer[8];
+    ASSERT_EQ(read(fds[1], buffer, sizeof(buffer)), 4);
+    EXPECT_EQ(buffer[3], 4);
+    EXPECT_EQ(read(fds[1], buffer, sizeof(buffer)), 0);  // Peer closed
+    close(fds[1]);
+}
+
+// Test accept delivers a connection, staying armed only when multishot
+TEST_F(IoUringLoopTest, AcceptConnection) {
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    ASSERT_GE(listener, 0);
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addr_len = sizeof(addr);
+    ASSERT_EQ(bind(listener, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)), 0);
+    ASSERT_EQ(listen(listener, 4), 0);
+    ASSERT_EQ(getsockname(listener, reinterpret_cast<struct sockaddr*>(&addr), &addr_len), 0);
+
+    EXPECT_EQ(ring_.is_multishot(), IoUringLoop::supports_multishot_accept());
+    ASSERT_TRUE(ring_.accept(listener));
+    int client = socket(AF_INET, SOCK_STREAM, 0);
+    ASSERT_EQ(connect(client, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)), 0);
+
+    UringCompletion completions[4];
+    ASSERT_EQ(ring_.wait(completions, 4, 1000), 1);
+    EXPECT_EQ(completions[0].op, UringOp::ACCEPT);
+    EXPECT_GE(completions[0].result, 0);
+    EXPECT_EQ(completions[0].more, ring_.is_multishot());
+    close(completions[0].result);
+    close(client);
+    close(listener);
+}
+
+// Test wakeup interrupts a blocking wait from another thread
+TEST_F(IoUringLoopTest, Wakeup) {
+    std::thread waker([this]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        ring_.wakeup();
+    });
+
+    UringCompletion completions[4];
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(ring_.wait(completions, 4, 5000), 0);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(2));
+
+    waker.join();
+}
+
+// Test the stub refuses to open when io_uring is unavailable
+TEST(IoUringLoopFallbackTest, UnavailableRefusesOpen) {
+    if (IoUringLoop::is_available()) {
+        GTEST_SKIP() << "io_uring available";
+    }
+    IoUringLoop ring;
+    EXPECT_FALSE(ring.open(64));
+    EXPECT_FALSE(ring.is_open());
+}
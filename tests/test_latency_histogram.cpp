@@ -0,0 +1,66 @@
+/*
+ * tests/test_latency_histogram.cpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include "simple_utcd/latency_histogram.hpp"
+
+using namespace simple_utcd;
+
+// Test samples land in the bucket below the next power of two
+TEST(LatencyHistogramTest, BucketBounds) {
+    EXPECT_EQ(LatencyHistogram::bucket_for(0), 0u);
+    EXPECT_EQ(LatencyHistogram::bucket_for(1), 1u);
+    EXPECT_EQ(LatencyHistogram::bucket_for(1023), 10u);
+    EXPECT_EQ(LatencyHistogram::bucket_for(1024), 11u);
+    EXPECT_LT(1023u, LatencyHistogram::bucket_bound_ns(10));
+
+    // Anything past the last bound is kept, not dropped
+    EXPECT_EQ(LatencyHistogram::bucket_for(~0ull), LatencyHistogram::kBuckets - 1);
+}
+
+// Test counts, sum and quantile bounds
+TEST(LatencyHistogramTest, RecordAndQuantile) {
+    LatencyHistogram histogram;
+    EXPECT_EQ(histogram.quantile_bound_ns(0.5), 0u);
+
+    for (int i = 0; i < 90; ++i) {
+        histogram.record(1500);      // Bucket bound 2048
+    }
+    for (int i = 0; i < 10; ++i) {
+        histogram.record(100000);    // Bucket bound 131072
+    }
+
+    EXPECT_EQ(histogram.count(), 100u);
+    EXPECT_EQ(histogram.sum_ns(), 90u * 1500 + 10u * 100000);
+    EXPECT_EQ(histogram.quantile_bound_ns(0.5), 2048u);
+    EXPECT_EQ(histogram.quantile_bound_ns(0.95), 131072u);
+}
+
+// Test absorb sums per-thread histograms
+TEST(LatencyHistogramTest, Absorb) {
+    LatencyHistogram total;
+    LatencyHistogram shard;
+    shard.record(10);
+    shard.record(5000);
+
+    total.absorb(shard);
+    total.absorb(shard);
+    EXPECT_EQ(total.count(), 4u);
+    EXPECT_EQ(total.sum_ns(), 10020u);
+    EXPECT_EQ(total.bucket_count(LatencyHistogram::bucket_for(5000)), 2u);
+}
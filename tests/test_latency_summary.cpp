@@ -0,0 +1,75 @@
+/*
+ * tests/test_latency_summary.cpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include "simple_utcd/latency_summary.hpp"
+
+using namespace simple_utcd;
+
+// Test the EWMA starts at the first sample and moves an eighth per sample
+TEST(LatencySummaryTest, Ewma) {
+    LatencySummary latency;
+    EXPECT_TRUE(latency.empty());
+    EXPECT_EQ(latency.quantile_us(0.5), 0u);
+
+    latency.record(1000);
+    EXPECT_DOUBLE_EQ(latency.ewma_us, 1000.0);
+    latency.record(9000);
+    EXPECT_DOUBLE_EQ(latency.ewma_us, 2000.0);
+    EXPECT_EQ(latency.count, 2u);
+}
+
+// Test quantiles interpolate inside the bucket holding them
+TEST(LatencySummaryTest, Quantiles) {
+    LatencySummary latency;
+    for (int i = 0; i < 90; ++i) {
+        latency.record(1500);        // Bucket [1024, 2048)
+    }
+    for (int i = 0; i < 10; ++i) {
+        latency.record(100000);      // Bucket [65536, 131072)
+    }
+
+    uint64_t p50 = latency.quantile_us(0.5);
+    EXPECT_GE(p50, 1024u);
+    EXPECT_LT(p50, 2048u);
+    uint64_t p95 = latency.quantile_us(0.95);
+    EXPECT_GE(p95, 65536u);
+    EXPECT_LT(p95, 131072u);
+    EXPECT_EQ(latency.quantile_us(1.0), 131072u);
+    EXPECT_LT(latency.quantile_us(0.25), p50);
+
+    // Anything past the last bound is kept, not dropped
+    latency.record(~0ull);
+    EXPECT_EQ(latency.buckets[LatencySummary::kBuckets - 1], 1u);
+}
+
+// Test old samples fade so quantiles follow a changed path
+TEST(LatencySummaryTest, WindowFades) {
+    LatencySummary latency;
+    for (uint32_t i = 0; i < LatencySummary::kWindow; ++i) {
+        latency.record(1000);
+    }
+    EXPECT_LT(latency.quantile_us(0.5), 1024u);
+
+    for (uint32_t i = 0; i < LatencySummary::kWindow; ++i) {
+        latency.record(50000);
+    }
+    EXPECT_LE(latency.count, LatencySummary::kWindow);
+    EXPECT_GE(latency.quantile_us(0.5), 32768u);
+    EXPECT_NEAR(latency.ewma_us, 50000.0, 1.0);
+}
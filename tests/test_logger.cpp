@@ -111,6 +111,19 @@ TEST_F(LoggerTest, SetLevel) {
     // Should not crash
 }
 
+// Test is_enabled follows the configured level
+TEST_F(LoggerTest, IsEnabled) {
+    Logger logger;
+    logger.set_level(LogLevel::WARN);
+    EXPECT_FALSE(logger.is_enabled(LogLevel::DEBUG));
+    EXPECT_FALSE(logger.is_enabled(LogLevel::INFO));
+    EXPECT_TRUE(logger.is_enabled(LogLevel::WARN));
+    EXPECT_TRUE(logger.is_enabled(LogLevel::ERROR));
+
+    logger.set_level(LogLevel::DEBUG);
+    EXPECT_TRUE(logger.is_enabled(LogLevel::DEBUG));
+}
+
 // Test template methods
 TEST_F(LoggerTest, TemplateMethods) {
     Logger logger;
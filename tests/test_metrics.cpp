@@ -227,6 +227,93 @@ TEST_F(MetricsTest, PerformanceMetricsConnectionTracking) {
     EXPECT_EQ(perf.get_total_connections(), 10);
 }
 
+// Test connection counts are pulled from a source when one is set
+TEST_F(MetricsTest, PerformanceMetricsConnectionSource) {
+    PerformanceMetrics perf;
+    perf.update_active_connections(1);
+
+    uint64_t calls = 0;
+    perf.set_connection_source([&calls](uint64_t& active, uint64_t& total) {
+        ++calls;
+        active = 3;
+        total = 5000000000ull;
+    });
+    EXPECT_EQ(perf.get_active_connections(), 3u);
+    EXPECT_EQ(perf.get_total_connections(), 5000000000ull);
+
+    std::string output = perf.export_prometheus();
+    EXPECT_NE(output.find("simple_utcd_active_connections 3\n"), std::string::npos);
+    EXPECT_NE(output.find("simple_utcd_total_connections 5000000000\n"), std::string::npos);
+    EXPECT_GE(calls, 4u);
+}
+
+// Test kernel timestamp delays export as Prometheus histograms
+TEST_F(MetricsTest, PerformanceMetricsTimestampDelays) {
+    PerformanceMetrics perf;
+    EXPECT_EQ(perf.export_prometheus().find("simple_utcd_kernel_rx_delay_seconds"), std::string::npos);
+
+    perf.set_timestamp_delay_source([](LatencyHistogram& rx_delay, LatencyHistogram& tx_delay) {
+        rx_delay.record(500);       // Below the first exported bucket
+        rx_delay.record(3000);
+        tx_delay.record(2000000000000ull);
+    });
+
+    std::string output = perf.export_prometheus();
+    EXPECT_NE(output.find("# TYPE simple_utcd_kernel_rx_delay_seconds histogram\n"), std::string::npos);
+    EXPECT_NE(output.find("simple_utcd_kernel_rx_delay_seconds_bucket{le=\"1.024e-06\"} 1\n"), std::string::npos);
+    EXPECT_NE(output.find("simple_utcd_kernel_rx_delay_seconds_bucket{le=\"4.096e-06\"} 2\n"), std::string::npos);
+    EXPECT_NE(output.find("simple_utcd_kernel_rx_delay_seconds_count 2\n"), std::string::npos);
+    EXPECT_NE(output.find("simple_utcd_kernel_tx_delay_seconds_bucket{le=\"+Inf\"} 1\n"), std::string::npos);
+    EXPECT_NE(output.find("simple_utcd_kernel_tx_delay_seconds_sum 2000\n"), std::string::npos);
+}
+
+// Test upstream latency summaries are exported per upstream
+TEST_F(MetricsTest, PerformanceMetricsUpstreamLatency) {
+    PerformanceMetrics perf;
+    EXPECT_EQ(perf.export_prometheus().find("simple_utcd_upstream_latency"), std::string::npos);
+
+    perf.set_upstream_latency_source([](std::map<std::string, LatencySummary>& latencies) {
+        LatencySummary& latency = latencies["192.0.2.1:123"];
+        for (int i = 0; i < 4; ++i) {
+            latency.record(1500);
+        }
+    });
+
+    std::string output = perf.export_prometheus();
+    EXPECT_NE(output.find("# TYPE simple_utcd_upstream_latency_seconds gauge\n"), std::string::npos);
+    EXPECT_NE(output.find("simple_utcd_upstream_latency_seconds{upstream=\"192.0.2.1:123\",stat=\"ewma\"} 0.0015\n"),
+              std::string::npos);
+    EXPECT_NE(output.find("simple_utcd_upstream_latency_seconds{upstream=\"192.0.2.1:123\",stat=\"p50\"} 0.001536\n"),
+              std::string::npos);
+    EXPECT_NE(output.find("stat=\"p95\"}"), std::string::npos);
+    EXPECT_NE(output.find("simple_utcd_upstream_latency_samples{upstream=\"192.0.2.1:123\"} 4\n"), std::string::npos);
+}
+
+// Test virtual clock tracking error is exported only while the clock is on
+TEST_F(MetricsTest, PerformanceMetricsVirtualClock) {
+    PerformanceMetrics perf;
+    bool enabled = false;
+    perf.set_virtual_clock_source([&enabled](VirtualClock::Stats& stats) {
+        stats.offset_ns = -250000;
+        stats.rms_offset_ns = 40000.0;
+        stats.frequency_ppm = -36.5;
+        stats.updates = 12;
+        stats.steps = 1;
+        return enabled;
+    });
+    EXPECT_EQ(perf.export_prometheus().find("simple_utcd_virtual_clock"), std::string::npos);
+
+    enabled = true;
+    std::string output = perf.export_prometheus();
+    EXPECT_NE(output.find("# TYPE simple_utcd_virtual_clock_offset_seconds gauge\n"), std::string::npos);
+    EXPECT_NE(output.find("simple_utcd_virtual_clock_offset_seconds -0.00025\n"), std::string::npos);
+    EXPECT_NE(output.find("simple_utcd_virtual_clock_rms_offset_seconds 4e-05\n"), std::string::npos);
+    EXPECT_NE(output.find("simple_utcd_virtual_clock_frequency_ppm -36.5\n"), std::string::npos);
+    EXPECT_NE(output.find("simple_utcd_virtual_clock_wander_ppm 0\n"), std::string::npos);
+    EXPECT_NE(output.find("simple_utcd_virtual_clock_updates_total 12\n"), std::string::npos);
+    EXPECT_NE(output.find("simple_utcd_virtual_clock_steps_total 1\n"), std::string::npos);
+}
+
 // Test PerformanceMetrics average response time
 TEST_F(MetricsTest, PerformanceMetricsAverageResponseTime) {
     PerformanceMetrics perf;
@@ -253,3 +340,22 @@ TEST_F(MetricsTest, PerformanceMetricsPrometheusExport) {
     EXPECT_NE(prometheus.find("simple_utcd_active_connections"), std::string::npos);
 }
 
+
+// Test per-thread CPU reporting
+TEST_F(MetricsTest, PerformanceMetricsThreadCpus) {
+    PerformanceMetrics perf;
+    EXPECT_TRUE(perf.get_thread_cpus().empty());
+    EXPECT_EQ(perf.export_prometheus().find("simple_utcd_thread_cpu"), std::string::npos);
+
+    perf.update_thread_cpu("worker-0", 2);
+    perf.update_thread_cpu("worker-1", 3);
+    perf.update_thread_cpu("worker-0", 4);
+
+    auto cpus = perf.get_thread_cpus();
+    ASSERT_EQ(cpus.size(), 2u);
+    EXPECT_EQ(cpus["worker-0"], 4);
+    EXPECT_EQ(cpus["worker-1"], 3);
+
+    std::string prometheus = perf.export_prometheus();
+    EXPECT_NE(prometheus.find("simple_utcd_thread_cpu{thread=\"worker-0\"} 4"), std::string::npos);
+}
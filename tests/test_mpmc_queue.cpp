@@ -0,0 +1,114 @@
+/*
+ * tests/test_mpmc_queue.cpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include "simple_utcd/mpmc_queue.hpp"
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <memory>
+
+using namespace simple_utcd;
+
+// Test capacity is rounded up to a power of two
+TEST(BoundedMPMCQueueTest, CapacityRounding) {
+    BoundedMPMCQueue<int> queue(5);
+    EXPECT_EQ(queue.capacity(), 8u);
+
+    BoundedMPMCQueue<int> small(1);
+    EXPECT_EQ(small.capacity(), 2u);
+}
+
+// Test FIFO order and full/empty reporting
+TEST(BoundedMPMCQueueTest, FullAndEmpty) {
+    BoundedMPMCQueue<int> queue(4);
+    int value = 0;
+    EXPECT_FALSE(queue.try_pop(value));
+
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(queue.try_push(int(i)));
+    }
+    EXPECT_FALSE(queue.try_push(99));
+    EXPECT_EQ(queue.size_approx(), 4u);
+
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(queue.try_pop(value));
+        EXPECT_EQ(value, i);
+    }
+    EXPECT_FALSE(queue.try_pop(value));
+    EXPECT_EQ(queue.size_approx(), 0u);
+}
+
+// Test a rejected push does not consume a move-only value
+TEST(BoundedMPMCQueueTest, FailedPushKeepsValue) {
+    BoundedMPMCQueue<std::unique_ptr<int>> queue(2);
+    EXPECT_TRUE(queue.try_push(std::make_unique<int>(1)));
+    EXPECT_TRUE(queue.try_push(std::make_unique<int>(2)));
+
+    auto extra = std::make_unique<int>(3);
+    EXPECT_FALSE(queue.try_push(std::move(extra)));
+    ASSERT_NE(extra, nullptr);
+    EXPECT_EQ(*extra, 3);
+
+    std::unique_ptr<int> out;
+    ASSERT_TRUE(queue.try_pop(out));
+    EXPECT_EQ(*out, 1);
+}
+
+// Test concurrent producers and consumers deliver every item exactly once
+TEST(BoundedMPMCQueueTest, ConcurrentProducersConsumers) {
+    const int kProducers = 4;
+    const int kConsumers = 4;
+    const int kPerProducer = 20000;
+    BoundedMPMCQueue<int> queue(64);
+
+    std::atomic<long long> sum(0);
+    std::atomic<int> consumed(0);
+    std::vector<std::thread> threads;
+
+    for (int p = 0; p < kProducers; ++p) {
+        threads.emplace_back([&queue, p, kPerProducer]() {
+            for (int i = 1; i <= kPerProducer; ++i) {
+                int value = p * kPerProducer + i;
+                while (!queue.try_push(int(value))) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (int c = 0; c < kConsumers; ++c) {
+        threads.emplace_back([&]() {
+            int value;
+            while (consumed.load() < kProducers * kPerProducer) {
+                if (queue.try_pop(value)) {
+                    sum += value;
+                    consumed++;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    long long n = static_cast<long long>(kProducers) * kPerProducer;
+    EXPECT_EQ(consumed.load(), n);
+    EXPECT_EQ(sum.load(), n * (n + 1) / 2);
+}
@@ -0,0 +1,172 @@
+/*
+ * tests/test_ntp_responder.cpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include "simple_utcd/ntp_responder.hpp"
+#include <cstring>
+#include <ctime>
+
+using namespace simple_utcd;
+
+namespace {
+
+uint64_t read_u64(const uint8_t* data) {
+    uint64_t value = 0;
+    for (int i = 0; i < 8; ++i) {
+        value = (value << 8) | data[i];
+    }
+    return value;
+}
+
+// Client request: version, mode 3, poll 6 and a recognisable transmit time
+void make_request(uint8_t* request, uint8_t version) {
+    std::memset(request, 0, NtpResponder::kPacketSize);
+    request[0] = static_cast<uint8_t>((version << 3) | 3);
+    request[2] = 6;
+    for (int i = 0; i < 8; ++i) {
+        request[40 + i] = static_cast<uint8_t>(0xA0 + i);
+    }
+}
+
+} // namespace
+
+// Test NTP timestamp conversion from Unix time
+TEST(NtpResponderTest, TimestampConversion) {
+    EXPECT_EQ(NtpResponder::to_ntp_time(0, 0), uint64_t(NtpResponder::kUnixEpochOffset) << 32);
+    EXPECT_EQ(NtpResponder::to_ntp_time(0, 500000000) & 0xFFFFFFFFu, 0x80000000u);
+
+    uint64_t now = NtpResponder::now();
+    uint32_t seconds = static_cast<uint32_t>(now >> 32);
+    uint32_t expected = static_cast<uint32_t>(std::time(nullptr) + NtpResponder::kUnixEpochOffset);
+    EXPECT_LE(seconds, expected);
+    EXPECT_GE(seconds + 2, expected);
+}
+
+// Test reference IDs accept an IPv4 address or an ASCII code
+TEST(NtpResponderTest, ReferenceId) {
+    EXPECT_EQ(NtpResponder::encode_reference_id("192.0.2.1"), 0xC0000201u);
+    EXPECT_EQ(NtpResponder::encode_reference_id("GPS"), 0x47505300u);
+    EXPECT_EQ(NtpResponder::encode_reference_id("LOCLX"), 0x4C4F434Cu);
+    EXPECT_EQ(NtpResponder::encode_reference_id("2001:db8::1"), 0x39AB9B37u);  // MD5 prefix
+    EXPECT_EQ(NtpResponder::encode_reference_id(""), 0u);
+}
+
+// Test a client request gets a server reply built from the template
+TEST(NtpResponderTest, BuildsServerReply) {
+    NtpResponder responder;
+    responder.configure(2, "GPS", -24);
+    EXPECT_EQ(responder.get_stratum(), 2);
+    EXPECT_EQ(responder.get_precision(), -24);
+
+    uint8_t request[NtpResponder::kPacketSize];
+    make_request(request, 3);
+
+    uint8_t reply[NtpResponder::kPacketSize];
+    uint64_t receive_time = NtpResponder::to_ntp_time(1700000000, 250000000);
+    ASSERT_TRUE(responder.build_reply(request, sizeof(request), receive_time, reply));
+    NtpResponder::set_transmit_time(reply, receive_time + 1);
+
+    EXPECT_EQ(reply[0] >> 6, 0);            // No leap warning
+    EXPECT_EQ((reply[0] >> 3) & 0x07, 3);   // Client's version echoed
+    EXPECT_EQ(reply[0] & 0x07, 4);          // Server mode
+    EXPECT_EQ(reply[1], 2);
+    EXPECT_EQ(reply[2], 6);                 // Client's poll echoed
+    EXPECT_EQ(static_cast<int8_t>(reply[3]), -24);
+    EXPECT_EQ(std::memcmp(reply + 12, "GPS", 3), 0);
+    EXPECT_EQ(read_u64(reply + 16), receive_time & 0xFFFFFFFF00000000ull);
+    EXPECT_EQ(std::memcmp(reply + 24, request + 40, 8), 0);  // Origin = client transmit
+    EXPECT_EQ(read_u64(reply + 32), receive_time);
+    EXPECT_EQ(read_u64(reply + 40), receive_time + 1);
+}
+
+// Test replies synchronized to an upstream advertise its distance and name
+TEST(NtpResponderTest, SyncStateFromUpstream) {
+    NtpResponder responder;
+    responder.configure(1, "GPS", -20);
+    uint8_t request[NtpResponder::kPacketSize];
+    uint8_t reply[NtpResponder::kPacketSize];
+    make_request(request, 4);
+    uint64_t receive_time = NtpResponder::to_ntp_time(1700000010, 0);
+
+    // Before any upstream update the template's fields stand
+    DisciplineState local;
+    local.leap = 0;
+    local.stratum = 1;
+    ASSERT_TRUE(responder.build_reply(request, sizeof(request), receive_time, reply));
+    NtpResponder::set_sync_state(reply, local);
+    EXPECT_EQ(std::memcmp(reply + 4, "\0\0\0\0\0\0\0\0", 8), 0);
+    EXPECT_EQ(std::memcmp(reply + 12, "GPS", 3), 0);
+
+    DisciplineState synced;
+    synced.leap = 0;
+    synced.stratum = 3;
+    synced.reference_time_ns = 1700000000LL * 1000000000;
+    synced.root_delay_ns = 250000000;       // 0.25 s
+    synced.root_dispersion_ns = 500000000;  // 0.5 s
+    synced.reference_id = 0xC0000201u;
+    ASSERT_TRUE(responder.build_reply(request, sizeof(request), receive_time, reply));
+    NtpResponder::set_sync_state(reply, synced);
+
+    EXPECT_EQ(reply[1], 3);
+    EXPECT_EQ(read_u64(reply + 4) >> 32, 0x4000u);     // Root delay, 16.16
+    // Dispersion grows 15 us per second for the 10 s since the update
+    EXPECT_EQ(read_u64(reply + 4) & 0xFFFFFFFFu, (uint64_t(500150000) << 16) / 1000000000u);
+    EXPECT_EQ(read_u64(reply + 12) >> 32, 0xC0000201u);
+    EXPECT_EQ(read_u64(reply + 16), NtpResponder::to_ntp_time(1700000000, 0));
+    EXPECT_EQ(read_u64(reply + 32), receive_time);
+}
+
+// Test non-client modes, bad versions and short packets are refused
+TEST(NtpResponderTest, RejectsInvalidRequests) {
+    NtpResponder responder;
+    responder.configure(2, "UTC", -20);
+    uint8_t request[NtpResponder::kPacketSize];
+    uint8_t reply[NtpResponder::kPacketSize];
+
+    make_request(request, 4);
+    EXPECT_FALSE(responder.build_reply(request, 47, 0, reply));
+
+    request[0] = (4 << 3) | 4;  // Server mode
+    EXPECT_FALSE(responder.build_reply(request, sizeof(request), 0, reply));
+
+    make_request(request, 0);
+    EXPECT_FALSE(responder.build_reply(request, sizeof(request), 0, reply));
+
+    make_request(request, 5);
+    EXPECT_FALSE(responder.build_reply(request, sizeof(request), 0, reply));
+}
+
+// Test an out-of-range stratum advertises an unsynchronized server
+TEST(NtpResponderTest, UnsynchronizedStratum) {
+    NtpResponder responder;
+    responder.configure(0, "UTC", -20);
+    EXPECT_EQ(responder.get_stratum(), 16);
+
+    uint8_t request[NtpResponder::kPacketSize];
+    uint8_t reply[NtpResponder::kPacketSize];
+    make_request(request, 4);
+    ASSERT_TRUE(responder.build_reply(request, sizeof(request), 0, reply));
+    EXPECT_EQ(reply[0] >> 6, 3);
+}
+
+// Test the measured precision is a plausible power of two
+TEST(NtpResponderTest, MeasuredPrecision) {
+    int precision = NtpResponder::measure_precision();
+    EXPECT_LE(precision, 0);
+    EXPECT_GE(precision, -32);
+}
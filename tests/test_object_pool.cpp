@@ -0,0 +1,113 @@
+/*
+ * tests/test_object_pool.cpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include "simple_utcd/object_pool.hpp"
+#include "simple_utcd/mpmc_queue.hpp"
+#include <thread>
+#include <vector>
+#include <atomic>
+
+using namespace simple_utcd;
+
+namespace {
+
+struct Tracked {
+    static std::atomic<int> live;
+
+    explicit Tracked(int value) : value(value) { live++; }
+    ~Tracked() { live--; }
+
+    int value;
+};
+
+std::atomic<int> Tracked::live(0);
+
+} // namespace
+
+// Test released slots are reused and objects are constructed and destroyed
+TEST(ObjectPoolTest, ReusesSlots) {
+    ObjectPool<Tracked> pool(2);
+    EXPECT_EQ(pool.capacity(), 2u);
+    EXPECT_EQ(pool.available(), 2u);
+
+    Tracked* first_address;
+    {
+        auto first = pool.acquire(7);
+        EXPECT_EQ(first->value, 7);
+        EXPECT_EQ(Tracked::live.load(), 1);
+        EXPECT_EQ(pool.available(), 1u);
+        first_address = first.get();
+    }
+    EXPECT_EQ(Tracked::live.load(), 0);
+    EXPECT_EQ(pool.available(), 2u);
+
+    // Two acquisitions cover both slots, one of which is the old one
+    auto a = pool.acquire(1);
+    auto b = pool.acquire(2);
+    EXPECT_TRUE(a.get() == first_address || b.get() == first_address);
+    EXPECT_EQ(pool.get_heap_fallbacks(), 0u);
+}
+
+// Test an exhausted pool falls back to the heap
+TEST(ObjectPoolTest, HeapFallback) {
+    ObjectPool<Tracked> pool(1);
+    auto pooled = pool.acquire(1);
+    auto spilled = pool.acquire(2);
+    ASSERT_TRUE(spilled);
+    EXPECT_EQ(spilled->value, 2);
+    EXPECT_EQ(pool.get_heap_fallbacks(), 1u);
+
+    spilled.reset();
+    pooled.reset();
+    EXPECT_EQ(Tracked::live.load(), 0);
+    EXPECT_EQ(pool.available(), 1u);    // The heap object did not join the pool
+}
+
+// Test objects acquired on one thread can be released on another
+TEST(ObjectPoolTest, CrossThreadRelease) {
+    const int kObjects = 10000;
+    ObjectPool<Tracked> pool(16);
+    BoundedMPMCQueue<ObjectPool<Tracked>::Ptr> handoff(8);
+    std::atomic<int> sum(0);
+
+    std::thread consumer([&]() {
+        ObjectPool<Tracked>::Ptr object;
+        for (int received = 0; received < kObjects;) {
+            if (handoff.try_pop(object)) {
+                sum += object->value;
+                object.reset();
+                ++received;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    for (int i = 0; i < kObjects; ++i) {
+        auto object = pool.acquire(1);
+        while (!handoff.try_push(std::move(object))) {
+            std::this_thread::yield();
+        }
+    }
+    consumer.join();
+
+    EXPECT_EQ(sum.load(), kObjects);
+    EXPECT_EQ(Tracked::live.load(), 0);
+    EXPECT_EQ(pool.available(), pool.capacity());
+}
@@ -0,0 +1,91 @@
+/*
+ * tests/test_server_stats.cpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include "simple_utcd/server_stats.hpp"
+#include <thread>
+#include <vector>
+#include <memory>
+
+using namespace simple_utcd;
+
+// Test blocks never share a cache line
+TEST(StatsBlockTest, CacheLineAligned) {
+    EXPECT_EQ(alignof(StatsBlock), 64u);
+    EXPECT_EQ(sizeof(StatsBlock) % 64, 0u);
+
+    StatsBlock blocks[2];
+    auto first = reinterpret_cast<uintptr_t>(&blocks[0]);
+    auto second = reinterpret_cast<uintptr_t>(&blocks[1]);
+    EXPECT_GE(second - first, 64u);
+}
+
+// Test counters are 64-bit and do not wrap at the int range
+TEST(StatsBlockTest, SixtyFourBitCounters) {
+    StatsBlock block;
+    StatsBlock::add(block.packets_sent, 0xFFFFFFFFull);
+    StatsBlock::add(block.packets_sent, 2);
+    EXPECT_EQ(StatsBlock::read(block.packets_sent), 0x100000001ull);
+}
+
+// Test absorb folds every counter of a retired block
+TEST(StatsBlockTest, Absorb) {
+    StatsBlock retired;
+    StatsBlock worker;
+    StatsBlock::add(worker.connections_opened, 5);
+    StatsBlock::add(worker.connections_closed, 4);
+    StatsBlock::add(worker.packets_sent, 5);
+    StatsBlock::add(worker.datagrams_rejected, 1);
+
+    retired.absorb(worker);
+    retired.absorb(worker);
+    EXPECT_EQ(StatsBlock::read(retired.connections_opened), 10u);
+    EXPECT_EQ(StatsBlock::read(retired.connections_closed), 8u);
+    EXPECT_EQ(StatsBlock::read(retired.packets_sent), 10u);
+    EXPECT_EQ(StatsBlock::read(retired.datagrams_rejected), 2u);
+    EXPECT_EQ(StatsBlock::read(retired.handoff_rejections), 0u);
+}
+
+// Test one writer per block sums exactly across threads
+TEST(StatsBlockTest, PerThreadBlocksSum) {
+    const int kThreads = 4;
+    const uint64_t kIncrements = 100000;
+    std::vector<std::unique_ptr<StatsBlock>> blocks;
+    for (int i = 0; i < kThreads; ++i) {
+        blocks.push_back(std::make_unique<StatsBlock>());
+    }
+
+    std::vector<std::thread> writers;
+    for (int i = 0; i < kThreads; ++i) {
+        StatsBlock* block = blocks[i].get();
+        writers.emplace_back([block, kIncrements]() {
+            for (uint64_t n = 0; n < kIncrements; ++n) {
+                StatsBlock::add(block->packets_sent);
+            }
+        });
+    }
+    for (auto& writer : writers) {
+        writer.join();
+    }
+
+    uint64_t total = 0;
+    for (const auto& block : blocks) {
+        total += StatsBlock::read(block->packets_sent);
+    }
+    EXPECT_EQ(total, kThreads * kIncrements);
+}
@@ -0,0 +1,123 @@
+/*
+ * tests/test_time_publisher.cpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include "simple_utcd/time_publisher.hpp"
+#include "simple_utcd/utc_packet.hpp"
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <cstring>
+
+using namespace simple_utcd;
+
+// Test a fresh publisher already holds the current time
+TEST(TimePublisherTest, PublishesOnConstruction) {
+    TimePublisher publisher;
+    uint32_t now = UTCPacket::get_current_utc_timestamp();
+    EXPECT_LE(publisher.get_seconds(), now);
+    EXPECT_GE(publisher.get_seconds() + 1, now);
+    EXPECT_FALSE(publisher.is_running());
+}
+
+// Test the cached wire form matches the seconds value
+TEST(TimePublisherTest, EncodedMatchesSeconds) {
+    TimePublisher publisher;
+    uint8_t cached[4];
+    uint8_t expected[4];
+    publisher.encode_rfc868(cached);
+    UTCPacket::encode_timestamp(publisher.get_seconds(), expected);
+    EXPECT_EQ(0, memcmp(cached, expected, sizeof(cached)));
+}
+
+// Test start/stop lifecycle
+TEST(TimePublisherTest, StartStop) {
+    TimePublisher publisher;
+    EXPECT_TRUE(publisher.start());
+    EXPECT_TRUE(publisher.is_running());
+    EXPECT_FALSE(publisher.start());
+
+    auto start = std::chrono::steady_clock::now();
+    publisher.stop();
+    EXPECT_FALSE(publisher.is_running());
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(500));
+}
+
+// Test the tick thread advances the published second
+TEST(TimePublisherTest, TicksEachSecond) {
+    TimePublisher publisher;
+    ASSERT_TRUE(publisher.start());
+    uint32_t first = publisher.get_seconds();
+    uint64_t refreshes = publisher.get_refresh_count();
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(1200));
+    EXPECT_GT(publisher.get_seconds(), first);
+    EXPECT_GT(publisher.get_refresh_count(), refreshes);
+
+    uint32_t now = UTCPacket::get_current_utc_timestamp();
+    EXPECT_LE(publisher.get_seconds(), now);
+    EXPECT_GE(publisher.get_seconds() + 1, now);
+    publisher.stop();
+}
+
+// Test an attached discipline shifts the published second
+TEST(TimePublisherTest, AppliesDiscipline) {
+    DisciplinePublisher discipline;
+    DisciplineState state;
+    state.offset_ns = 3600LL * 1000000000;
+    discipline.publish(state);
+
+    TimePublisher publisher;
+    publisher.set_discipline(&discipline);
+    publisher.refresh();
+
+    uint32_t now = UTCPacket::get_current_utc_timestamp();
+    EXPECT_GE(publisher.get_seconds(), now + 3600);
+    EXPECT_LE(publisher.get_seconds(), now + 3601);
+}
+
+// Test concurrent refreshes never take the served second back
+TEST(TimePublisherTest, ConcurrentRefreshIsMonotonic) {
+    TimePublisher publisher;
+    ASSERT_TRUE(publisher.start());
+
+    std::atomic<bool> done{false};
+    auto refresher = [&publisher, &done]() {
+        while (!done) {
+            publisher.refresh();
+        }
+    };
+    std::thread first(refresher);
+    std::thread second(refresher);
+
+    // Long enough to cross at least one second boundary
+    uint32_t last = publisher.get_seconds();
+    bool went_back = false;
+    auto until = std::chrono::steady_clock::now() + std::chrono::milliseconds(1200);
+    while (std::chrono::steady_clock::now() < until) {
+        uint32_t seconds = publisher.get_seconds();
+        went_back = went_back || seconds < last;
+        last = seconds;
+    }
+    done = true;
+    first.join();
+    second.join();
+    publisher.stop();
+
+    EXPECT_FALSE(went_back);
+}
@@ -0,0 +1,126 @@
+/*
+ * tests/test_time_source.cpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include "simple_utcd/time_source.hpp"
+#include "simple_utcd/rate_limiter.hpp"
+#include "simple_utcd/ddos_protection.hpp"
+#include "simple_utcd/utc_packet.hpp"
+#include <chrono>
+
+using namespace simple_utcd;
+
+class TimeSourceTest : public ::testing::Test {
+protected:
+    void TearDown() override {
+        TimeSource::install(nullptr);
+    }
+
+    ManualTimeSource clock_;
+};
+
+// Test coarse reads trail the precise ones by at most a kernel tick
+TEST_F(TimeSourceTest, CoarseReadsTrackPreciseReads) {
+    const TimeSource& source = TimeSource::system();
+
+    auto wall = source.now();
+    auto coarse_wall = source.coarse_now();
+    EXPECT_LT(std::chrono::abs(coarse_wall - wall), std::chrono::milliseconds(50));
+
+    auto steady = source.steady_now();
+    auto coarse_steady = source.coarse_steady_now();
+    EXPECT_LT(std::chrono::abs(coarse_steady - steady), std::chrono::milliseconds(50));
+
+    int64_t raw = source.raw_now_ns();
+    EXPECT_GT(raw, 0);
+    EXPECT_GE(source.raw_now_ns(), raw);
+}
+
+// Test the real clocks are current until a source is installed, and again after
+TEST_F(TimeSourceTest, InstallAndRestore) {
+    EXPECT_EQ(&TimeSource::current(), &TimeSource::system());
+
+    TimeSource::install(&clock_);
+    EXPECT_EQ(&TimeSource::current(), &clock_);
+
+    TimeSource::install(nullptr);
+    EXPECT_EQ(&TimeSource::current(), &TimeSource::system());
+}
+
+// Test a manual source only moves when advanced, on both clocks
+TEST_F(TimeSourceTest, ManualSourceAdvances) {
+    auto wall = clock_.now();
+    auto steady = clock_.steady_now();
+    int64_t raw = clock_.raw_now_ns();
+    EXPECT_EQ(clock_.now(), wall);
+    EXPECT_EQ(clock_.coarse_now(), wall);
+    EXPECT_EQ(clock_.coarse_steady_now(), steady);
+
+    clock_.advance(std::chrono::milliseconds(1500));
+    EXPECT_EQ(clock_.now() - wall, std::chrono::milliseconds(1500));
+    EXPECT_EQ(clock_.steady_now() - steady, std::chrono::milliseconds(1500));
+    EXPECT_EQ(clock_.raw_now_ns() - raw, 1500000000);
+
+    // A wall-clock step leaves the steady clock alone
+    clock_.set_wall_time(wall - std::chrono::hours(1));
+    EXPECT_EQ(clock_.now(), wall - std::chrono::hours(1));
+    EXPECT_EQ(clock_.steady_now() - steady, std::chrono::milliseconds(1500));
+}
+
+// Test the time served to clients follows an installed source
+TEST_F(TimeSourceTest, ServedTimeFollowsSource) {
+    TimeSource::install(&clock_);
+    uint32_t before = UTCPacket::get_current_utc_timestamp();
+
+    clock_.advance(std::chrono::seconds(10));
+    EXPECT_EQ(UTCPacket::get_current_utc_timestamp(), before + 10);
+}
+
+// Test token refill follows an installed source without sleeping
+TEST_F(TimeSourceTest, RateLimiterRefillsOnInjectedClock) {
+    TimeSource::install(&clock_);
+
+    RateLimiter limiter;
+    limiter.set_enabled(true);
+    limiter.set_global_rate(1000);
+    limiter.set_global_burst(1000);
+
+    const std::string client = "192.168.1.10";
+    for (int i = 0; i < 5; ++i) {
+        EXPECT_TRUE(limiter.check_limit(client, 5, 5).allowed);
+    }
+    EXPECT_FALSE(limiter.check_limit(client, 5, 5).allowed);
+
+    clock_.advance(std::chrono::seconds(1));
+    EXPECT_TRUE(limiter.check_limit(client, 5, 5).allowed);
+}
+
+// Test a block lapses when the injected clock passes its expiry
+TEST_F(TimeSourceTest, DDoSBlockExpiresOnInjectedClock) {
+    TimeSource::install(&clock_);
+
+    DDoSProtection protection;
+    protection.block_client("10.0.0.5", 60);
+    EXPECT_TRUE(protection.is_blocked("10.0.0.5"));
+
+    clock_.advance(std::chrono::seconds(59));
+    EXPECT_TRUE(protection.is_blocked("10.0.0.5"));
+
+    clock_.advance(std::chrono::seconds(2));
+    EXPECT_FALSE(protection.is_blocked("10.0.0.5"));
+}
@@ -18,8 +18,13 @@
 
 #include <gtest/gtest.h>
 #include "simple_utcd/upstream_manager.hpp"
+#include "stand_in_ntp_server.hpp"
+#include <atomic>
+#include <string>
 #include <thread>
 #include <chrono>
+#include <memory>
+#include <vector>
 
 using namespace simple_utcd;
 
@@ -61,11 +66,11 @@ TEST_F(UpstreamManagerTest, SelectionStrategies) {
     manager_.add_server("server2", 37, 2);
     
     manager_.set_selection_strategy(SelectionStrategy::ROUND_ROBIN);
-    UpstreamServer* server1 = manager_.select_server();
+    UpstreamHandle server1 = manager_.select_server();
     EXPECT_NE(server1, nullptr);
     
     manager_.set_selection_strategy(SelectionStrategy::PRIORITY);
-    UpstreamServer* server2 = manager_.select_server();
+    UpstreamHandle server2 = manager_.select_server();
     EXPECT_NE(server2, nullptr);
 }
 
@@ -74,11 +79,11 @@ TEST_F(UpstreamManagerTest, PrimaryBackupSelection) {
     manager_.add_server("primary", 37, 10);
     manager_.add_server("backup", 37, 5);
     
-    UpstreamServer* primary = manager_.get_primary_server();
+    UpstreamHandle primary = manager_.get_primary_server();
     EXPECT_NE(primary, nullptr);
     EXPECT_EQ(primary->address, "primary");
     
-    UpstreamServer* backup = manager_.get_backup_server();
+    UpstreamHandle backup = manager_.get_backup_server();
     EXPECT_NE(backup, nullptr);
     EXPECT_EQ(backup->address, "backup");
 }
@@ -180,8 +185,8 @@ TEST_F(UpstreamManagerTest, RoundRobinSelection) {
     manager_.add_server("server1", 37);
     manager_.add_server("server2", 37);
     
-    UpstreamServer* s1 = manager_.select_server();
-    UpstreamServer* s2 = manager_.select_server();
+    UpstreamHandle s1 = manager_.select_server();
+    UpstreamHandle s2 = manager_.select_server();
     
     // Should cycle through servers
     EXPECT_NE(s1, nullptr);
@@ -197,7 +202,7 @@ TEST_F(UpstreamManagerTest, HealthBasedSelection) {
     manager_.record_success("server1", 50);
     manager_.record_success("server2", 100);
     
-    UpstreamServer* selected = manager_.select_server();
+    UpstreamHandle selected = manager_.select_server();
     EXPECT_NE(selected, nullptr);
     // Should prefer server1 (lower latency)
     EXPECT_EQ(selected->address, "server1");
@@ -209,8 +214,236 @@ TEST_F(UpstreamManagerTest, PriorityBasedSelection) {
     manager_.add_server("server1", 37, 1);
     manager_.add_server("server2", 37, 10);
     
-    UpstreamServer* selected = manager_.select_server();
+    UpstreamHandle selected = manager_.select_server();
     EXPECT_NE(selected, nullptr);
     EXPECT_EQ(selected->address, "server2");  // Higher priority
 }
 
+
+// Test a health sweep probes every upstream at once: one RTT, not fifty
+TEST_F(UpstreamManagerTest, ConcurrentHealthSweep) {
+    std::vector<std::unique_ptr<StandInServer>> upstreams;
+    for (int i = 1; i <= 50; ++i) {
+        upstreams.push_back(std::make_unique<StandInServer>("127.0.0." + std::to_string(i)));
+        upstreams.back()->network_delay = std::chrono::milliseconds(100);
+        upstreams.back()->start();
+        UpstreamServer server = upstreams.back()->upstream();
+        manager_.add_server(server.address, server.port);
+    }
+    manager_.set_health_check_interval(0);
+
+    auto start = std::chrono::steady_clock::now();
+    manager_.check_all_servers_health();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    EXPECT_LT(elapsed, std::chrono::milliseconds(1000));  // Serially: 5 s
+    for (const auto& server : manager_.get_servers()) {
+        EXPECT_EQ(server.success_count, 1u) << server.address;
+        EXPECT_GE(server.response_time_ms, 100u);
+    }
+}
+
+// Test the concurrency limit bounds probes in flight
+TEST_F(UpstreamManagerTest, ProbeConcurrencyLimit) {
+    std::vector<std::unique_ptr<StandInServer>> upstreams;
+    for (int i = 1; i <= 4; ++i) {
+        upstreams.push_back(std::make_unique<StandInServer>("127.0.0." + std::to_string(i)));
+        upstreams.back()->network_delay = std::chrono::milliseconds(60);
+        upstreams.back()->start();
+        UpstreamServer server = upstreams.back()->upstream();
+        manager_.add_server(server.address, server.port);
+    }
+    manager_.set_health_check_interval(0);
+    manager_.set_probe_concurrency(2);
+    EXPECT_EQ(manager_.get_probe_concurrency(), 2u);
+
+    auto start = std::chrono::steady_clock::now();
+    manager_.check_all_servers_health();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    // Two waves of two
+    EXPECT_GE(elapsed, std::chrono::milliseconds(120));
+    EXPECT_EQ(manager_.get_healthy_server_count(), 4u);
+}
+
+// Test selection and removal proceed while a sweep waits on the network
+TEST_F(UpstreamManagerTest, SweepDoesNotHoldTableLock) {
+    StandInServer silent("127.0.0.1");
+    silent.silent = true;
+    silent.start();
+    StandInServer answering("127.0.0.2");
+    answering.start();
+    manager_.add_server("127.0.0.1", silent.port());
+    manager_.add_server("127.0.0.2", answering.port());
+    manager_.record_success("127.0.0.2", 5);
+    manager_.set_health_check_interval(0);
+    manager_.set_timeout(500);
+
+    std::thread sweep([this]() { manager_.check_all_servers_health(); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_NE(manager_.select_server(), nullptr);
+    EXPECT_TRUE(manager_.remove_server("127.0.0.1"));
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(100));
+    sweep.join();
+
+    // The removed server's result is dropped; the other's is merged
+    EXPECT_EQ(manager_.get_total_server_count(), 1u);
+    EXPECT_EQ(manager_.get_servers()[0].success_count, 2u);
+}
+
+// Test ranking follows selection, with down servers last and disabled ones out
+TEST_F(UpstreamManagerTest, RankServers) {
+    manager_.add_server("slow", 123);
+    manager_.add_server("fast", 123);
+    manager_.add_server("down", 123);
+    manager_.add_server("off", 123);
+    manager_.record_success("slow", 80);
+    manager_.record_success("fast", 5);
+    manager_.record_success("down", 900);
+    manager_.disable_server("off");
+
+    auto ranked = manager_.rank_servers();
+    ASSERT_EQ(ranked.size(), 3u);
+    EXPECT_EQ(ranked[0].address, "fast");
+    EXPECT_EQ(ranked[1].address, "slow");
+    EXPECT_EQ(ranked[2].address, "down");
+    EXPECT_EQ(manager_.select_server()->address, ranked[0].address);
+}
+
+// Test ranking under round robin does not advance it
+TEST_F(UpstreamManagerTest, RankServersRoundRobinWithoutSideEffects) {
+    manager_.set_selection_strategy(SelectionStrategy::ROUND_ROBIN);
+    manager_.add_server("a", 123);
+    manager_.add_server("b", 123);
+    manager_.add_server("c", 123);
+    manager_.record_results({{"a", true, std::chrono::microseconds(5000)},
+                             {"b", true, std::chrono::microseconds(5000)},
+                             {"c", true, std::chrono::microseconds(5000)},
+                             {"gone", false, std::chrono::microseconds(0)}});
+    EXPECT_EQ(manager_.get_servers()[2].success_count, 1u);
+
+    EXPECT_EQ(manager_.select_server()->address, "a");
+    for (int i = 0; i < 3; ++i) {
+        auto ranked = manager_.rank_servers();
+        ASSERT_EQ(ranked.size(), 3u);
+        EXPECT_EQ(ranked[0].address, "b");
+        EXPECT_EQ(ranked[2].address, "a");
+    }
+    EXPECT_EQ(manager_.select_server()->address, "b");
+}
+
+// Test latency ranking uses the distribution, not the last sample
+TEST_F(UpstreamManagerTest, LatencyRankingIgnoresOutlier) {
+    manager_.add_server("steady", 123);
+    manager_.add_server("slower", 123);
+    for (int i = 0; i < 20; ++i) {
+        manager_.record_success("steady", std::chrono::microseconds(2000));
+        manager_.record_success("slower", std::chrono::microseconds(6000));
+    }
+    manager_.record_success("steady", std::chrono::microseconds(90000));  // One spike
+
+    manager_.set_selection_strategy(SelectionStrategy::LEAST_LATENCY);
+    EXPECT_EQ(manager_.select_server()->address, "steady");
+    manager_.set_selection_strategy(SelectionStrategy::HEALTH_BASED);
+    EXPECT_EQ(manager_.select_server()->address, "steady");
+    EXPECT_EQ(manager_.get_server_status("steady"), ServerStatus::HEALTHY);
+
+    auto servers = manager_.get_servers();
+    EXPECT_EQ(servers[1].address, "steady");
+    EXPECT_EQ(servers[1].response_time_ms, 90u);
+    EXPECT_EQ(servers[1].latency.count, 21u);
+    EXPECT_LT(servers[1].latency.quantile_us(0.5), 4096u);
+}
+
+// Test the tail decides between servers with the same median
+TEST_F(UpstreamManagerTest, HealthBasedPrefersLowerTail) {
+    manager_.add_server("jittery", 123);
+    manager_.add_server("tight", 123);
+    for (int i = 0; i < 20; ++i) {
+        manager_.record_success("jittery", std::chrono::microseconds(i % 5 == 0 ? 60000 : 3000));
+        manager_.record_success("tight", std::chrono::microseconds(3500));
+    }
+
+    manager_.set_selection_strategy(SelectionStrategy::HEALTH_BASED);
+    EXPECT_EQ(manager_.select_server()->address, "tight");
+}
+
+// Test intersection selection skips falsetickers until none are left
+TEST_F(UpstreamManagerTest, IntersectionSkipsFalsetickers) {
+    SelectionStrategy strategy = SelectionStrategy::ROUND_ROBIN;
+    EXPECT_TRUE(UpstreamManager::parse_selection_strategy("intersection", strategy));
+    EXPECT_EQ(strategy, SelectionStrategy::INTERSECTION);
+    EXPECT_FALSE(UpstreamManager::parse_selection_strategy("marzullo", strategy));
+    manager_.set_selection_strategy(strategy);
+    EXPECT_EQ(manager_.get_selection_strategy(), SelectionStrategy::INTERSECTION);
+
+    manager_.add_server("fast", 123);
+    manager_.add_server("steady", 123);
+    manager_.record_success("fast", 2);
+    manager_.record_success("steady", 20);
+    EXPECT_EQ(manager_.select_server()->address, "fast");
+
+    manager_.set_falsetickers({"fast"});
+    EXPECT_EQ(manager_.select_server()->address, "steady");
+    EXPECT_EQ(manager_.rank_servers()[0].address, "steady");
+
+    manager_.set_falsetickers({"fast", "steady"});
+    EXPECT_NE(manager_.select_server(), nullptr);
+    manager_.set_falsetickers({});
+    EXPECT_EQ(manager_.select_server()->address, "fast");
+}
+
+// Test a selected server stays readable after it is removed
+TEST_F(UpstreamManagerTest, HandleOutlivesRemoval) {
+    manager_.add_server("server1", 123, 5);
+    manager_.record_success("server1", 10);
+
+    UpstreamHandle selected = manager_.select_server();
+    ASSERT_NE(selected, nullptr);
+    EXPECT_TRUE(manager_.remove_server("server1"));
+    manager_.clear_servers();
+
+    EXPECT_EQ(selected->address, "server1");
+    EXPECT_EQ(selected->port, 123);
+    EXPECT_EQ(selected->response_time_ms, 10u);
+    EXPECT_EQ(manager_.select_server(), nullptr);
+}
+
+// Test selection sees consistent tables while writers churn them
+TEST_F(UpstreamManagerTest, ConcurrentSelectionDuringChurn) {
+    manager_.add_server("stable", 123, 1);
+    manager_.record_success("stable", 5);
+
+    std::atomic<bool> stop{false};
+    std::thread writer([this, &stop]() {
+        for (int i = 0; !stop.load(); ++i) {
+            std::string address = "churn" + std::to_string(i % 8);
+            manager_.add_server(address, 123);
+            manager_.record_success(address, 1 + i % 50);
+            manager_.remove_server(address);
+        }
+    });
+
+    std::vector<std::thread> readers;
+    std::atomic<int> misses{0};
+    for (int r = 0; r < 4; ++r) {
+        readers.emplace_back([this, &misses]() {
+            for (int i = 0; i < 20000; ++i) {
+                UpstreamHandle selected = manager_.select_server();
+                if (!selected || selected->address.empty() || selected->port != 123) {
+                    misses++;
+                }
+            }
+        });
+    }
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    stop = true;
+    writer.join();
+
+    EXPECT_EQ(misses.load(), 0);
+    EXPECT_EQ(manager_.get_total_server_count(), 1u);
+}
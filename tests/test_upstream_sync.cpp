@@ -0,0 +1,361 @@
+/*
+ * tests/test_upstream_sync.cpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include "simple_utcd/upstream_sync.hpp"
+#include "stand_in_ntp_server.hpp"
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace simple_utcd;
+
+// Test NTP timestamp differences are signed and survive an era wrap
+TEST(UpstreamSyncTest, NtpDifference) {
+    uint64_t one_second = 1ull << 32;
+    EXPECT_EQ(UpstreamSync::ntp_difference_ns(5 * one_second, 3 * one_second), 2000000000);
+    EXPECT_EQ(UpstreamSync::ntp_difference_ns(3 * one_second, 5 * one_second), -2000000000);
+    EXPECT_EQ(UpstreamSync::ntp_difference_ns(one_second / 2, 0), 500000000);
+    EXPECT_EQ(UpstreamSync::ntp_difference_ns(0, one_second / 2), -500000000);
+
+    // Second 0 of era 1 is one second after the last second of era 0
+    EXPECT_EQ(UpstreamSync::ntp_difference_ns(0, 0xFFFFFFFFull << 32), 1000000000);
+}
+
+// Test upstream entries parse with and without ports
+TEST(UpstreamSyncTest, ParseUpstream) {
+    std::string host;
+    int port = 0;
+    ASSERT_TRUE(UpstreamSync::parse_upstream("time.example.com", 123, host, port));
+    EXPECT_EQ(host, "time.example.com");
+    EXPECT_EQ(port, 123);
+
+    ASSERT_TRUE(UpstreamSync::parse_upstream("10.0.0.1:1123", 123, host, port));
+    EXPECT_EQ(host, "10.0.0.1");
+    EXPECT_EQ(port, 1123);
+
+    ASSERT_TRUE(UpstreamSync::parse_upstream("[2001:db8::1]:8123", 123, host, port));
+    EXPECT_EQ(host, "2001:db8::1");
+    EXPECT_EQ(port, 8123);
+
+    ASSERT_TRUE(UpstreamSync::parse_upstream("2001:db8::1", 123, host, port));
+    EXPECT_EQ(host, "2001:db8::1");
+    EXPECT_EQ(port, 123);
+
+    EXPECT_FALSE(UpstreamSync::parse_upstream("host:notaport", 123, host, port));
+    EXPECT_FALSE(UpstreamSync::parse_upstream("host:70000", 123, host, port));
+    EXPECT_FALSE(UpstreamSync::parse_upstream("[::1", 123, host, port));
+    EXPECT_FALSE(UpstreamSync::parse_upstream("", 123, host, port));
+}
+
+// Test offset follows the upstream's clock and delay excludes its processing
+TEST(UpstreamSyncTest, MeasuresOffsetAndDelay) {
+    StandInServer upstream;
+    upstream.offset_ns = 2000000000;
+    upstream.processing_delay = std::chrono::milliseconds(50);
+    upstream.stratum = 2;
+    upstream.start();
+
+    auto samples = UpstreamSync::query({upstream.upstream()}, std::chrono::milliseconds(1000));
+    ASSERT_EQ(samples.size(), 1u);
+    ASSERT_TRUE(samples[0].valid) << samples[0].error;
+    EXPECT_NEAR(static_cast<double>(samples[0].offset_ns), 2e9, 20e6);
+    EXPECT_GE(samples[0].delay_ns, 0);
+    EXPECT_LT(samples[0].delay_ns, 40000000);
+    EXPECT_EQ(samples[0].stratum, 2);
+    EXPECT_EQ(samples[0].leap, 0);
+    EXPECT_GT(samples[0].local_time_ns, 0);
+}
+
+// Test slow upstreams are waited on together, not one after another
+TEST(UpstreamSyncTest, QueriesInParallel) {
+    std::vector<std::unique_ptr<StandInServer>> upstreams;
+    std::vector<UpstreamServer> servers;
+    for (int i = 0; i < 4; ++i) {
+        upstreams.push_back(std::make_unique<StandInServer>());
+        upstreams.back()->network_delay = std::chrono::milliseconds(200);
+        upstreams.back()->start();
+        servers.push_back(upstreams.back()->upstream());
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    auto samples = UpstreamSync::query(servers, std::chrono::milliseconds(2000));
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    for (const auto& sample : samples) {
+        EXPECT_TRUE(sample.valid) << sample.error;
+        EXPECT_GE(sample.delay_ns, 200000000);
+    }
+    EXPECT_LT(elapsed, std::chrono::milliseconds(600));  // Serially: 800 ms
+}
+
+// Test a silent upstream costs the timeout and not the other samples
+TEST(UpstreamSyncTest, SilentUpstreamTimesOut) {
+    StandInServer answering;
+    answering.start();
+    StandInServer silent;
+    silent.silent = true;
+    silent.start();
+
+    auto start = std::chrono::steady_clock::now();
+    auto samples = UpstreamSync::query({silent.upstream(), answering.upstream()},
+                                       std::chrono::milliseconds(300));
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    EXPECT_FALSE(samples[0].valid);
+    EXPECT_EQ(samples[0].error, "Timed out");
+    EXPECT_TRUE(samples[1].valid) << samples[1].error;
+    EXPECT_GE(elapsed, std::chrono::milliseconds(300));
+    EXPECT_LT(elapsed, std::chrono::milliseconds(1000));
+}
+
+// Test kiss-o'-death and unsynchronized replies are not samples
+TEST(UpstreamSyncTest, RejectsUnusableReplies) {
+    StandInServer kiss;
+    kiss.stratum = 0;
+    kiss.start();
+    StandInServer unsynchronized;
+    unsynchronized.leap = 3;
+    unsynchronized.start();
+
+    auto samples = UpstreamSync::query({kiss.upstream(), unsynchronized.upstream()},
+                                       std::chrono::milliseconds(1000));
+    EXPECT_FALSE(samples[0].valid);
+    EXPECT_EQ(samples[0].error, "Kiss-o'-death RATE");
+    EXPECT_FALSE(samples[1].valid);
+    EXPECT_EQ(samples[1].error, "Upstream is unsynchronized");
+}
+
+// Test a round records every result with the manager and picks the nearest
+TEST(UpstreamSyncTest, SampleAllRecordsResults) {
+    StandInServer near;
+    near.offset_ns = 1000000;
+    near.start();
+    StandInServer far;
+    far.network_delay = std::chrono::milliseconds(100);
+    far.start();
+    StandInServer silent;
+    silent.silent = true;
+    silent.start();
+
+    UpstreamManager manager;
+    manager.add_server("127.0.0.1", near.port());  // Keyed by address: one per host
+    UpstreamManager others;
+    others.add_server("127.0.0.1", silent.port());
+
+    UpstreamSync sync(manager);
+    sync.set_timeout(std::chrono::milliseconds(300));
+    auto samples = sync.sample_all();
+    ASSERT_EQ(samples.size(), 1u);
+    ASSERT_TRUE(samples[0].valid) << samples[0].error;
+    auto servers = manager.get_servers();
+    EXPECT_EQ(servers[0].success_count, 1u);
+    EXPECT_GE(servers[0].response_time_ms, 1u);
+    EXPECT_EQ(servers[0].status, ServerStatus::HEALTHY);
+
+    UpstreamSync failing(others);
+    failing.set_timeout(std::chrono::milliseconds(100));
+    EXPECT_FALSE(failing.sample_all()[0].valid);
+    EXPECT_EQ(others.get_servers()[0].failure_count, 1u);
+
+    UpstreamSample best;
+    auto round = UpstreamSync::query({far.upstream(), near.upstream(), silent.upstream()},
+                                     std::chrono::milliseconds(300));
+    ASSERT_TRUE(UpstreamSync::best_sample(round, best));
+    EXPECT_EQ(best.port, near.port());
+    EXPECT_FALSE(UpstreamSync::best_sample({round[2]}, best));
+}
+
+// Test a stratum 15 upstream answers but is never followed, since serving
+// from it would be stratum 16
+TEST(UpstreamSyncTest, MaxStratumUpstreamIsUnusable) {
+    StandInServer deepest;
+    deepest.stratum = 15;
+    deepest.start();
+    StandInServer deep;
+    deep.stratum = 14;
+    deep.network_delay = std::chrono::milliseconds(20);
+    deep.start();
+
+    auto round = UpstreamSync::query({deepest.upstream(), deep.upstream()}, std::chrono::milliseconds(300));
+    ASSERT_EQ(round.size(), 2u);
+    ASSERT_TRUE(round[0].valid) << round[0].error;
+    EXPECT_FALSE(UpstreamSync::is_usable(round[0]));
+    EXPECT_TRUE(UpstreamSync::is_usable(round[1]));
+
+    UpstreamSample best;
+    ASSERT_TRUE(UpstreamSync::best_sample(round, best));
+    EXPECT_EQ(best.port, deep.port());
+    EXPECT_EQ(best.stratum, 14);
+    EXPECT_FALSE(UpstreamSync::best_sample({round[0]}, best));
+
+    // A hedged round does not stop at the unusable answer
+    auto hedged = UpstreamSync::query_hedged({deepest.upstream(), deep.upstream()},
+                                             std::chrono::milliseconds(1000),
+                                             std::chrono::milliseconds(500), 2);
+    ASSERT_EQ(hedged.size(), 2u);
+    EXPECT_TRUE(UpstreamSync::is_usable(hedged[1])) << hedged[1].error;
+}
+
+// Test a prompt best-ranked upstream is the only one a hedged round asks
+TEST(UpstreamSyncTest, HedgedQueryStopsAtFirstAnswer) {
+    StandInServer first;
+    first.start();
+    StandInServer second;
+    second.start();
+
+    auto samples = UpstreamSync::query_hedged({first.upstream(), second.upstream()},
+                                              std::chrono::milliseconds(1000),
+                                              std::chrono::milliseconds(200), 2);
+    ASSERT_EQ(samples.size(), 1u);
+    EXPECT_TRUE(samples[0].valid) << samples[0].error;
+    EXPECT_EQ(samples[0].port, first.port());
+    EXPECT_GT(samples[0].response_ns, 0);
+}
+
+// Test a slow upstream is hedged and the faster answer wins
+TEST(UpstreamSyncTest, HedgesSlowUpstream) {
+    StandInServer slow;
+    slow.network_delay = std::chrono::milliseconds(400);
+    slow.start();
+    StandInServer fast;
+    fast.start();
+
+    auto start = std::chrono::steady_clock::now();
+    auto samples = UpstreamSync::query_hedged({slow.upstream(), fast.upstream()},
+                                              std::chrono::milliseconds(1000),
+                                              std::chrono::milliseconds(50), 2);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    ASSERT_EQ(samples.size(), 2u);
+    EXPECT_FALSE(samples[0].valid);
+    EXPECT_TRUE(samples[0].abandoned);
+    EXPECT_TRUE(samples[1].valid) << samples[1].error;
+    EXPECT_GE(elapsed, std::chrono::milliseconds(50));
+    EXPECT_LT(elapsed, std::chrono::milliseconds(300));
+}
+
+// Test a rejected request is replaced without waiting out the hedge delay
+TEST(UpstreamSyncTest, HedgeReplacesFailedRequest) {
+    StandInServer unsynchronized;
+    unsynchronized.leap = 3;
+    unsynchronized.start();
+    StandInServer good;
+    good.start();
+
+    auto start = std::chrono::steady_clock::now();
+    auto samples = UpstreamSync::query_hedged({unsynchronized.upstream(), good.upstream()},
+                                              std::chrono::milliseconds(1000),
+                                              std::chrono::milliseconds(500), 2);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    ASSERT_EQ(samples.size(), 2u);
+    EXPECT_EQ(samples[0].error, "Upstream is unsynchronized");
+    EXPECT_FALSE(samples[0].abandoned);
+    EXPECT_TRUE(samples[1].valid) << samples[1].error;
+    EXPECT_LT(elapsed, std::chrono::milliseconds(300));
+}
+
+// Test hedges wait for a free slot once max_outstanding are in flight
+TEST(UpstreamSyncTest, HedgeRespectsMaxOutstanding) {
+    std::vector<std::unique_ptr<StandInServer>> upstreams;
+    std::vector<UpstreamServer> servers;
+    for (int i = 0; i < 3; ++i) {
+        upstreams.push_back(std::make_unique<StandInServer>());
+        upstreams.back()->silent = true;
+        upstreams.back()->start();
+        servers.push_back(upstreams.back()->upstream());
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    auto samples = UpstreamSync::query_hedged(servers, std::chrono::milliseconds(200),
+                                              std::chrono::milliseconds(20), 2);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    // The third goes out only when the first times out at 200 ms
+    ASSERT_EQ(samples.size(), 3u);
+    for (const auto& sample : samples) {
+        EXPECT_EQ(sample.error, "Timed out");
+    }
+    EXPECT_GE(elapsed, std::chrono::milliseconds(400));
+    EXPECT_LT(elapsed, std::chrono::milliseconds(1000));
+}
+
+// Test the hedge delay follows recent answer times and rounds are recorded
+TEST(UpstreamSyncTest, SampleHedgedUsesAnswerHistory) {
+    StandInServer primary("127.0.0.1");
+    primary.start();
+    StandInServer backup("127.0.0.2");
+    backup.start();
+
+    UpstreamManager manager;
+    manager.add_server("127.0.0.1", primary.port());
+    manager.add_server("127.0.0.2", backup.port());
+    manager.record_success("127.0.0.1", 1);
+    manager.record_success("127.0.0.2", 50);
+    manager.set_hedge_max_outstanding(2);
+    manager.set_hedge_delay_percentile(90.0);
+
+    UpstreamSync sync(manager);
+    sync.set_timeout(std::chrono::milliseconds(800));
+    EXPECT_EQ(sync.get_hedge_delay(), std::chrono::milliseconds(200));
+
+    for (int i = 0; i < 8; ++i) {
+        auto samples = sync.sample_hedged();
+        ASSERT_EQ(samples.size(), 1u);
+        ASSERT_TRUE(samples[0].valid) << samples[0].error;
+        EXPECT_EQ(samples[0].address, "127.0.0.1");
+    }
+    EXPECT_LT(sync.get_hedge_delay(), std::chrono::milliseconds(200));
+    EXPECT_EQ(manager.get_servers()[0].success_count, 9u);
+    EXPECT_EQ(manager.get_servers()[1].success_count, 1u);
+}
+
+// Test a round is combined from the truechimers and falsetickers are marked
+TEST(UpstreamSyncTest, CombineSamplesRejectsFalseticker) {
+    std::vector<std::unique_ptr<StandInServer>> upstreams;
+    UpstreamManager manager;
+    manager.set_selection_strategy(SelectionStrategy::INTERSECTION);
+    for (int i = 1; i <= 4; ++i) {
+        std::string address = "127.0.0." + std::to_string(i);
+        upstreams.push_back(std::make_unique<StandInServer>(address));
+        upstreams.back()->offset_ns = i == 4 ? 2000000000 : 5000000;
+        upstreams.back()->start();
+        manager.add_server(address, upstreams.back()->port());
+    }
+
+    UpstreamSync sync(manager);
+    auto samples = sync.sample_all();
+    UpstreamSample combined;
+    ASSERT_TRUE(sync.combine_samples(samples, combined));
+    EXPECT_NEAR(static_cast<double>(combined.offset_ns), 5e6, 5e6);
+    EXPECT_NE(combined.address, "127.0.0.4");
+
+    auto servers = manager.get_servers();
+    for (const auto& server : servers) {
+        EXPECT_EQ(server.falseticker, server.address == "127.0.0.4") << server.address;
+    }
+    for (int i = 0; i < 8; ++i) {
+        EXPECT_NE(manager.select_server()->address, "127.0.0.4");
+    }
+
+    // Two against two has no majority
+    samples[0].offset_ns = samples[3].offset_ns;
+    EXPECT_FALSE(sync.combine_samples(samples, combined));
+}
@@ -158,6 +158,294 @@ TEST_F(UTCConfigTest, PerformanceConfiguration) {
     EXPECT_EQ(config.get_stats_interval(), 60);
 }
 
+// Test SO_REUSEPORT sharding option
+TEST_F(UTCConfigTest, ReuseportOption) {
+    UTCConfig config;
+    EXPECT_FALSE(config.is_so_reuseport_enabled());
+
+    std::ofstream config_file(test_config_file_);
+    config_file << "worker_threads = 8\n";
+    config_file << "enable_so_reuseport = true\n";
+    config_file.close();
+
+    ASSERT_TRUE(config.load(test_config_file_));
+    EXPECT_TRUE(config.is_so_reuseport_enabled());
+
+    UTCConfig copy(config);
+    EXPECT_TRUE(copy.is_so_reuseport_enabled());
+}
+
+// Test io_uring backend option
+TEST_F(UTCConfigTest, IoUringOption) {
+    UTCConfig config;
+    EXPECT_FALSE(config.is_io_uring_enabled());
+
+    std::ofstream config_file(test_config_file_);
+    config_file << "enable_io_uring = true\n";
+    config_file.close();
+
+    ASSERT_TRUE(config.load(test_config_file_));
+    EXPECT_TRUE(config.is_io_uring_enabled());
+
+    UTCConfig copy(config);
+    EXPECT_TRUE(copy.is_io_uring_enabled());
+}
+
+// Test UDP service and admission options
+TEST_F(UTCConfigTest, UdpAndAdmissionOptions) {
+    UTCConfig config;
+    EXPECT_FALSE(config.is_udp_enabled());
+    EXPECT_EQ(config.get_udp_batch_size(), 32);
+    EXPECT_FALSE(config.is_rate_limiting_enabled());
+    EXPECT_FALSE(config.is_ddos_protection_enabled());
+
+    std::ofstream config_file(test_config_file_);
+    config_file << "enable_udp = true\n";
+    config_file << "udp_batch_size = 64\n";
+    config_file << "enable_rate_limiting = true\n";
+    config_file << "rate_limit_requests_per_second = 50\n";
+    config_file << "rate_limit_burst_size = 10\n";
+    config_file << "enable_ddos_protection = true\n";
+    config_file << "ddos_threshold = 500\n";
+    config_file.close();
+
+    ASSERT_TRUE(config.load(test_config_file_));
+    EXPECT_TRUE(config.is_udp_enabled());
+    EXPECT_EQ(config.get_udp_batch_size(), 64);
+    EXPECT_TRUE(config.is_rate_limiting_enabled());
+    EXPECT_EQ(config.get_rate_limit_requests_per_second(), 50);
+    EXPECT_EQ(config.get_rate_limit_burst_size(), 10);
+    EXPECT_TRUE(config.is_ddos_protection_enabled());
+    EXPECT_EQ(config.get_ddos_threshold(), 500);
+    EXPECT_TRUE(config.validate());
+
+    config.set_udp_batch_size(0);
+    EXPECT_FALSE(config.validate());
+    config.set_udp_batch_size(32);
+    config.set_rate_limit_burst_size(0);
+    EXPECT_FALSE(config.validate());
+}
+
+// Test fast path option
+TEST_F(UTCConfigTest, FastPathOption) {
+    UTCConfig config;
+    EXPECT_TRUE(config.is_fast_path_enabled());
+
+    std::ofstream config_file(test_config_file_);
+    config_file << "enable_fast_path = false\n";
+    config_file.close();
+
+    ASSERT_TRUE(config.load(test_config_file_));
+    EXPECT_FALSE(config.is_fast_path_enabled());
+}
+
+// Test CPU affinity list parsing and validation
+TEST_F(UTCConfigTest, CpuAffinityOption) {
+    UTCConfig config;
+    EXPECT_TRUE(config.get_cpu_affinity().empty());
+    EXPECT_TRUE(config.get_cpu_affinity_list().empty());
+    EXPECT_FALSE(config.is_numa_placement_enabled());
+
+    std::ofstream config_file(test_config_file_);
+    config_file << "cpu_affinity = 0-2, 5,1\n";
+    config_file << "enable_numa_placement = true\n";
+    config_file.close();
+
+    ASSERT_TRUE(config.load(test_config_file_));
+    EXPECT_EQ(config.get_cpu_affinity_list(), (std::vector<int>{0, 1, 2, 5}));
+    EXPECT_TRUE(config.is_numa_placement_enabled());
+    EXPECT_TRUE(config.validate());
+
+    config.set_cpu_affinity("3-1");
+    EXPECT_FALSE(config.validate());
+    config.set_cpu_affinity("cpu0");
+    EXPECT_FALSE(config.validate());
+    config.set_cpu_affinity("1024");
+    EXPECT_FALSE(config.validate());
+    EXPECT_TRUE(config.get_cpu_affinity_list().empty());
+}
+
+// Test admission control options and validation
+TEST_F(UTCConfigTest, AdmissionControlOptions) {
+    UTCConfig config;
+    EXPECT_FALSE(config.is_admission_control_enabled());
+    EXPECT_EQ(config.get_admission_target_ms(), 5);
+    EXPECT_EQ(config.get_admission_interval_ms(), 100);
+
+    std::ofstream config_file(test_config_file_);
+    config_file << "enable_admission_control = true\n";
+    config_file << "admission_target_ms = 10\n";
+    config_file << "admission_interval_ms = 200\n";
+    config_file.close();
+
+    ASSERT_TRUE(config.load(test_config_file_));
+    EXPECT_TRUE(config.is_admission_control_enabled());
+    EXPECT_EQ(config.get_admission_target_ms(), 10);
+    EXPECT_EQ(config.get_admission_interval_ms(), 200);
+    EXPECT_TRUE(config.validate());
+
+    config.set_admission_interval_ms(5);
+    EXPECT_FALSE(config.validate());
+}
+
+// Test NTP server options and validation
+TEST_F(UTCConfigTest, NtpOptions) {
+    UTCConfig config;
+    EXPECT_FALSE(config.is_ntp_enabled());
+    EXPECT_EQ(config.get_ntp_port(), 123);
+
+    std::ofstream config_file(test_config_file_);
+    config_file << "enable_ntp = true\n";
+    config_file << "ntp_port = 1123\n";
+    config_file.close();
+
+    ASSERT_TRUE(config.load(test_config_file_));
+    EXPECT_TRUE(config.is_ntp_enabled());
+    EXPECT_EQ(config.get_ntp_port(), 1123);
+    EXPECT_TRUE(config.validate());
+
+    config.set_ntp_port(70000);
+    EXPECT_FALSE(config.validate());
+}
+
+// Test kernel timestamping option
+TEST_F(UTCConfigTest, KernelTimestampsOption) {
+    UTCConfig config;
+    EXPECT_FALSE(config.is_kernel_timestamps_enabled());
+
+    std::ofstream config_file(test_config_file_);
+    config_file << "enable_kernel_timestamps = true\n";
+    config_file.close();
+
+    ASSERT_TRUE(config.load(test_config_file_));
+    EXPECT_TRUE(config.is_kernel_timestamps_enabled());
+
+    UTCConfig copy(config);
+    EXPECT_TRUE(copy.is_kernel_timestamps_enabled());
+}
+
+// Test CPU steering option
+TEST_F(UTCConfigTest, CpuSteeringOption) {
+    UTCConfig config;
+    EXPECT_FALSE(config.is_cpu_steering_enabled());
+
+    std::ofstream config_file(test_config_file_);
+    config_file << "enable_so_reuseport = true\n";
+    config_file << "enable_cpu_steering = true\n";
+    config_file.close();
+
+    ASSERT_TRUE(config.load(test_config_file_));
+    EXPECT_TRUE(config.is_cpu_steering_enabled());
+    EXPECT_TRUE(config.validate());
+}
+
+// Test busy-poll options and their bounds
+TEST_F(UTCConfigTest, BusyPollOptions) {
+    UTCConfig config;
+    EXPECT_FALSE(config.is_busy_poll_enabled());
+    EXPECT_EQ(config.get_busy_poll_us(), 50);
+    EXPECT_EQ(config.get_busy_poll_idle_us(), 1000);
+
+    std::ofstream config_file(test_config_file_);
+    config_file << "enable_busy_poll = true\n";
+    config_file << "busy_poll_us = 0\n";
+    config_file << "busy_poll_idle_us = 250\n";
+    config_file.close();
+
+    ASSERT_TRUE(config.load(test_config_file_));
+    EXPECT_TRUE(config.is_busy_poll_enabled());
+    EXPECT_EQ(config.get_busy_poll_us(), 0);
+    EXPECT_EQ(config.get_busy_poll_idle_us(), 250);
+    EXPECT_TRUE(config.validate());
+
+    config.set_busy_poll_us(-1);
+    EXPECT_FALSE(config.validate());
+}
+
+// Test upstream sync is opt-in and loads from file
+TEST_F(UTCConfigTest, UpstreamSyncOption) {
+    UTCConfig config;
+    EXPECT_FALSE(config.is_upstream_sync_enabled());
+
+    std::ofstream config_file(test_config_file_);
+    config_file << "enable_upstream_sync = true\n";
+    config_file << "upstream_servers = [\"10.0.0.1:123\", \"[2001:db8::1]:123\"]\n";
+    config_file.close();
+
+    ASSERT_TRUE(config.load(test_config_file_));
+    EXPECT_TRUE(config.is_upstream_sync_enabled());
+    ASSERT_EQ(config.get_upstream_servers().size(), 2u);
+    EXPECT_EQ(config.get_upstream_servers()[1], "[2001:db8::1]:123");
+}
+
+// Test upstream probe concurrency option and its bounds
+TEST_F(UTCConfigTest, UpstreamProbeConcurrency) {
+    UTCConfig config;
+    EXPECT_EQ(config.get_upstream_probe_concurrency(), 64);
+
+    config.set_upstream_probe_concurrency(0);
+    EXPECT_TRUE(config.validate());
+
+    config.set_upstream_probe_concurrency(-1);
+    EXPECT_FALSE(config.validate());
+}
+
+// Test the upstream selection strategy names
+TEST_F(UTCConfigTest, UpstreamSelectionStrategy) {
+    UTCConfig config;
+    EXPECT_EQ(config.get_upstream_selection_strategy(), "health_based");
+
+    config.set_upstream_selection_strategy("intersection");
+    EXPECT_TRUE(config.validate());
+
+    config.set_upstream_selection_strategy("fastest");
+    EXPECT_FALSE(config.validate());
+}
+
+// Test hedged sync options and their bounds
+TEST_F(UTCConfigTest, UpstreamHedgeOptions) {
+    UTCConfig config;
+    EXPECT_DOUBLE_EQ(config.get_upstream_hedge_percentile(), 95.0);
+    EXPECT_EQ(config.get_upstream_hedge_max_outstanding(), 0);
+
+    config.set_upstream_hedge_percentile(50.0);
+    config.set_upstream_hedge_max_outstanding(2);
+    EXPECT_TRUE(config.validate());
+
+    config.set_upstream_hedge_percentile(0.0);
+    EXPECT_FALSE(config.validate());
+    config.set_upstream_hedge_percentile(99.9);
+    config.set_upstream_hedge_max_outstanding(65);
+    EXPECT_FALSE(config.validate());
+}
+
+// Test virtual clock options and their bounds
+TEST_F(UTCConfigTest, VirtualClockOptions) {
+    UTCConfig config;
+    EXPECT_FALSE(config.is_virtual_clock_enabled());
+    EXPECT_EQ(config.get_virtual_clock_time_constant(), 256);
+
+    config.set_virtual_clock_enabled(true);
+    config.set_virtual_clock_time_constant(64);
+    EXPECT_TRUE(config.validate());
+
+    config.set_virtual_clock_time_constant(8);
+    EXPECT_FALSE(config.validate());
+}
+
+// Test hand-off queue depth option and its bounds
+TEST_F(UTCConfigTest, HandoffQueueDepth) {
+    UTCConfig config;
+    EXPECT_EQ(config.get_handoff_queue_depth(), 1024);
+    EXPECT_TRUE(config.validate());
+
+    config.set_handoff_queue_depth(0);
+    EXPECT_FALSE(config.validate());
+
+    config.set_handoff_queue_depth(256);
+    EXPECT_TRUE(config.validate());
+}
+
 // Test loading a simple config file
 TEST_F(UTCConfigTest, LoadConfigFile) {
     // Create a simple config file
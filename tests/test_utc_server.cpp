@@ -0,0 +1,811 @@
+/*
+ * tests/test_utc_server.cpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include "simple_utcd/utc_server.hpp"
+#include "simple_utcd/utc_config.hpp"
+#include "simple_utcd/utc_packet.hpp"
+#include "simple_utcd/logger.hpp"
+#include "simple_utcd/platform.hpp"
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <atomic>
+#include <cstring>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+using namespace simple_utcd;
+
+class UTCServerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        config_.set_listen_address("127.0.0.1");
+        config_.set_listen_port(0);
+        config_.set_worker_threads(2);
+        config_.set_max_connections(64);
+        server_ = std::make_unique<UTCServer>(&config_, nullptr);
+    }
+
+    void TearDown() override {
+        server_->stop();
+    }
+
+    // Connect and read the 4-byte UTC reply; returns false on failure
+    bool query(uint32_t& timestamp) {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0) {
+            return false;
+        }
+
+        struct timeval tv = {2, 0};
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+        struct sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(server_->get_bound_port());
+        inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+        if (connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0) {
+            close(fd);
+            return false;
+        }
+
+        uint8_t buffer[4];
+        size_t received = 0;
+        while (received < sizeof(buffer)) {
+            ssize_t n = recv(fd, buffer + received, sizeof(buffer) - received, 0);
+            if (n <= 0) {
+                break;
+            }
+            received += n;
+        }
+        close(fd);
+
+        if (received != sizeof(buffer)) {
+            return false;
+        }
+        timestamp = (uint32_t(buffer[0]) << 24) | (uint32_t(buffer[1]) << 16) |
+                    (uint32_t(buffer[2]) << 8) | uint32_t(buffer[3]);
+        return true;
+    }
+
+    // Send an empty datagram and read the 4-byte UTC reply
+    bool query_udp(uint32_t& timestamp) {
+        int fd = socket(AF_INET, SOCK_DGRAM, 0);
+        if (fd < 0) {
+            return false;
+        }
+
+        struct timeval tv = {0, 300000};
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+        struct sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(server_->get_udp_bound_port());
+        inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+        sendto(fd, "", 0, 0, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr));
+
+        uint8_t buffer[4];
+        ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+        close(fd);
+
+        if (n != static_cast<ssize_t>(sizeof(buffer))) {
+            return false;
+        }
+        timestamp = (uint32_t(buffer[0]) << 24) | (uint32_t(buffer[1]) << 16) |
+                    (uint32_t(buffer[2]) << 8) | uint32_t(buffer[3]);
+        return true;
+    }
+
+    // Send a 48-byte NTP packet and read the reply; returns its size
+    ssize_t exchange_ntp(const uint8_t* request, uint8_t* reply, size_t reply_size) {
+        int fd = socket(AF_INET, SOCK_DGRAM, 0);
+        if (fd < 0) {
+            return -1;
+        }
+
+        struct timeval tv = {0, 300000};
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+        struct sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(server_->get_ntp_bound_port());
+        inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+        sendto(fd, request, 48, 0, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr));
+
+        ssize_t n = recv(fd, reply, reply_size, 0);
+        close(fd);
+        return n;
+    }
+
+    UTCConfig config_;
+    std::unique_ptr<UTCServer> server_;
+};
+
+// Test start/stop lifecycle
+TEST_F(UTCServerTest, StartStop) {
+    ASSERT_TRUE(server_->start());
+    EXPECT_TRUE(server_->is_running());
+    EXPECT_GT(server_->get_bound_port(), 0);
+    EXPECT_FALSE(server_->start());
+
+    server_->stop();
+    EXPECT_FALSE(server_->is_running());
+}
+
+// Test a client receives the current UTC time
+TEST_F(UTCServerTest, ServesTime) {
+    ASSERT_TRUE(server_->start());
+
+    uint32_t timestamp = 0;
+    ASSERT_TRUE(query(timestamp));
+
+    uint32_t now = UTCPacket::get_current_utc_timestamp();
+    EXPECT_LE(timestamp, now);
+    EXPECT_GE(timestamp + 2, now);
+}
+
+// Test many concurrent clients are spread across workers and all served
+TEST_F(UTCServerTest, ConcurrentClients) {
+    ASSERT_TRUE(server_->start());
+
+    const int kClients = 16;
+    std::vector<std::thread> clients;
+    std::atomic<int> served(0);
+    for (int i = 0; i < kClients; ++i) {
+        clients.emplace_back([this, &served]() {
+            uint32_t timestamp = 0;
+            if (query(timestamp)) {
+                served++;
+            }
+        });
+    }
+    for (auto& client : clients) {
+        client.join();
+    }
+
+    EXPECT_EQ(served.load(), kClients);
+    EXPECT_EQ(server_->get_total_connections(), kClients);
+
+    // Connections are released once the reply is written
+    for (int i = 0; i < 100 && server_->get_active_connections() > 0; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(server_->get_active_connections(), 0);
+}
+
+// Test stop is prompt even while workers are idle in their waits
+TEST_F(UTCServerTest, StopWhileIdle) {
+    ASSERT_TRUE(server_->start());
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    auto start = std::chrono::steady_clock::now();
+    server_->stop();
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(2));
+}
+
+// Test SO_REUSEPORT shards each accept on their own listener
+TEST_F(UTCServerTest, ReuseportShards) {
+    config_.set_so_reuseport_enabled(true);
+    config_.set_worker_threads(4);
+    ASSERT_TRUE(server_->start());
+    ASSERT_TRUE(server_->is_reuseport_active());
+    EXPECT_GT(server_->get_bound_port(), 0);
+
+    const int kClients = 32;
+    for (int i = 0; i < kClients; ++i) {
+        uint32_t timestamp = 0;
+        ASSERT_TRUE(query(timestamp));
+    }
+
+    auto counts = server_->get_shard_accept_counts();
+    ASSERT_EQ(counts.size(), 4u);
+    uint64_t total = 0;
+    for (uint64_t count : counts) {
+        total += count;
+    }
+    EXPECT_EQ(total, static_cast<uint64_t>(kClients));
+}
+
+// Test the shared acceptor spreads connections round-robin
+TEST_F(UTCServerTest, SharedAcceptorCounts) {
+    config_.set_fast_path_enabled(false);
+    ASSERT_TRUE(server_->start());
+    EXPECT_FALSE(server_->is_reuseport_active());
+
+    for (int i = 0; i < 4; ++i) {
+        uint32_t timestamp = 0;
+        ASSERT_TRUE(query(timestamp));
+    }
+
+    auto counts = server_->get_shard_accept_counts();
+    ASSERT_EQ(counts.size(), 2u);
+    EXPECT_EQ(counts[0], 2u);
+    EXPECT_EQ(counts[1], 2u);
+}
+
+// Test a burst larger than one wakeup batch is handed off and served
+TEST_F(UTCServerTest, SharedAcceptorBurst) {
+    config_.set_fast_path_enabled(false);
+    ASSERT_TRUE(server_->start());
+
+    const int kClients = 40;
+    std::vector<std::thread> clients;
+    std::atomic<int> served(0);
+    for (int i = 0; i < kClients; ++i) {
+        clients.emplace_back([this, &served]() {
+            uint32_t timestamp = 0;
+            if (query(timestamp)) {
+                served++;
+            }
+        });
+    }
+    for (auto& client : clients) {
+        client.join();
+    }
+
+    EXPECT_EQ(served.load(), kClients);
+    auto counts = server_->get_shard_accept_counts();
+    ASSERT_EQ(counts.size(), 2u);
+    EXPECT_EQ(counts[0] + counts[1], static_cast<uint64_t>(kClients));
+}
+
+// Test the exporter sees connections counted in the worker blocks
+TEST_F(UTCServerTest, MetricsSumWorkerStats) {
+    config_.set_fast_path_enabled(false);
+    ASSERT_TRUE(server_->start());
+
+    for (int i = 0; i < 6; ++i) {
+        uint32_t timestamp = 0;
+        ASSERT_TRUE(query(timestamp));
+    }
+    for (int i = 0; i < 100 && server_->get_active_connections() > 0; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    auto* metrics = server_->get_performance_metrics();
+    EXPECT_EQ(metrics->get_total_connections(), 6u);
+    EXPECT_EQ(metrics->get_active_connections(), 0u);
+    EXPECT_EQ(server_->get_packets_sent(), 6u);
+
+    // Totals survive the workers being torn down
+    server_->stop();
+    EXPECT_EQ(server_->get_total_connections(), 6u);
+    EXPECT_EQ(server_->get_packets_sent(), 6u);
+    EXPECT_EQ(server_->get_active_connections(), 0u);
+}
+
+// Test connections come from the workers' pools and return to them
+TEST_F(UTCServerTest, PooledConnections) {
+    config_.set_fast_path_enabled(false);
+    config_.set_max_connections(4);     // Two pooled connections per worker
+    ASSERT_TRUE(server_->start());
+
+    for (int i = 0; i < 20; ++i) {
+        uint32_t timestamp = 0;
+        ASSERT_TRUE(query(timestamp));
+        for (int wait = 0; wait < 100 && server_->get_active_connections() > 0; ++wait) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    EXPECT_EQ(server_->get_total_connections(), 20);
+    EXPECT_EQ(server_->get_connection_pool_fallbacks(), 0u);
+}
+
+// Test access control sees the binary peer address in text form
+TEST_F(UTCServerTest, DeniedPeerOnConnectionPath) {
+    config_.set_fast_path_enabled(false);
+    config_.set_denied_clients({"127.0.0.1"});
+    ASSERT_TRUE(server_->start());
+
+    uint32_t timestamp = 0;
+    EXPECT_FALSE(query(timestamp));
+    EXPECT_EQ(server_->get_total_connections(), 0);
+}
+
+// Test io_uring mode serves time, or falls back to epoll when unavailable
+TEST_F(UTCServerTest, IoUringBackend) {
+    config_.set_io_uring_enabled(true);
+    ASSERT_TRUE(server_->start());
+    EXPECT_EQ(server_->is_io_uring_active(), IoUringLoop::is_available());
+
+    for (int i = 0; i < 8; ++i) {
+        uint32_t timestamp = 0;
+        ASSERT_TRUE(query(timestamp));
+    }
+    EXPECT_EQ(server_->get_total_connections(), 8);
+
+    for (int i = 0; i < 100 && server_->get_active_connections() > 0; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(server_->get_active_connections(), 0);
+}
+
+// Test RFC 868 over UDP answers on the TCP port number
+TEST_F(UTCServerTest, ServesTimeOverUdp) {
+    config_.set_udp_enabled(true);
+    ASSERT_TRUE(server_->start());
+    EXPECT_EQ(server_->get_udp_bound_port(), server_->get_bound_port());
+
+    uint32_t timestamp = 0;
+    ASSERT_TRUE(query_udp(timestamp));
+    uint32_t now = UTCPacket::get_current_utc_timestamp();
+    EXPECT_LE(timestamp, now);
+    EXPECT_GE(timestamp + 2, now);
+
+    // TCP keeps working alongside
+    ASSERT_TRUE(query(timestamp));
+    EXPECT_GE(server_->get_packets_received(), 1);
+}
+
+// Test UDP shards follow SO_REUSEPORT
+TEST_F(UTCServerTest, UdpReuseportShards) {
+    config_.set_udp_enabled(true);
+    config_.set_so_reuseport_enabled(true);
+    ASSERT_TRUE(server_->start());
+
+    for (int i = 0; i < 8; ++i) {
+        uint32_t timestamp = 0;
+        ASSERT_TRUE(query_udp(timestamp));
+    }
+}
+
+// Test the access list applies to datagrams
+TEST_F(UTCServerTest, UdpAccessControl) {
+    config_.set_udp_enabled(true);
+    config_.set_denied_clients({"127.0.0.1"});
+    ASSERT_TRUE(server_->start());
+
+    uint32_t timestamp = 0;
+    EXPECT_FALSE(query_udp(timestamp));
+    EXPECT_EQ(server_->get_datagrams_rejected(), 1u);
+}
+
+// Test the rate limiter throttles a client flooding datagrams
+TEST_F(UTCServerTest, UdpRateLimit) {
+    config_.set_udp_enabled(true);
+    config_.set_rate_limiting_enabled(true);
+    config_.set_rate_limit_requests_per_second(1);
+    config_.set_rate_limit_burst_size(2);
+    ASSERT_TRUE(server_->start());
+
+    int answered = 0;
+    for (int i = 0; i < 6; ++i) {
+        uint32_t timestamp = 0;
+        if (query_udp(timestamp)) {
+            answered++;
+        }
+    }
+    EXPECT_GE(answered, 2);
+    EXPECT_LT(answered, 6);
+    EXPECT_GE(server_->get_datagrams_rejected(), 1u);
+}
+
+// Test NTPv4 client requests get a server-mode reply
+TEST_F(UTCServerTest, ServesNtp) {
+    config_.set_ntp_enabled(true);
+    config_.set_ntp_port(0);
+    config_.set_stratum(3);
+    ASSERT_TRUE(server_->start());
+    ASSERT_GT(server_->get_ntp_bound_port(), 0);
+
+    uint8_t request[48] = {};
+    request[0] = (4 << 3) | 3;  // Version 4, client mode
+    for (int i = 40; i < 48; ++i) {
+        request[i] = static_cast<uint8_t>(i);
+    }
+
+    uint8_t reply[64];
+    ASSERT_EQ(exchange_ntp(request, reply, sizeof(reply)), 48);
+    EXPECT_EQ(reply[0] & 0x07, 4);
+    EXPECT_EQ(reply[1], 3);
+    EXPECT_EQ(std::memcmp(reply + 24, request + 40, 8), 0);
+
+    uint32_t receive_seconds = (uint32_t(reply[32]) << 24) | (uint32_t(reply[33]) << 16) |
+                               (uint32_t(reply[34]) << 8) | uint32_t(reply[35]);
+    uint32_t now = UTCPacket::get_current_utc_timestamp() + NtpResponder::kUnixEpochOffset;
+    EXPECT_LE(receive_seconds, now);
+    EXPECT_GE(receive_seconds + 2, now);
+    EXPECT_LE(std::memcmp(reply + 32, reply + 40, 8), 0);  // Receive <= transmit
+
+    // A server-mode packet is not a request and gets no answer
+    request[0] = (4 << 3) | 4;
+    EXPECT_LT(exchange_ntp(request, reply, sizeof(reply)), 0);
+    EXPECT_EQ(server_->get_datagrams_rejected(), 1u);
+}
+
+// Test replies follow a published discipline state
+TEST_F(UTCServerTest, NtpAppliesDiscipline) {
+    config_.set_ntp_enabled(true);
+    config_.set_ntp_port(0);
+    config_.set_stratum(3);
+    ASSERT_TRUE(server_->start());
+
+    // Start-up publishes the uncorrected local clock at the configured stratum
+    DisciplineState state = server_->get_discipline();
+    EXPECT_EQ(server_->get_discipline_version(), 1u);
+    EXPECT_EQ(state.offset_ns, 0);
+    EXPECT_EQ(state.stratum, 3);
+    EXPECT_EQ(state.leap, DisciplineState::kLeapNone);
+
+    state.offset_ns = 3600LL * 1000000000;
+    state.last_update_ns = 0;
+    state.leap = 1;
+    state.stratum = 2;
+    server_->publish_discipline(state);
+    EXPECT_EQ(server_->get_discipline_version(), 2u);
+
+    uint8_t request[48] = {};
+    request[0] = (4 << 3) | 3;
+    uint8_t reply[64];
+    ASSERT_EQ(exchange_ntp(request, reply, sizeof(reply)), 48);
+    EXPECT_EQ(reply[0] >> 6, 1);
+    EXPECT_EQ(reply[1], 2);
+
+    uint32_t receive_seconds = (uint32_t(reply[32]) << 24) | (uint32_t(reply[33]) << 16) |
+                               (uint32_t(reply[34]) << 8) | uint32_t(reply[35]);
+    uint32_t corrected = UTCPacket::get_current_utc_timestamp() + NtpResponder::kUnixEpochOffset + 3600;
+    EXPECT_LE(receive_seconds, corrected);
+    EXPECT_GE(receive_seconds + 2, corrected);
+
+    // The TIME protocol's second moves with it
+    uint32_t published = UTCPacket::get_current_utc_timestamp() + 3600;
+    uint32_t timestamp = 0;
+    ASSERT_TRUE(query(timestamp));
+    EXPECT_LE(timestamp, published);
+    EXPECT_GE(timestamp + 2, published);
+}
+
+// Test upstream sync follows a local upstream and serves its time
+TEST_F(UTCServerTest, UpstreamSyncDisciplinesServedTime) {
+    // The upstream is another server running an hour ahead at stratum 1
+    UTCConfig upstream_config;
+    upstream_config.set_listen_address("127.0.0.1");
+    upstream_config.set_listen_port(0);
+    upstream_config.set_worker_threads(1);
+    upstream_config.set_ntp_enabled(true);
+    upstream_config.set_ntp_port(0);
+    upstream_config.set_stratum(1);
+    UTCServer upstream(&upstream_config, nullptr);
+    ASSERT_TRUE(upstream.start());
+    DisciplineState ahead = upstream.get_discipline();
+    ahead.offset_ns = 3600LL * 1000000000;
+    upstream.publish_discipline(ahead);
+
+    config_.set_ntp_enabled(true);
+    config_.set_ntp_port(0);
+    config_.set_upstream_sync_enabled(true);
+    config_.set_upstream_servers({"127.0.0.1:" + std::to_string(upstream.get_ntp_bound_port())});
+    config_.set_timeout(500);
+    ASSERT_TRUE(server_->start());
+
+    for (int i = 0; i < 200 && server_->get_discipline_version() < 2; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_GE(server_->get_discipline_version(), 2u);
+
+    DisciplineState state = server_->get_discipline();
+    EXPECT_NEAR(static_cast<double>(state.offset_ns), 3600e9, 50e6);
+    EXPECT_EQ(state.stratum, 2);
+    EXPECT_EQ(state.leap, DisciplineState::kLeapNone);
+    EXPECT_EQ(server_->get_upstream_manager()->get_healthy_server_count(), 1u);
+
+    uint8_t request[48] = {};
+    request[0] = (4 << 3) | 3;
+    uint8_t reply[64];
+    ASSERT_EQ(exchange_ntp(request, reply, sizeof(reply)), 48);
+    EXPECT_EQ(reply[1], 2);
+    // A stratum 2 server names its upstream and the path to it
+    EXPECT_EQ((uint32_t(reply[12]) << 24) | (uint32_t(reply[13]) << 16) |
+              (uint32_t(reply[14]) << 8) | uint32_t(reply[15]), 0x7F000001u);
+    EXPECT_GT(state.root_delay_ns, 0);
+    uint32_t reference_seconds = (uint32_t(reply[16]) << 24) | (uint32_t(reply[17]) << 16) |
+                                 (uint32_t(reply[18]) << 8) | uint32_t(reply[19]);
+    uint32_t receive_seconds = (uint32_t(reply[32]) << 24) | (uint32_t(reply[33]) << 16) |
+                               (uint32_t(reply[34]) << 8) | uint32_t(reply[35]);
+    uint32_t expected = UTCPacket::get_current_utc_timestamp() + NtpResponder::kUnixEpochOffset + 3600;
+    EXPECT_LE(receive_seconds, expected);
+    EXPECT_GE(receive_seconds + 2, expected);
+    EXPECT_LE(reference_seconds, receive_seconds);
+    EXPECT_GE(reference_seconds + 10, receive_seconds);
+    upstream.stop();
+}
+
+// Test the virtual clock serves upstream time from the raw clock
+TEST_F(UTCServerTest, UpstreamSyncThroughVirtualClock) {
+    UTCConfig upstream_config;
+    upstream_config.set_listen_address("127.0.0.1");
+    upstream_config.set_listen_port(0);
+    upstream_config.set_worker_threads(1);
+    upstream_config.set_ntp_enabled(true);
+    upstream_config.set_ntp_port(0);
+    upstream_config.set_stratum(1);
+    UTCServer upstream(&upstream_config, nullptr);
+    ASSERT_TRUE(upstream.start());
+    DisciplineState ahead = upstream.get_discipline();
+    ahead.offset_ns = 3600LL * 1000000000;
+    upstream.publish_discipline(ahead);
+
+    config_.set_ntp_enabled(true);
+    config_.set_ntp_port(0);
+    config_.set_kernel_timestamps_enabled(true);
+    config_.set_upstream_sync_enabled(true);
+    config_.set_upstream_servers({"127.0.0.1:" + std::to_string(upstream.get_ntp_bound_port())});
+    config_.set_virtual_clock_enabled(true);
+    config_.set_timeout(500);
+    ASSERT_TRUE(server_->start());
+
+    for (int i = 0; i < 200 && server_->get_discipline_version() < 2; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_GE(server_->get_discipline_version(), 2u);
+
+    // The first answer sets the clock: the line starts at the upstream's time
+    DisciplineState state = server_->get_discipline();
+    EXPECT_TRUE(state.raw_clock);
+    EXPECT_EQ(state.stratum, 2);
+    int64_t wall_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    EXPECT_NEAR(static_cast<double>(state.corrected_ns(TimeSource::current().raw_now_ns()) - wall_ns),
+                3600e9, 50e6);
+
+    uint8_t request[48] = {};
+    request[0] = (4 << 3) | 3;
+    uint8_t reply[64];
+    ASSERT_EQ(exchange_ntp(request, reply, sizeof(reply)), 48);
+    uint32_t receive_seconds = (uint32_t(reply[32]) << 24) | (uint32_t(reply[33]) << 16) |
+                               (uint32_t(reply[34]) << 8) | uint32_t(reply[35]);
+    uint32_t expected = UTCPacket::get_current_utc_timestamp() + NtpResponder::kUnixEpochOffset + 3600;
+    EXPECT_LE(receive_seconds, expected);
+    EXPECT_GE(receive_seconds + 2, expected);
+    EXPECT_LE(std::memcmp(reply + 32, reply + 40, 8), 0);  // Receive <= transmit
+
+    uint32_t timestamp = 0;
+    ASSERT_TRUE(query(timestamp));
+    EXPECT_LE(timestamp, expected - NtpResponder::kUnixEpochOffset);
+    EXPECT_GE(timestamp + 2, expected - NtpResponder::kUnixEpochOffset);
+
+    std::string metrics = server_->get_performance_metrics()->export_prometheus();
+    EXPECT_NE(metrics.find("simple_utcd_virtual_clock_updates_total 1\n"), std::string::npos);
+    upstream.stop();
+}
+
+// Test NTP replies use kernel arrival stamps and record their delays
+TEST_F(UTCServerTest, NtpKernelTimestamps) {
+    config_.set_ntp_enabled(true);
+    config_.set_ntp_port(0);
+    config_.set_kernel_timestamps_enabled(true);
+    ASSERT_TRUE(server_->start());
+
+    uint8_t request[48] = {};
+    request[0] = (4 << 3) | 3;
+    uint8_t reply[64];
+
+    // The kernel turns software stamping on in the background, so the
+    // first requests after start may go unstamped
+    uint64_t stamped = 0;
+    for (int i = 0; i < 100 && stamped < 4; ++i) {
+        ASSERT_EQ(exchange_ntp(request, reply, sizeof(reply)), 48);
+        EXPECT_LE(std::memcmp(reply + 32, reply + 40, 8), 0);  // Receive <= transmit
+        LatencyHistogram sample;
+        server_->get_kernel_rx_delay(sample);
+        stamped = sample.count();
+    }
+    if (stamped == 0) {
+        GTEST_SKIP() << "Kernel packet timestamps unavailable";
+    }
+
+    LatencyHistogram rx_delay;
+    server_->get_kernel_rx_delay(rx_delay);
+    EXPECT_EQ(rx_delay.count(), 4u);
+
+    // Arrival to userspace on an idle loopback is well under a second
+    EXPECT_LT(rx_delay.quantile_bound_ns(0.5), 1000000000u);
+    EXPECT_NE(server_->get_performance_metrics()->export_prometheus().find(
+                  "simple_utcd_kernel_rx_delay_seconds_count 4\n"),
+              std::string::npos);
+}
+
+// Test the fast path answers straight from the acceptor
+TEST_F(UTCServerTest, FastPathServesTime) {
+    ASSERT_TRUE(server_->start());
+    EXPECT_TRUE(server_->is_fast_path_active());
+
+    for (int i = 0; i < 8; ++i) {
+        uint32_t timestamp = 0;
+        ASSERT_TRUE(query(timestamp));
+        uint32_t now = UTCPacket::get_current_utc_timestamp();
+        EXPECT_LE(timestamp, now);
+        EXPECT_GE(timestamp + 2, now);
+    }
+    EXPECT_EQ(server_->get_total_connections(), 8);
+    EXPECT_EQ(server_->get_active_connections(), 0);
+
+    // The send is counted once it returns, which may trail the client's read
+    for (int i = 0; i < 100 && server_->get_packets_sent() < 8; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(server_->get_packets_sent(), 8);
+}
+
+// Test features that need the peer address keep the connection path
+TEST_F(UTCServerTest, FastPathYieldsToAdmissionChecks) {
+    config_.set_denied_clients({"10.0.0.1"});
+    ASSERT_TRUE(server_->start());
+    EXPECT_FALSE(server_->is_fast_path_active());
+
+    uint32_t timestamp = 0;
+    ASSERT_TRUE(query(timestamp));
+}
+
+// Test workers pinned to a CPU run there and report it
+TEST_F(UTCServerTest, CpuAffinityPinsWorkers) {
+    std::vector<int> allowed;
+    if (!Platform::get_thread_affinity(allowed) || allowed.empty()) {
+        GTEST_SKIP() << "Thread affinity not supported";
+    }
+    int cpu = allowed.back();
+    config_.set_cpu_affinity(std::to_string(cpu));
+    config_.set_numa_placement_enabled(true);
+    ASSERT_TRUE(server_->start());
+
+    // NUMA placement borrows the starting thread's affinity and restores it
+    std::vector<int> after;
+    ASSERT_TRUE(Platform::get_thread_affinity(after));
+    EXPECT_EQ(after, allowed);
+
+    uint32_t timestamp = 0;
+    ASSERT_TRUE(query(timestamp));
+
+    auto cpus = server_->get_thread_cpus();
+    ASSERT_EQ(cpus.count("worker-0"), 1u);
+    ASSERT_EQ(cpus.count("worker-1"), 1u);
+    EXPECT_EQ(cpus["worker-0"], cpu);
+    EXPECT_EQ(cpus["worker-1"], cpu);
+}
+
+// Test CPU steering sends every connection to the worker on the CPU that
+// received it; on loopback that is the client's CPU
+TEST_F(UTCServerTest, CpuSteeringFollowsReceivingCpu) {
+    std::vector<int> allowed;
+    if (!Platform::get_thread_affinity(allowed) || allowed.empty()) {
+        GTEST_SKIP() << "Thread affinity not supported";
+    }
+    int client_cpu = allowed.front();
+    std::string cpus = std::to_string(client_cpu);
+    if (allowed.size() > 1) {
+        cpus += "," + std::to_string(allowed[1]);
+    }
+    config_.set_so_reuseport_enabled(true);
+    config_.set_cpu_steering_enabled(true);
+    config_.set_worker_threads(2);
+    config_.set_cpu_affinity(cpus);
+    ASSERT_TRUE(server_->start());
+    if (!server_->is_cpu_steering_active()) {
+        GTEST_SKIP() << "Reuseport CPU steering unavailable";
+    }
+
+    const int kClients = 16;
+    ASSERT_TRUE(Platform::set_thread_affinity({client_cpu}));
+    for (int i = 0; i < kClients; ++i) {
+        uint32_t timestamp = 0;
+        ASSERT_TRUE(query(timestamp));
+    }
+    Platform::set_thread_affinity(allowed);
+
+    auto counts = server_->get_shard_accept_counts();
+    ASSERT_EQ(counts.size(), 2u);
+    EXPECT_EQ(counts[0], static_cast<uint64_t>(kClients));
+    EXPECT_EQ(counts[1], 0u);
+
+    std::map<int, uint64_t> accepts;
+    std::map<int, uint64_t> local;
+    server_->get_cpu_accept_counts(accepts, local);
+    EXPECT_EQ(accepts[client_cpu], static_cast<uint64_t>(kClients));
+    EXPECT_EQ(local[client_cpu], static_cast<uint64_t>(kClients));
+
+    std::string exported = server_->get_performance_metrics()->export_prometheus();
+    EXPECT_NE(exported.find("simple_utcd_cpu_local_accepts_total{cpu=\"" + std::to_string(client_cpu) +
+                            "\"} " + std::to_string(kClients) + "\n"),
+              std::string::npos);
+}
+
+// Test busy-poll threads serve requests, account spin and work time, and
+// fall back to blocking once idle
+TEST_F(UTCServerTest, BusyPollWorkers) {
+    config_.set_busy_poll_enabled(true);
+    config_.set_busy_poll_idle_us(20000);
+    config_.set_udp_enabled(true);
+    ASSERT_TRUE(server_->start());
+
+    for (int i = 0; i < 4; ++i) {
+        uint32_t timestamp = 0;
+        ASSERT_TRUE(query(timestamp));
+    }
+    EXPECT_GT(server_->get_busy_poll_work_ns(), 0u);
+
+    // The acceptor, two workers and one UDP shard each go idle
+    for (int i = 0; i < 100 && server_->get_busy_poll_sleeps() < 4; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_GE(server_->get_busy_poll_sleeps(), 4u);
+    EXPECT_GT(server_->get_busy_poll_spin_ns(), 0u);
+
+    // Still answers after backing off
+    uint32_t timestamp = 0;
+    ASSERT_TRUE(query(timestamp));
+    EXPECT_NE(server_->get_performance_metrics()->export_prometheus().find(
+                  "# TYPE simple_utcd_busy_poll_spin_seconds_total counter\n"),
+              std::string::npos);
+}
+
+// Test admission control measures connections on the worker path
+TEST_F(UTCServerTest, AdmissionControlMeasuresQueueDelay) {
+    config_.set_admission_control_enabled(true);
+    ASSERT_TRUE(server_->start());
+    EXPECT_FALSE(server_->is_fast_path_active());
+
+    for (int i = 0; i < 8; ++i) {
+        uint32_t timestamp = 0;
+        ASSERT_TRUE(query(timestamp));
+    }
+
+    auto* controller = server_->get_admission_controller();
+    EXPECT_EQ(controller->get_admitted_count(), 8u);
+    EXPECT_EQ(controller->get_shed_count(), 0u);
+    EXPECT_FALSE(controller->is_overloaded());
+    EXPECT_FALSE(server_->get_graceful_degradation()->is_degraded());
+}
+
+// Test counters stay readable while workers are started and retired
+TEST_F(UTCServerTest, CountersReadableAcrossRestarts) {
+    std::atomic<bool> done{false};
+    std::thread reader([this, &done]() {
+        while (!done) {
+            server_->get_active_connections();
+            server_->get_shard_accept_counts();
+            LatencyHistogram delay;
+            server_->get_kernel_rx_delay(delay);
+        }
+    });
+
+    for (int i = 0; i < 5; ++i) {
+        ASSERT_TRUE(server_->start());
+        uint32_t timestamp = 0;
+        ASSERT_TRUE(query(timestamp));
+        server_->stop();
+    }
+    done = true;
+    reader.join();
+
+    EXPECT_EQ(server_->get_total_connections(), 5u);
+    EXPECT_EQ(server_->get_active_connections(), 0u);
+}
+
+// Test admission control stands down where workers accept for themselves
+TEST_F(UTCServerTest, AdmissionControlIgnoredWithReuseport) {
+    config_.set_admission_control_enabled(true);
+    config_.set_so_reuseport_enabled(true);
+    ASSERT_TRUE(server_->start());
+
+    uint32_t timestamp = 0;
+    ASSERT_TRUE(query(timestamp));
+    EXPECT_EQ(server_->get_admission_controller()->get_admitted_count(), 0u);
+}
@@ -0,0 +1,180 @@
+/*
+ * tests/test_virtual_clock.cpp
+ *
+ * Copyright 2024 SimpleDaemons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include "simple_utcd/virtual_clock.hpp"
+#include <cmath>
+#include <cstdlib>
+#include <random>
+
+using namespace simple_utcd;
+
+namespace {
+
+/**
+ * A raw oscillator skew_ppm fast against true time, polled every
+ * poll_s seconds by an upstream whose answers carry Gaussian noise.
+ * Seeded, so every run sees the same noise.
+ */
+class Simulation {
+public:
+    Simulation(double skew_ppm, double noise_us, int64_t poll_s, uint64_t seed = 5905)
+        : skew_ppm_(skew_ppm), poll_ns_(poll_s * 1000000000), rng_(seed), noise_(0.0, noise_us * 1000.0) {}
+
+    // Advance one poll and feed the clock one noisy measurement
+    void poll(VirtualClock& clock) {
+        true_ns_ += poll_ns_;
+        clock.update(raw_ns(), true_ns_ + static_cast<int64_t>(std::llround(noise_(rng_))));
+    }
+
+    // Virtual minus true time, free of measurement noise
+    int64_t error_ns(const VirtualClock& clock) const { return clock.now_ns(raw_ns()) - true_ns_; }
+
+    // The correction that cancels the skew
+    double ideal_frequency_ppm() const { return (1.0 / (1.0 + skew_ppm_ * 1e-6) - 1.0) * 1e6; }
+
+    int64_t raw_ns() const {
+        double elapsed = static_cast<double>(true_ns_ - kTrueStartNs);
+        return kRawStartNs + static_cast<int64_t>(elapsed * (1.0 + skew_ppm_ * 1e-6));
+    }
+
+private:
+    static constexpr int64_t kTrueStartNs = 1700000000000000000;
+    static constexpr int64_t kRawStartNs = 86400000000000;   // A day of uptime
+
+    double skew_ppm_;
+    int64_t poll_ns_;
+    int64_t true_ns_ = kTrueStartNs;
+    std::mt19937_64 rng_;
+    std::normal_distribution<double> noise_;
+};
+
+// Polls until the error last exceeded bound_ns, out of polls
+int polls_to_converge(Simulation& simulation, VirtualClock& clock, int polls, int64_t bound_ns) {
+    int converged = 0;
+    for (int i = 1; i <= polls; ++i) {
+        simulation.poll(clock);
+        if (std::llabs(simulation.error_ns(clock)) > bound_ns) {
+            converged = i;
+        }
+    }
+    return converged;
+}
+
+} // namespace
+
+// Test a 37 ppm oscillator is pulled within 1 ms and its frequency learned
+TEST(VirtualClockTest, ConvergesFromFrequencyError) {
+    Simulation simulation(37.0, 100.0, 16);
+    VirtualClock clock(std::chrono::seconds(64));
+
+    int converged = polls_to_converge(simulation, clock, 400, 1000000);
+    RecordProperty("polls_to_converge_1ms", converged);
+    EXPECT_LE(converged, 8);
+
+    // Past the transient the error stays well inside the measurement noise
+    double square = 0.0;
+    for (int i = 0; i < 200; ++i) {
+        simulation.poll(clock);
+        double error = static_cast<double>(simulation.error_ns(clock));
+        square += error * error;
+    }
+    double rms_us = std::sqrt(square / 200.0) / 1000.0;
+    RecordProperty("steady_rms_error_ns", static_cast<int>(rms_us * 1000.0));
+    EXPECT_LT(rms_us, 60.0);
+
+    auto stats = clock.get_stats();
+    EXPECT_TRUE(stats.synchronized);
+    EXPECT_EQ(stats.steps, 0u);
+    EXPECT_EQ(stats.updates, 600u);
+    EXPECT_NEAR(stats.frequency_ppm, simulation.ideal_frequency_ppm(), 2.0);
+    EXPECT_GT(stats.rms_offset_ns, 0.0);
+    EXPECT_LT(stats.rms_offset_ns, 300000.0);
+}
+
+// Test noise alone does not walk the frequency away
+TEST(VirtualClockTest, NoiseDoesNotDriveFrequency) {
+    Simulation simulation(0.0, 500.0, 64);
+    VirtualClock clock;
+
+    polls_to_converge(simulation, clock, 500, 1000000);
+    auto stats = clock.get_stats();
+    EXPECT_NEAR(stats.frequency_ppm, 0.0, 1.0);
+    EXPECT_LT(std::llabs(simulation.error_ns(clock)), 500000);
+    EXPECT_LT(stats.wander_ppm, 0.5);
+}
+
+// Test long poll intervals fall to the FLL and still converge
+TEST(VirtualClockTest, FrequencyLockAtLongIntervals) {
+    Simulation simulation(-20.0, 100.0, 2048);
+    VirtualClock clock(std::chrono::seconds(2048));
+
+    int converged = polls_to_converge(simulation, clock, 100, 2000000);
+    RecordProperty("polls_to_converge_2ms", converged);
+    EXPECT_LE(converged, 12);
+    EXPECT_NEAR(clock.get_stats().frequency_ppm, simulation.ideal_frequency_ppm(), 0.5);
+}
+
+// Test an offset beyond the step threshold is stepped, keeping the frequency
+TEST(VirtualClockTest, StepsLargeOffset) {
+    VirtualClock clock(std::chrono::seconds(16));
+    EXPECT_FALSE(clock.is_synchronized());
+
+    int64_t raw = 1000000000000;
+    int64_t reference = 1700000000000000000;
+    clock.update(raw, reference);
+    EXPECT_TRUE(clock.is_synchronized());
+    EXPECT_EQ(clock.now_ns(raw), reference);
+
+    for (int i = 1; i <= 4; ++i) {
+        clock.update(raw + i * 16000000000LL, reference + i * 16000000000LL - i * 160000);  // 10 ppm slow
+    }
+    double frequency = clock.get_stats().frequency_ppm;
+    EXPECT_LT(frequency, -5.0);
+
+    int64_t later = raw + 80000000000LL;
+    clock.update(later, reference + 80000000000LL + 2000000000LL);
+    auto stats = clock.get_stats();
+    EXPECT_EQ(stats.steps, 1u);
+    EXPECT_EQ(clock.now_ns(later), reference + 82000000000LL);
+    EXPECT_DOUBLE_EQ(stats.frequency_ppm, frequency);
+
+    clock.reset();
+    EXPECT_FALSE(clock.is_synchronized());
+    EXPECT_EQ(clock.get_stats().updates, 0u);
+}
+
+// Test the published state serves exactly the clock's own time
+TEST(VirtualClockTest, StateMatchesClock) {
+    Simulation simulation(25.0, 50.0, 16);
+    VirtualClock clock(std::chrono::seconds(64));
+    polls_to_converge(simulation, clock, 20, 1000000);
+
+    DisciplineState state = clock.get_state();
+    EXPECT_TRUE(state.raw_clock);
+    EXPECT_EQ(state.leap, DisciplineState::kLeapUnsynchronized);
+    for (int64_t ahead : {int64_t(0), int64_t(1000), int64_t(3000000000), int64_t(600000000000)}) {
+        int64_t raw = simulation.raw_ns() + ahead;
+        EXPECT_EQ(state.corrected_ns(raw), clock.now_ns(raw));
+    }
+
+    DisciplinePublisher publisher;
+    publisher.publish(state);
+    EXPECT_TRUE(publisher.read().raw_clock);
+    EXPECT_EQ(publisher.read().offset_ns, state.offset_ns);
+}